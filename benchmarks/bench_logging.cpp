@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "bench_logging.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+
+#include <boost/log/core.hpp>
+#include <unistd.h>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+namespace Logging {
+namespace bench {
+
+namespace {
+/// stream buffer discarding everything, with a buffer so writing doesn't call overflow() for every character
+class null_buffer : public std::streambuf {
+protected:
+    int_type overflow(int_type ch) override {
+        setp(buffer, buffer + sizeof(buffer));
+        return traits_type::not_eof(ch);
+    }
+
+private:
+    char buffer[4096];
+};
+} // namespace
+
+void init_logging(const std::string& config) {
+    static null_buffer discarded;
+    std::clog.rdbuf(&discarded);
+
+    boost::log::core::get()->flush();
+    // init() only replaces the sinks of liblog destinations, the ones Boost.Log created would keep running
+    boost::log::core::get()->remove_all_sinks();
+
+    const auto config_file = "/tmp/liblog_bench." + std::to_string(::getpid()) + ".ini";
+    {
+        std::ofstream file(config_file);
+        file << config;
+    }
+    init(config_file);
+    std::remove(config_file.c_str());
+}
+
+std::string console_config(const std::string& format, const std::string& sink_settings,
+                           const std::string& core_filter) {
+    return "[Core]\n"
+           "Filter=\"" +
+           core_filter +
+           "\"\n"
+           "[Sinks.Console]\n"
+           "Destination=Console\n"
+           "Format=\"" +
+           format + "\"\n" + sink_settings;
+}
+
+} // namespace bench
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef BENCH_LOGGING_HPP
+#define BENCH_LOGGING_HPP
+
+#include <string>
+
+namespace Everest {
+namespace Logging {
+namespace bench {
+
+///
+/// \brief initializes liblog from a logging.ini with the content \p config
+///
+/// Everything written to std::clog, the stream of the Console destination, is discarded, so the benchmarks measure
+/// liblog and not the terminal. Queued records of the previous configuration are flushed first.
+void init_logging(const std::string& config);
+
+/// \brief a logging.ini with a single Console sink writing \p format and further \p sink_settings
+std::string console_config(const std::string& format, const std::string& sink_settings = "",
+                           const std::string& core_filter = "%Severity% >= VERB");
+
+} // namespace bench
+} // namespace Logging
+} // namespace Everest
+
+#endif // BENCH_LOGGING_HPP
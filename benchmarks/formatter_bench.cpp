@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <array>
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <boost/make_shared.hpp>
+
+#include <everest/logging.hpp>
+
+#include "bench_logging.hpp"
+#include "compiled_format.hpp"
+#include "escape.hpp"
+#include "sinks.hpp"
+
+namespace Everest {
+namespace Logging {
+namespace bench {
+
+namespace {
+/// Keeps the last record, so a formatter can be measured on its own.
+class capture_backend : public logging::sinks::basic_sink_backend<logging::sinks::synchronized_feeding> {
+public:
+    void consume(const logging::record_view& rec) {
+        last = rec;
+    }
+
+    logging::record_view last;
+};
+
+const std::array<const char*, 3> formatter_formats = {
+    "%Message%",
+    "%TimeStamp% [%Severity%] %Message%",
+    "%TimeStamp% %Process% [%ProcessID%] [%Severity%] {%ThreadID%} %function% %file%:%line%: %EscapedMessage%",
+};
+
+logging::record_view capture_record() {
+    init_logging(console_config("%Message%"));
+    auto backend = boost::make_shared<capture_backend>();
+    auto sink = boost::make_shared<logging::sinks::synchronous_sink<capture_backend>>(backend);
+    logging::core::get()->add_sink(sink);
+    EVLOG_info << "value \"quoted\" " << 42;
+    logging::core::get()->remove_sink(sink);
+    return backend->last;
+}
+
+void run_formatter(benchmark::State& state, const logging::formatter& formatter) {
+    const auto rec = capture_record();
+    std::string text;
+    logging::formatting_ostream strm(text);
+    for (auto _ : state) {
+        text.clear();
+        formatter(rec, strm);
+        strm.flush();
+        benchmark::DoNotOptimize(text.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+} // namespace
+
+/// Boost's interpreted formatter of a Format setting, without the rest of the logging path.
+void BM_BoostFormatter(benchmark::State& state) {
+    const auto* format = formatter_formats.at(state.range(0));
+    state.SetLabel(format);
+    run_formatter(state, logging::parse_formatter(rewrite_format_placeholders(format)));
+}
+BENCHMARK(BM_BoostFormatter)->DenseRange(0, static_cast<int>(formatter_formats.size()) - 1);
+
+/// The compiled formatter the sinks use for the same Format setting.
+void BM_CompiledFormatter(benchmark::State& state) {
+    const auto* format = formatter_formats.at(state.range(0));
+    state.SetLabel(format);
+    run_formatter(state, compile_formatter(rewrite_format_placeholders(format)));
+}
+BENCHMARK(BM_CompiledFormatter)->DenseRange(0, static_cast<int>(formatter_formats.size()) - 1);
+
+/// Escaping of a message without anything to escape and of a JSON payload.
+const std::array<std::string, 2> escape_payloads = {
+    std::string(2000, 'x'),
+    [] {
+        std::string payload = "[2,\"19223201\",\"MeterValues\",{\"connectorId\":1,\"meterValue\":[";
+        while (payload.size() < 2000) {
+            payload += "{\"timestamp\":\"2023-04-05T06:07:08Z\",\"sampledValue\":[{\"value\":\"1234.5\","
+                       "\"measurand\":\"Energy.Active.Import.Register\",\"unit\":\"Wh\"}]},";
+        }
+        return payload + "]}]";
+    }(),
+};
+
+template <void (*escape)(const std::string&, logging::formatting_ostream&)> void BM_Escape(benchmark::State& state) {
+    const auto& payload = escape_payloads.at(state.range(0));
+    state.SetLabel(state.range(0) == 0 ? "clean" : "json");
+    std::string text;
+    logging::formatting_ostream strm(text);
+    for (auto _ : state) {
+        text.clear();
+        escape(payload, strm);
+        strm.flush();
+        benchmark::DoNotOptimize(text.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(payload.size()));
+}
+BENCHMARK_TEMPLATE(BM_Escape, write_escaped)->DenseRange(0, 1);
+BENCHMARK_TEMPLATE(BM_Escape, write_json_escaped)->DenseRange(0, 1);
+
+} // namespace bench
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <array>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+#include <boost/log/attributes/named_scope.hpp>
+#include <boost/log/core.hpp>
+#include <unistd.h>
+
+#include <everest/logging.hpp>
+
+#include "bench_logging.hpp"
+
+namespace Everest {
+namespace Logging {
+namespace bench {
+
+namespace {
+constexpr const char* message_format = "%Message%";
+
+/// logs one record of \p level, the level has to be a constant for the EVLOG_* call site
+template <severity_level level> void log_record(std::int64_t value) {
+    if constexpr (level == verbose) {
+        EVLOG_verbose << "value " << value;
+    } else if constexpr (level == debug) {
+        EVLOG_debug << "value " << value;
+    } else if constexpr (level == info) {
+        EVLOG_info << "value " << value;
+    } else if constexpr (level == warning) {
+        EVLOG_warning << "value " << value;
+    } else if constexpr (level == error) {
+        EVLOG_error << "value " << value;
+    } else {
+        EVLOG_critical << "value " << value;
+    }
+}
+
+void flush_sinks(const benchmark::State& /*state*/) {
+    boost::log::core::get()->flush();
+}
+} // namespace
+
+/// Latency of a single enabled record per level, written by a synchronous Console sink.
+template <severity_level level> void BM_EnabledRecord(benchmark::State& state) {
+    init_logging(console_config(message_format));
+    std::int64_t value = 0;
+    for (auto _ : state) {
+        log_record<level>(++value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_EnabledRecord, verbose);
+BENCHMARK_TEMPLATE(BM_EnabledRecord, debug);
+BENCHMARK_TEMPLATE(BM_EnabledRecord, info);
+BENCHMARK_TEMPLATE(BM_EnabledRecord, warning);
+BENCHMARK_TEMPLATE(BM_EnabledRecord, error);
+BENCHMARK_TEMPLATE(BM_EnabledRecord, critical);
+
+/// Latency of a record per level that the Core filter rejects.
+template <severity_level level> void BM_FilteredRecord(benchmark::State& state) {
+    init_logging(console_config(message_format, "", "%Severity% > CRIT"));
+    std::int64_t value = 0;
+    for (auto _ : state) {
+        log_record<level>(++value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_FilteredRecord, verbose);
+BENCHMARK_TEMPLATE(BM_FilteredRecord, debug);
+BENCHMARK_TEMPLATE(BM_FilteredRecord, info);
+BENCHMARK_TEMPLATE(BM_FilteredRecord, warning);
+BENCHMARK_TEMPLATE(BM_FilteredRecord, error);
+BENCHMARK_TEMPLATE(BM_FilteredRecord, critical);
+
+/// Latency of a record per level whose call site the [CallSites] rules disable.
+template <severity_level level> void BM_DisabledCallSite(benchmark::State& state) {
+    init_logging(console_config(message_format) + "[CallSites]\nDefault=CRIT\n");
+    std::int64_t value = 0;
+    for (auto _ : state) {
+        log_record<level>(++value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_DisabledCallSite, verbose);
+BENCHMARK_TEMPLATE(BM_DisabledCallSite, debug);
+BENCHMARK_TEMPLATE(BM_DisabledCallSite, info);
+BENCHMARK_TEMPLATE(BM_DisabledCallSite, warning);
+BENCHMARK_TEMPLATE(BM_DisabledCallSite, error);
+
+/// Throughput of threads logging concurrently into the same sink, selected by the argument (see sink_settings).
+const std::array<const char*, 3> sink_settings = {
+    "",                      // synchronous Boost.Log frontend
+    "Asynchronous=true\n",   // asynchronous Boost.Log frontend
+    "Backend=lockfree\n",    // lockfree_sink
+};
+const std::array<const char*, 3> sink_names = {"sync", "async", "lockfree"};
+
+void init_sink(const benchmark::State& state) {
+    init_logging(console_config(message_format, sink_settings.at(state.range(0))));
+}
+
+void BM_Threads(benchmark::State& state) {
+    state.SetLabel(sink_names.at(state.range(0)));
+    std::int64_t value = 0;
+    for (auto _ : state) {
+        EVLOG_info << "value " << ++value;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Threads)
+    ->DenseRange(0, 2)
+    ->ThreadRange(1, static_cast<int>(std::max(4u, std::thread::hardware_concurrency())))
+    ->UseRealTime()
+    ->Setup(init_sink)
+    ->Teardown(flush_sinks);
+
+/// Cost of a record on the logging thread for synchronous and asynchronous sinks.
+void BM_Sink(benchmark::State& state) {
+    state.SetLabel(sink_names.at(state.range(0)));
+    std::int64_t value = 0;
+    for (auto _ : state) {
+        EVLOG_info << "value " << ++value;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Sink)->DenseRange(0, 2)->Setup(init_sink)->Teardown(flush_sinks);
+
+/// Records written to a file, by Boost.Log with AutoFlush and by liblog with a write per record, buffered or copied
+/// into a memory mapped segment.
+const std::array<const char*, 4> file_sink_settings = {
+    "Destination=TextFile\nAutoFlush=true\n",
+    "Destination=File\nAutoFlush=true\n",
+    "Destination=File\nFlushIntervalMs=20\n",
+    "Destination=MappedFile\n",
+};
+const std::array<const char*, 4> file_sink_names = {"TextFile AutoFlush", "File AutoFlush", "File FlushIntervalMs=20",
+                                                    "MappedFile"};
+
+void BM_FileSink(benchmark::State& state) {
+    state.SetLabel(file_sink_names.at(state.range(0)));
+    const auto file_name = "/tmp/liblog_bench." + std::to_string(::getpid()) + ".log";
+    init_logging(std::string("[Core]\nFilter=\"%Severity% >= VERB\"\n[Sinks.File]\nFileName=\"") + file_name +
+                 "\"\nFormat=\"%Message%\"\n" + file_sink_settings.at(state.range(0)));
+    std::int64_t value = 0;
+    for (auto _ : state) {
+        EVLOG_info << "value " << ++value;
+    }
+    state.SetItemsProcessed(state.iterations());
+    init_logging(console_config(message_format));
+    std::remove(file_name.c_str());
+    // the segments of the MappedFile sink
+    for (int index = 0; std::remove((file_name + "." + std::to_string(index)).c_str()) == 0; ++index) {
+    }
+}
+BENCHMARK(BM_FileSink)->DenseRange(0, 3);
+
+/// Cost of the format placeholders, each one is written in front of the message.
+const std::array<const char*, 6> placeholder_formats = {
+    "%Message%",
+    "%TimeStamp% %Message%",
+    "%ThreadID% %Message%",
+    "%Scope% %Message%",
+    "%EscapedMessage%",
+    "%TimeStamp% [%ThreadID%] [%Severity%] %function% %file%:%line% %Scope% %Message%",
+};
+
+void BM_Placeholder(benchmark::State& state) {
+    const auto* format = placeholder_formats.at(state.range(0));
+    state.SetLabel(format);
+    init_logging(console_config(format));
+    BOOST_LOG_NAMED_SCOPE("benchmark");
+    std::int64_t value = 0;
+    for (auto _ : state) {
+        EVLOG_info << "value \"quoted\" " << ++value;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Placeholder)->DenseRange(0, static_cast<int>(placeholder_formats.size()) - 1);
+
+} // namespace bench
+} // namespace Logging
+} // namespace Everest
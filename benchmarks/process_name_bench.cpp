@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+#include <boost/log/attributes/mutable_constant.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <everest/logging.hpp>
+
+#include "bench_logging.hpp"
+#include "process_name.hpp"
+
+namespace Everest {
+namespace Logging {
+namespace bench {
+
+namespace {
+constexpr std::int64_t rename_interval = 1024;
+
+const int max_threads = static_cast<int>(std::max(8u, std::thread::hardware_concurrency()));
+
+const std::string first_name = "EvseManager    ";
+const std::string second_name = "EnergyManager  ";
+
+/// a mutable_constant that can be set while others read it, the one liblog used before had no lock at all
+using locked_process_name =
+    logging::attributes::mutable_constant<std::string, boost::shared_mutex, boost::unique_lock<boost::shared_mutex>,
+                                          boost::shared_lock<boost::shared_mutex>>;
+
+template <typename Attribute> Attribute& shared_attribute() {
+    static Attribute attribute(first_name);
+    return attribute;
+}
+
+void init_message_only(const benchmark::State&) {
+    init_logging(console_config("%Process% %Message%"));
+}
+} // namespace
+
+/// Reading the Process attribute, as opening a record does, while the first thread keeps renaming the process.
+template <typename Attribute> void BM_ProcessNameRead(benchmark::State& state) {
+    auto& attribute = shared_attribute<Attribute>();
+    std::int64_t iteration = 0;
+    for (auto _ : state) {
+        if (state.thread_index() == 0 && ++iteration % rename_interval == 0) {
+            attribute.set(iteration % (2 * rename_interval) == 0 ? first_name : second_name);
+        }
+        benchmark::DoNotOptimize(attribute.get_value());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ProcessNameRead, locked_process_name)->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProcessNameRead, process_name_attribute)->ThreadRange(1, max_threads)->UseRealTime();
+
+/// Threads logging with the Process placeholder while the first thread calls update_process_name().
+void BM_LogWhileRenaming(benchmark::State& state) {
+    std::int64_t iteration = 0;
+    for (auto _ : state) {
+        if (state.thread_index() == 0 && ++iteration % rename_interval == 0) {
+            update_process_name(iteration % (2 * rename_interval) == 0 ? "EvseManager" : "EnergyManager");
+        }
+        EVLOG_info << "value " << iteration;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogWhileRenaming)->ThreadRange(1, max_threads)->UseRealTime()->Setup(init_message_only);
+
+} // namespace bench
+} // namespace Logging
+} // namespace Everest
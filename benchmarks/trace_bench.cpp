@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+#include <everest/trace.hpp>
+
+namespace Everest {
+namespace Logging {
+namespace bench {
+
+namespace {
+/// a few frames for trace() to resolve
+__attribute__((noinline)) std::string nested_trace(int depth) {
+    if (depth == 0) {
+        return trace();
+    }
+    auto result = nested_trace(depth - 1);
+    benchmark::DoNotOptimize(result);
+    return result;
+}
+
+__attribute__((noinline)) raw_trace nested_capture(int depth) {
+    if (depth == 0) {
+        return capture_trace();
+    }
+    auto result = nested_capture(depth - 1);
+    benchmark::DoNotOptimize(result);
+    return result;
+}
+} // namespace
+
+/// Capturing and symbolizing the current stack with trace().
+void BM_Trace(benchmark::State& state) {
+    const auto depth = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        auto result = nested_trace(depth);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_Trace)->Arg(0)->Arg(8);
+
+/// Capturing the program counters of the current stack without resolving them.
+void BM_CaptureTrace(benchmark::State& state) {
+    const auto depth = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        auto result = nested_capture(depth);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_CaptureTrace)->Arg(0)->Arg(8);
+
+/// Resolving a captured trace whose frames are all cached already.
+void BM_SymbolizeCached(benchmark::State& state) {
+    const auto trace = nested_capture(static_cast<int>(state.range(0)));
+    benchmark::DoNotOptimize(symbolize(trace));
+    for (auto _ : state) {
+        auto result = symbolize(trace);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_SymbolizeCached)->Arg(0)->Arg(8);
+
+/// Threads capturing and symbolizing traces at the same time, each thread should take as long as a single one.
+void BM_ConcurrentTrace(benchmark::State& state) {
+    for (auto _ : state) {
+        auto result = nested_trace(8);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_ConcurrentTrace)->ThreadRange(1, 8)->UseRealTime();
+
+/// Constructing an exception with the EVEXCEPTION message formatting.
+void BM_EvException(benchmark::State& state) {
+    std::int64_t value = 0;
+    for (auto _ : state) {
+        auto exception = EVEXCEPTION(EverestInternalError, "value ", ++value, " is out of range");
+        benchmark::DoNotOptimize(exception);
+    }
+}
+BENCHMARK(BM_EvException);
+
+} // namespace bench
+} // namespace Logging
+} // namespace Everest
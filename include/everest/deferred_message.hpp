@@ -0,0 +1,320 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef DEFERRED_MESSAGE_HPP
+#define DEFERRED_MESSAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <boost/container/small_vector.hpp>
+#include <boost/log/core/record.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/utility/manipulators/add_value.hpp>
+
+#include <everest/record_stream.hpp>
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief Message of a record whose streamed arguments were captured in binary form
+///
+/// Built by the EVLOG_* macros if liblog is configured with LIBLOG_DEFERRED_FORMATTING. Every captured argument is
+/// stored as a tag byte followed by its raw bytes, the text is only rendered when a sink formats the record. Rendering
+/// gives exactly the text streaming the same arguments into a fresh record stream would have given.
+class deferred_message {
+public:
+    enum class tag : std::uint8_t {
+        boolean,
+        character,
+        int16,
+        uint16,
+        int32,
+        uint32,
+        int64,
+        uint64,
+        float32,
+        float64,
+        long_double,
+        pointer,
+        string,      ///< std::uint32_t length followed by the characters
+        manipulator, ///< one byte deferred_message::manipulator
+        precision,   ///< std::int64_t of std::setprecision
+        width,       ///< std::int64_t of std::setw
+        fill,        ///< character of std::setfill
+    };
+
+    /// \brief the standard manipulators that can be captured, all others are formatted right away
+    enum class manipulator : std::uint8_t {
+        boolalpha,
+        noboolalpha,
+        showbase,
+        noshowbase,
+        showpoint,
+        noshowpoint,
+        showpos,
+        noshowpos,
+        uppercase,
+        nouppercase,
+        left,
+        right,
+        internal,
+        dec,
+        hex,
+        oct,
+        fixed,
+        scientific,
+        hexfloat,
+        defaultfloat,
+        endl,
+        ends,
+        flush,
+    };
+
+    using ios_manipulator = std::ios_base& (*)(std::ios_base&);
+    using ostream_manipulator = std::ostream& (*)(std::ostream&);
+    using setprecision_type = decltype(std::setprecision(0));
+    using setw_type = decltype(std::setw(0));
+    using setfill_type = decltype(std::setfill('\0'));
+
+    deferred_message() = default;
+
+    /// \brief restores a message from the data() of a captured one, e.g. read back from a binary log
+    deferred_message(const unsigned char* data, std::size_t size) : buffer(data, data + size) {
+    }
+
+    template <typename T> void append_value(tag value_tag, T value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be appended");
+        const auto offset = buffer.size();
+        buffer.resize(offset + 1 + sizeof(T));
+        buffer[offset] = static_cast<unsigned char>(value_tag);
+        std::memcpy(&buffer[offset + 1], &value, sizeof(T));
+    }
+
+    void append_string(const char* data, std::size_t size);
+
+    /// \brief captures \p manip if it is a known manipulator, returns false otherwise
+    bool append_manipulator(ios_manipulator manip);
+    bool append_manipulator(ostream_manipulator manip);
+    void append_manipulator(setprecision_type manip);
+    void append_manipulator(setw_type manip);
+    void append_manipulator(setfill_type manip);
+
+    /// \brief streams the captured arguments into \p strm
+    void render(std::ostream& strm) const;
+
+    /// \brief the rendered text, the stream state is the one of a fresh record stream
+    std::string str() const;
+
+    const unsigned char* data() const {
+        return buffer.data();
+    }
+
+    std::size_t size() const {
+        return buffer.size();
+    }
+
+    bool empty() const {
+        return buffer.empty();
+    }
+
+private:
+    static constexpr std::size_t inline_capacity = 128;
+
+    boost::container::small_vector<unsigned char, inline_capacity> buffer;
+};
+
+/// \brief prints the rendered message
+std::ostream& operator<<(std::ostream& strm, const deferred_message& message);
+
+namespace detail {
+
+template <typename T, typename = void> struct has_own_stream_operator : std::false_type {};
+
+// found only for user provided operators, the built-in ones of the standard streams are members or ambiguous for enums
+template <typename T>
+struct has_own_stream_operator<
+    T, std::void_t<decltype(operator<<(std::declval<std::ostream&>(), std::declval<const T&>()))>> : std::true_type {};
+
+/// \brief captures \p value into \p message, returns false if the type needs to be formatted right away
+template <typename T> bool capture(deferred_message& message, const T& value) {
+    using tag = deferred_message::tag;
+    using type = std::remove_cv_t<T>;
+
+    if constexpr (std::is_same<type, bool>::value) {
+        message.append_value(tag::boolean, value);
+        return true;
+    } else if constexpr (std::is_same<type, char>::value || std::is_same<type, signed char>::value ||
+                         std::is_same<type, unsigned char>::value) {
+        message.append_value(tag::character, static_cast<char>(value));
+        return true;
+    } else if constexpr (std::is_integral<type>::value && (sizeof(type) == 2 || sizeof(type) == 4 || sizeof(type) == 8) &&
+                         !std::is_same<type, wchar_t>::value && !std::is_same<type, char16_t>::value &&
+                         !std::is_same<type, char32_t>::value) {
+        // the width matters for the hex and oct output of negative values, short is printed as unsigned short
+        constexpr auto is_signed = std::is_signed<type>::value;
+        if constexpr (sizeof(type) == 2) {
+            message.append_value(is_signed ? tag::int16 : tag::uint16, value);
+        } else if constexpr (sizeof(type) == 4) {
+            message.append_value(is_signed ? tag::int32 : tag::uint32, value);
+        } else {
+            message.append_value(is_signed ? tag::int64 : tag::uint64, value);
+        }
+        return true;
+    } else if constexpr (std::is_same<type, float>::value) {
+        message.append_value(tag::float32, value);
+        return true;
+    } else if constexpr (std::is_same<type, double>::value) {
+        message.append_value(tag::float64, value);
+        return true;
+    } else if constexpr (std::is_same<type, long double>::value) {
+        message.append_value(tag::long_double, value);
+        return true;
+    } else if constexpr (std::is_enum<type>::value) {
+        if constexpr (has_own_stream_operator<type>::value || !std::is_convertible<type, long long>::value) {
+            return false;
+        } else {
+            // unscoped enums without an own operator are printed as their promoted underlying value
+            return capture(message, +value);
+        }
+    } else if constexpr (std::is_same<type, std::string>::value || std::is_same<type, std::string_view>::value) {
+        message.append_string(value.data(), value.size());
+        return true;
+    } else if constexpr (std::is_array<type>::value &&
+                         std::is_same<std::remove_cv_t<std::remove_extent_t<type>>, char>::value) {
+        message.append_string(value, strnlen(value, std::extent<type>::value));
+        return true;
+    } else if constexpr (std::is_pointer<type>::value &&
+                         std::is_same<std::remove_cv_t<std::remove_pointer_t<type>>, char>::value) {
+        if (value == nullptr) {
+            return false;
+        }
+        message.append_string(value, std::strlen(value));
+        return true;
+    } else if constexpr (std::is_pointer<type>::value && !std::is_function<std::remove_pointer_t<type>>::value &&
+                         !std::is_same<std::remove_cv_t<std::remove_pointer_t<type>>, signed char>::value &&
+                         !std::is_same<std::remove_cv_t<std::remove_pointer_t<type>>, unsigned char>::value) {
+        message.append_value(tag::pointer, reinterpret_cast<std::uintptr_t>(static_cast<const volatile void*>(value)));
+        return true;
+    } else if constexpr (std::is_same<type, deferred_message::setprecision_type>::value ||
+                         std::is_same<type, deferred_message::setw_type>::value ||
+                         std::is_same<type, deferred_message::setfill_type>::value) {
+        message.append_manipulator(value);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+///
+/// \brief Stream of an EVLOG_* record in deferred formatting mode
+///
+/// Captures the arguments into a deferred_message as long as it knows how to. The first argument it can't capture
+/// switches it to a regular record stream, the arguments captured so far are replayed into it first.
+class deferred_record_stream {
+public:
+    explicit deferred_record_stream(boost::log::BOOST_LOG_VERSION_NAMESPACE::record& rec) : rec(rec) {
+    }
+
+    template <typename T> deferred_record_stream& operator<<(const T& value) {
+        if (!text && capture(message, value)) {
+            return *this;
+        }
+        text_stream() << value;
+        return *this;
+    }
+
+    deferred_record_stream& operator<<(deferred_message::ios_manipulator manip) {
+        if (text || !message.append_manipulator(manip)) {
+            text_stream() << manip;
+        }
+        return *this;
+    }
+
+    deferred_record_stream& operator<<(deferred_message::ostream_manipulator manip) {
+        if (text || !message.append_manipulator(manip)) {
+            text_stream() << manip;
+        }
+        return *this;
+    }
+
+    template <typename RefT>
+    deferred_record_stream&
+    operator<<(const boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value_manip<RefT>& manip) {
+        attach_value(manip);
+        return *this;
+    }
+
+    /// \brief attaches the message to the record, must be called once after the last argument
+    void finish();
+
+private:
+    template <typename RefT>
+    void attach_value(const boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value_manip<RefT>& manip) {
+        namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+        using value_type =
+            typename logging::aux::make_embedded_string_type<typename logging::add_value_manip<RefT>::value_type>::type;
+        rec.attribute_values().insert(manip.get_name(), make_pooled_value(value_type(manip.get_value())));
+    }
+
+    boost::log::BOOST_LOG_VERSION_NAMESPACE::record_ostream& text_stream();
+
+    boost::log::BOOST_LOG_VERSION_NAMESPACE::record& rec;
+    deferred_message message;
+    std::optional<boost::log::BOOST_LOG_VERSION_NAMESPACE::record_ostream> text;
+};
+
+/// \brief counterpart of the Boost.Log record pump, pushes the record when the EVLOG_* statement is complete
+template <typename LoggerT> class deferred_record_pump {
+public:
+    deferred_record_pump(LoggerT& logger, boost::log::BOOST_LOG_VERSION_NAMESPACE::record& rec) :
+        logger(logger), stream_(rec), rec(rec), exception_count(std::uncaught_exceptions()) {
+    }
+    deferred_record_pump(const deferred_record_pump&) = delete;
+    deferred_record_pump& operator=(const deferred_record_pump&) = delete;
+
+    ~deferred_record_pump() noexcept(false) {
+        // an argument threw, the record is dropped just like the Boost.Log pump does
+        if (exception_count >= std::uncaught_exceptions()) {
+            stream_.finish();
+            logger.push_record(std::move(rec));
+        }
+    }
+
+    deferred_record_stream& stream() {
+        return stream_;
+    }
+
+private:
+    LoggerT& logger;
+    deferred_record_stream stream_;
+    boost::log::BOOST_LOG_VERSION_NAMESPACE::record& rec;
+    const int exception_count;
+};
+
+template <typename LoggerT>
+deferred_record_pump<LoggerT> make_deferred_record_pump(LoggerT& logger,
+                                                        boost::log::BOOST_LOG_VERSION_NAMESPACE::record& rec) {
+    return deferred_record_pump<LoggerT>(logger, rec);
+}
+
+/// \brief the Message attribute value of \p message
+///
+/// Besides deferred_message, the value is visible as the std::string the message renders to, e.g. for the %Message%
+/// placeholder of formatters parsed by Boost.Log, which extracts std::string messages only.
+boost::log::BOOST_LOG_VERSION_NAMESPACE::attribute_value make_message_value(deferred_message message);
+
+} // namespace detail
+} // namespace Logging
+} // namespace Everest
+
+#endif // DEFERRED_MESSAGE_HPP
@@ -13,9 +13,25 @@
 #include <boost/log/support/exception.hpp>
 #include <boost/log/utility/manipulators/add_value.hpp>
 #include <boost/throw_exception.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <exception>
 #include <string>
 
+#ifdef LIBLOG_DEFERRED_FORMATTING
+#include <everest/deferred_message.hpp>
+#else
+#include <everest/record_stream.hpp>
+#endif
+
+/// \brief Lowest severity level (as index into Everest::Logging::severity_level) that is compiled into EVLOG_* call
+/// sites. Call sites below this level expand to a discarded statement and their operands are never evaluated.
+/// Normally set through the LIBLOG_MIN_SEVERITY CMake cache variable.
+#ifndef LIBLOG_MIN_SEVERITY
+#define LIBLOG_MIN_SEVERITY 0
+#endif
+
 namespace Everest {
 namespace Logging {
 
@@ -30,35 +46,215 @@ enum severity_level {
 
 void init(const std::string& logconf);
 void init(const std::string& logconf, std::string process_name);
+
+/// \brief applies the current content of the logging.ini given to init() without losing records
+///
+/// Filters, formats, severity colors and [CallSites] rules are swapped while other threads keep logging. Sinks of
+/// destinations liblog doesn't implement itself keep their initial settings. Throws EverestConfigError and keeps the
+/// current settings if the file is invalid. With Watch=true in the [Reload] section, the file is watched and reloaded
+/// on every change. Watch is only read by init(), reload() doesn't start or stop watching.
+void reload();
 void update_process_name(std::string process_name);
-std::string trace();
+
+/// \brief the stack of the calling thread, one "#N: function at file:line" line per frame
+///
+/// With \p skip_unknown_root_frames the outermost frames are left out as long as neither their function nor file is
+/// known. Resolved frames are cached, see capture_trace() and symbolize() in everest/trace.hpp.
+std::string trace(bool skip_unknown_root_frames = false);
+
+/// \brief writes out the records kept by the flight recorder configured in the [FlightRecorder] section, if any
+void dump_flight_recorder();
+
+/// \brief number of records of \p level that sinks with Asynchronous=true dropped because their queue was full
+std::uint64_t dropped_records(severity_level level);
+
+/// \brief installs a handler for SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT that writes out the records still queued
+/// by the sinks and a backtrace before the process dies
+///
+/// The handler waits at most \p flush_timeout for the threads of asynchronous sinks to write their queued records,
+/// then writes what's left in the buffers of File and Console sinks itself. The backtrace lists the raw program
+/// counters with binary and offset, it's written to stderr and to the log files. Afterwards the signal is raised again
+/// with the default action, so a core is still dumped.
+void install_crash_handler(std::chrono::milliseconds flush_timeout = std::chrono::milliseconds(1000));
+
+///
+/// \brief The EVLOG_* call sites of one executable or shared object
+///
+/// Every image including this header has its own instance, which is destroyed when the image is unloaded, e.g. by
+/// dlclose(). The call sites of the image are unregistered then, so later changes of the [CallSites] rules don't touch
+/// call sites that are gone.
+struct call_site_image {
+    constexpr call_site_image() = default;
+    ~call_site_image();
+    call_site_image(const call_site_image&) = delete;
+    call_site_image& operator=(const call_site_image&) = delete;
+};
+
+///
+/// \brief Static description of a single EVLOG_* call site
+///
+/// Every call site owns exactly one constant initialized instance, records only carry a pointer to it in their
+/// "CallSite" attribute. The %file%, %line% and %function% placeholders are resolved through it.
+///
+/// The [CallSites] rules of logging.ini can disable call sites, whether a call site is enabled is cached in it and
+/// only recomputed when the rules change. A disabled call site doesn't open a record at all.
+struct call_site {
+    /// \brief location fields that are shown by the placeholders, the remaining ones are printed empty
+    enum shown_fields : unsigned int {
+        show_nothing = 0,
+        show_location = 1 << 0, ///< %file% and %line%
+        show_function = 1 << 1, ///< %function%
+    };
+
+    /// \param image the image the call site is compiled into, call sites without one are never unregistered
+    constexpr call_site(const char* file, unsigned int line, const char* function, severity_level severity,
+                        unsigned int shown, const call_site_image* image = nullptr) :
+        file(file), line(line), function(function), severity(severity), shown(shown), image(image) {
+    }
+    call_site(const call_site&) = delete;
+    call_site& operator=(const call_site&) = delete;
+
+    /// \brief process wide unique id of this call site, assigned on first use
+    std::uint32_t id() const;
+
+    /// \brief false if the [CallSites] rules disable this call site, registers it on first use
+    bool enabled() const {
+        const auto state = enabled_state.load(std::memory_order_relaxed);
+        if (state == state_enabled) {
+            return true;
+        }
+        return state == state_unknown && register_site();
+    }
+
+    const char* const file;
+    const unsigned int line;
+    const char* const function;
+    const severity_level severity;
+    const unsigned int shown;
+
+private:
+    friend class call_site_registry;
+
+    enum : std::uint8_t {
+        state_unknown,
+        state_disabled,
+        state_enabled,
+    };
+
+    bool register_site() const;
+
+    const call_site_image* const image;
+    mutable std::atomic<std::uint32_t> site_id{0};
+    mutable std::atomic<std::uint8_t> enabled_state{state_unknown};
+};
+
+namespace detail {
+/// \brief true if call sites of \p level survive a compile-time severity floor of \p min_severity
+template <severity_level level, int min_severity> struct is_compiled_in {
+    static constexpr bool value = static_cast<int>(level) >= min_severity;
+};
+
+/// \brief location fields shown for a call site of \p level, verbose records have always carried their file and line
+constexpr unsigned int default_shown_fields(severity_level level) {
+    if (level == verbose) {
+        return call_site::show_location | call_site::show_function;
+    }
+    if (level == info) {
+        return call_site::show_nothing;
+    }
+    return call_site::show_function;
+}
+
+/// \brief name of the record attribute holding the const call_site* of the emitting call site
+const boost::log::BOOST_LOG_VERSION_NAMESPACE::attribute_name& call_site_attribute_name();
+
+/// \brief the call_site_image of the image including this header, hidden so that every shared object has its own
+__attribute__((visibility("hidden"))) inline call_site_image evlog_call_site_image;
+} // namespace detail
 } // namespace Logging
 
+#define EVLOG_IF_COMPILED_IN(level)                                                                                    \
+    if constexpr (!::Everest::Logging::detail::is_compiled_in<level, LIBLOG_MIN_SEVERITY>::value) {                    \
+    } else
+
+// declares the static call_site descriptor of the enclosing EVLOG_* statement and skips it if it's disabled
+#define EVLOG_CALL_SITE(level)                                                                                         \
+    if (static ::Everest::Logging::call_site evlog_call_site{                                                          \
+            __FILE__, __LINE__, BOOST_CURRENT_FUNCTION, level,                                                         \
+            ::Everest::Logging::detail::default_shown_fields(level),                                                   \
+            &::Everest::Logging::detail::evlog_call_site_image};                                                       \
+        !evlog_call_site.enabled()) {                                                                                  \
+    } else
+
+#define EVLOG_ATTACH_CALL_SITE()                                                                                       \
+    boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value(                                                                \
+        ::Everest::Logging::detail::call_site_attribute_name(),                                                        \
+        static_cast<const ::Everest::Logging::call_site*>(&evlog_call_site))
+
+// opens the record of an EVLOG_* statement, with LIBLOG_STATS the statement is counted and timed
+#ifdef LIBLOG_STATS
+#define EVLOG_STATS_SCOPE(level)                                                                                       \
+    if (::Everest::Logging::detail::call_stats evlog_call_stats{level}; false) {                                       \
+    } else
+#define EVLOG_OPEN_RECORD(level)                                                                                       \
+    evlog_call_stats.opened(::global_logger::get().open_record(                                                        \
+        (::boost::log::BOOST_LOG_VERSION_NAMESPACE::keywords::severity = (level))))
+#else
+#define EVLOG_STATS_SCOPE(level)
+#define EVLOG_OPEN_RECORD(level)                                                                                       \
+    ::global_logger::get().open_record((::boost::log::BOOST_LOG_VERSION_NAMESPACE::keywords::severity = (level)))
+#endif
+
+// its message is written into pooled per thread storage, with LIBLOG_DEFERRED_FORMATTING its arguments are captured in
+// binary form instead
+#ifdef LIBLOG_DEFERRED_FORMATTING
+#define EVLOG_RECORD(level)                                                                                            \
+    EVLOG_STATS_SCOPE(level)                                                                                           \
+    for (::boost::log::BOOST_LOG_VERSION_NAMESPACE::record evlog_record = EVLOG_OPEN_RECORD(level); !!evlog_record;)   \
+    ::Everest::Logging::detail::make_deferred_record_pump(::global_logger::get(), evlog_record).stream()
+#else
+#define EVLOG_RECORD(level)                                                                                            \
+    EVLOG_STATS_SCOPE(level)                                                                                           \
+    for (::boost::log::BOOST_LOG_VERSION_NAMESPACE::record evlog_record = EVLOG_OPEN_RECORD(level); !!evlog_record;)   \
+    ::Everest::Logging::detail::make_record_pump(::global_logger::get(), evlog_record).stream()
+#endif
+
 // clang-format off
 #define EVLOG_verbose                                                                                                  \
-    BOOST_LOG_SEV(::global_logger::get(), ::Everest::Logging::verbose)                                                 \
-        << boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value("file", __FILE__)                                        \
-        << boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value("line", __LINE__)                                        \
-        << boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value("function", BOOST_CURRENT_FUNCTION)
+    EVLOG_IF_COMPILED_IN(::Everest::Logging::verbose)                                                                  \
+    EVLOG_CALL_SITE(::Everest::Logging::verbose)                                                                       \
+    EVLOG_RECORD(::Everest::Logging::verbose)                                                                          \
+        << EVLOG_ATTACH_CALL_SITE()
 
 #define EVLOG_debug                                                                                                    \
-    BOOST_LOG_SEV(::global_logger::get(), ::Everest::Logging::debug)                                                   \
-        << boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value("function", BOOST_CURRENT_FUNCTION)
+    EVLOG_IF_COMPILED_IN(::Everest::Logging::debug)                                                                    \
+    EVLOG_CALL_SITE(::Everest::Logging::debug)                                                                         \
+    EVLOG_RECORD(::Everest::Logging::debug)                                                                            \
+        << EVLOG_ATTACH_CALL_SITE()
 
 #define EVLOG_info                                                                                                     \
-    BOOST_LOG_SEV(::global_logger::get(), ::Everest::Logging::info)
+    EVLOG_IF_COMPILED_IN(::Everest::Logging::info)                                                                     \
+    EVLOG_CALL_SITE(::Everest::Logging::info)                                                                          \
+    EVLOG_RECORD(::Everest::Logging::info)                                                                             \
+        << EVLOG_ATTACH_CALL_SITE()
 
 #define EVLOG_warning                                                                                                  \
-    BOOST_LOG_SEV(::global_logger::get(), ::Everest::Logging::warning)                                                 \
-        << boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value("function", BOOST_CURRENT_FUNCTION)
+    EVLOG_IF_COMPILED_IN(::Everest::Logging::warning)                                                                  \
+    EVLOG_CALL_SITE(::Everest::Logging::warning)                                                                       \
+    EVLOG_RECORD(::Everest::Logging::warning)                                                                          \
+        << EVLOG_ATTACH_CALL_SITE()
 
 #define EVLOG_error                                                                                                    \
-    BOOST_LOG_SEV(::global_logger::get(), ::Everest::Logging::error)                                                   \
-        << boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value("function", BOOST_CURRENT_FUNCTION)
+    EVLOG_IF_COMPILED_IN(::Everest::Logging::error)                                                                    \
+    EVLOG_CALL_SITE(::Everest::Logging::error)                                                                         \
+    EVLOG_RECORD(::Everest::Logging::error)                                                                            \
+        << EVLOG_ATTACH_CALL_SITE()
 
 #define EVLOG_critical                                                                                                 \
-    BOOST_LOG_SEV(::global_logger::get(), ::Everest::Logging::critical)                                                \
-        << boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value("function", BOOST_CURRENT_FUNCTION)
+    EVLOG_IF_COMPILED_IN(::Everest::Logging::critical)                                                                 \
+    EVLOG_CALL_SITE(::Everest::Logging::critical)                                                                      \
+    EVLOG_RECORD(::Everest::Logging::critical)                                                                         \
+        << EVLOG_ATTACH_CALL_SITE()
 // clang-format on
 
 #define EVLOG_AND_THROW(ex)                                                                                            \
@@ -67,6 +263,7 @@ std::string trace();
             BOOST_THROW_EXCEPTION(boost::enable_error_info(ex)                                                         \
                                   << boost::log::BOOST_LOG_VERSION_NAMESPACE::current_scope());                        \
         } catch (std::exception & e) {                                                                                 \
+            ::Everest::Logging::dump_flight_recorder();                                                                \
             EVLOG_error << e.what();                                                                                   \
             throw;                                                                                                     \
         }                                                                                                              \
@@ -83,4 +280,8 @@ BOOST_LOG_INLINE_GLOBAL_LOGGER_DEFAULT(
     global_logger,
     boost::log::BOOST_LOG_VERSION_NAMESPACE::sources::severity_logger_mt<Everest::Logging::severity_level>)
 
+#ifdef LIBLOG_STATS
+#include <everest/stats.hpp>
+#endif
+
 #endif // LOGGING_HPP
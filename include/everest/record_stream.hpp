@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef RECORD_STREAM_HPP
+#define RECORD_STREAM_HPP
+
+#include <cstddef>
+#include <exception>
+#include <ios>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+
+#include <boost/log/attributes/attribute_value_impl.hpp>
+#include <boost/log/core/record.hpp>
+#include <boost/log/utility/formatting_ostream.hpp>
+#include <boost/log/utility/manipulators/add_value.hpp>
+
+namespace Everest {
+namespace Logging {
+namespace detail {
+
+/// \brief size of the blocks kept by the per thread record pool, larger requests go to operator new
+constexpr std::size_t record_block_size = 64;
+
+/// \brief memory for an attribute value of a record, taken from a block cached by this thread if \p size fits
+void* allocate_record_block(std::size_t size);
+
+/// \brief returns memory of allocate_record_block(), blocks are cached by the thread freeing them
+void free_record_block(void* block, std::size_t size) noexcept;
+
+///
+/// \brief Attribute value allocated from the per thread record pool
+///
+/// Records are usually released by the thread that opened them, so in steady state a thread takes its attribute
+/// values from the blocks its previous records returned and logging doesn't allocate. Blocks freed by the worker of an
+/// asynchronous sink are cached by that thread instead.
+template <typename T>
+class pooled_attribute_value : public boost::log::BOOST_LOG_VERSION_NAMESPACE::attributes::attribute_value_impl<T> {
+public:
+    using boost::log::BOOST_LOG_VERSION_NAMESPACE::attributes::attribute_value_impl<T>::attribute_value_impl;
+
+    static void* operator new(std::size_t size) {
+        return allocate_record_block(size);
+    }
+
+    static void operator delete(void* block, std::size_t size) noexcept {
+        free_record_block(block, size);
+    }
+};
+
+template <typename T> boost::log::BOOST_LOG_VERSION_NAMESPACE::attribute_value make_pooled_value(T&& value) {
+    using value_type = std::remove_cv_t<std::remove_reference_t<T>>;
+    return boost::log::BOOST_LOG_VERSION_NAMESPACE::attribute_value(
+        new pooled_attribute_value<value_type>(std::forward<T>(value)));
+}
+
+///
+/// \brief Stream of an EVLOG_* record
+///
+/// Writes the message into a std::string attribute value taken from the record pool. The string reuses the buffer of
+/// the last message this thread released and the formatting streams are kept per thread, so a message doesn't
+/// allocate once the buffer has grown to its size.
+class record_stream {
+public:
+    explicit record_stream(boost::log::BOOST_LOG_VERSION_NAMESPACE::record& rec);
+    ~record_stream();
+    record_stream(const record_stream&) = delete;
+    record_stream& operator=(const record_stream&) = delete;
+
+    template <typename T> record_stream& operator<<(const T& value) {
+        *strm << value;
+        return *this;
+    }
+
+    record_stream& operator<<(std::ios_base& (*manip)(std::ios_base&)) {
+        *strm << manip;
+        return *this;
+    }
+
+    record_stream& operator<<(std::basic_ios<char>& (*manip)(std::basic_ios<char>&)) {
+        *strm << manip;
+        return *this;
+    }
+
+    record_stream& operator<<(std::ostream& (*manip)(std::ostream&)) {
+        *strm << manip;
+        return *this;
+    }
+
+    template <typename RefT>
+    record_stream& operator<<(const boost::log::BOOST_LOG_VERSION_NAMESPACE::add_value_manip<RefT>& manip) {
+        namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+        using value_type =
+            typename logging::aux::make_embedded_string_type<typename logging::add_value_manip<RefT>::value_type>::type;
+        rec.attribute_values().insert(manip.get_name(), make_pooled_value(value_type(manip.get_value())));
+        return *this;
+    }
+
+    /// \brief completes the message, must be called once after the last argument
+    void finish();
+
+private:
+    boost::log::BOOST_LOG_VERSION_NAMESPACE::record& rec;
+    boost::log::BOOST_LOG_VERSION_NAMESPACE::formatting_ostream* strm;
+};
+
+/// \brief counterpart of the Boost.Log record pump, pushes the record when the EVLOG_* statement is complete
+template <typename LoggerT> class record_pump {
+public:
+    record_pump(LoggerT& logger, boost::log::BOOST_LOG_VERSION_NAMESPACE::record& rec) :
+        logger(logger), stream_(rec), rec(rec), exception_count(std::uncaught_exceptions()) {
+    }
+    record_pump(const record_pump&) = delete;
+    record_pump& operator=(const record_pump&) = delete;
+
+    ~record_pump() noexcept(false) {
+        // an argument threw, the record is dropped just like the Boost.Log pump does
+        if (exception_count >= std::uncaught_exceptions()) {
+            stream_.finish();
+            logger.push_record(std::move(rec));
+        }
+    }
+
+    record_stream& stream() {
+        return stream_;
+    }
+
+private:
+    LoggerT& logger;
+    record_stream stream_;
+    boost::log::BOOST_LOG_VERSION_NAMESPACE::record& rec;
+    const int exception_count;
+};
+
+template <typename LoggerT>
+record_pump<LoggerT> make_record_pump(LoggerT& logger, boost::log::BOOST_LOG_VERSION_NAMESPACE::record& rec) {
+    return record_pump<LoggerT>(logger, rec);
+}
+
+} // namespace detail
+} // namespace Logging
+} // namespace Everest
+
+#endif // RECORD_STREAM_HPP
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief Histogram of latencies in nanoseconds with a relative error of 1/8
+///
+/// Values below 8 ns have a bucket each, every power of two above is split into 8 buckets. The last bucket also
+/// counts everything above about 15 minutes.
+class latency_histogram {
+public:
+    static constexpr std::size_t bucket_count = 320;
+
+    /// \brief the bucket counting \p nanoseconds
+    static std::size_t bucket_of(std::uint64_t nanoseconds);
+    /// \brief the largest value counted by \p bucket
+    static std::uint64_t bucket_upper_bound(std::size_t bucket);
+
+    void add(std::uint64_t nanoseconds, std::uint64_t count = 1);
+    void merge(const latency_histogram& other);
+    std::uint64_t count() const;
+    /// \brief upper bound of the bucket holding the value at \p quantile (0 to 1), 0 if the histogram is empty
+    std::chrono::nanoseconds quantile(double quantile) const;
+
+    std::array<std::uint64_t, bucket_count> counts{};
+};
+
+///
+/// \brief What logging cost the process since it started, returned by stats()
+struct logging_stats {
+    struct severity_counts {
+        /// \brief records handed to the sinks
+        std::uint64_t emitted{0};
+        /// \brief EVLOG_* statements whose record the Core filter or all sink filters rejected
+        std::uint64_t filtered{0};
+        /// \brief records dropped by a full sink queue, see dropped_records()
+        std::uint64_t dropped{0};
+    };
+
+    struct sink_counts {
+        /// \brief name of the [Sinks.<name>] section
+        std::string name;
+        std::uint64_t records{0};
+        /// \brief bytes of the formatted records, 0 for sinks that write unformatted records
+        std::uint64_t bytes{0};
+        /// \brief most records the queue of an asynchronous sink held at once
+        std::size_t queue_high_water{0};
+        /// \brief time the backend took to write a record
+        latency_histogram write_latency;
+    };
+
+    /// \brief false if liblog was built without LIBLOG_STATS, everything else is empty then
+    bool enabled{false};
+    std::array<severity_counts, critical + 1> severities{};
+    /// \brief time an EVLOG_* statement that emitted a record took, from opening the record to handing it to the sinks
+    latency_histogram call_latency;
+    /// \brief the sinks liblog created for its destinations that are currently configured
+    std::vector<sink_counts> sinks;
+};
+
+/// \brief merges the counters of all threads and sinks, the counters keep running
+logging_stats stats();
+
+/// \brief one line summary of \p stats, as written by the [Stats] self-report
+std::string to_string(const logging_stats& stats);
+
+namespace detail {
+/// \brief counts an EVLOG_* statement of \p level in the counters of the calling thread
+void count_call(severity_level level, bool emitted, std::chrono::steady_clock::duration latency);
+
+///
+/// \brief Measures an EVLOG_* statement with LIBLOG_STATS, lives until the statement completed
+class call_stats {
+public:
+    explicit call_stats(severity_level level) : level(level), started(std::chrono::steady_clock::now()) {
+    }
+    ~call_stats() {
+        count_call(level, emitted, std::chrono::steady_clock::now() - started);
+    }
+    call_stats(const call_stats&) = delete;
+    call_stats& operator=(const call_stats&) = delete;
+
+    /// \brief notes whether the statement opened a record and returns \p rec
+    template <typename RecordT> RecordT opened(RecordT&& rec) {
+        emitted = !!rec;
+        return std::move(rec);
+    }
+
+private:
+    const severity_level level;
+    const std::chrono::steady_clock::time_point started;
+    bool emitted{false};
+};
+} // namespace detail
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // STATS_HPP
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief Program counters of a stack captured by capture_trace(), resolved to functions and source lines later
+///
+/// Capturing only walks the stack, which is cheap compared to resolving the frames. Frames deeper than max_frames
+/// are left out.
+struct raw_trace {
+    static constexpr std::size_t max_frames = 128;
+
+    std::array<std::uintptr_t, max_frames> pcs{};
+    std::size_t size{0};
+};
+
+/// \brief captures the stack of the calling thread, starting with the caller, without resolving it
+///
+/// The trace is empty if liblog was built without backtrace support or the backtrace state couldn't be created.
+raw_trace capture_trace();
+
+/// \brief creates the backtrace state and reads the debug information now instead of on the first trace
+///
+/// init() calls it with Preload=true in the [Trace] section, so the first trace() of a process isn't slower than the
+/// others.
+void preload_trace();
+
+///
+/// \brief One frame of a resolved raw_trace, a program counter in inlined code resolves to several frames
+///
+/// The function and file name point into the cache of resolved program counters and stay valid for the lifetime of
+/// the process.
+struct stack_frame {
+    std::uintptr_t pc;
+    /// \brief demangled if possible, empty if unknown
+    std::string_view function;
+    /// \brief empty if unknown
+    std::string_view filename;
+    int lineno;
+
+    bool unknown() const {
+        return function.empty() && filename.empty();
+    }
+};
+
+/// \brief resolves \p trace into \p frames, replacing their content
+///
+/// Resolved program counters are cached for the lifetime of the process, traces through the same call sites only
+/// resolve their frames once. Reusing \p frames and the buffer given to render() resolves and renders traces without
+/// allocating memory once their call sites are cached. With \p skip_unknown_root_frames the outermost frames are
+/// left out as long as neither their function nor file is known, e.g. the ones of the C library starting the process.
+void resolve_frames(const raw_trace& trace, std::vector<stack_frame>& frames, bool skip_unknown_root_frames = false);
+
+/// \brief resolves \p trace like resolve_frames() into a new vector
+std::vector<stack_frame> resolve_frames(const raw_trace& trace, bool skip_unknown_root_frames = false);
+
+/// \brief appends the text of trace() for \p frames to \p buffer, one "#N: function at file:line" line per frame
+void render(const std::vector<stack_frame>& frames, std::string& buffer);
+
+/// \brief resolves \p trace to the text trace() returns, see resolve_frames()
+std::string symbolize(const raw_trace& trace, bool skip_unknown_root_frames = false);
+
+/// \brief resolves \p trace like symbolize() on a background thread, which is started by the first call
+std::future<std::string> symbolize_async(const raw_trace& trace, bool skip_unknown_root_frames = false);
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // TRACE_HPP
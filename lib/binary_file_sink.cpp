@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "binary_file_sink.hpp"
+
+#include <everest/exceptions.hpp>
+
+namespace Everest {
+namespace Logging {
+
+binary_file_backend::binary_file_backend(const std::string& file_name, bool append, bool auto_flush) :
+    file(file_name, std::ios::binary | (append ? std::ios::app : std::ios::trunc)), auto_flush(auto_flush) {
+    if (!file.is_open()) {
+        throw EverestConfigError("Could not open binary log file " + file_name);
+    }
+    encoder.begin_session(buffer);
+    write_buffer();
+}
+
+void binary_file_backend::consume(const logging::record_view& rec) {
+    encoder.encode(rec, buffer);
+    write_buffer();
+    if (auto_flush) {
+        file.flush();
+    }
+}
+
+void binary_file_backend::flush() {
+    file.flush();
+}
+
+void binary_file_backend::write_buffer() {
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef BINARY_FILE_SINK_HPP
+#define BINARY_FILE_SINK_HPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/log/sinks/basic_sink_backend.hpp>
+
+#include "binary_log.hpp"
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief Sink backend writing records in the binary log format, see binary_log_encoder
+///
+/// The files are turned back into text by everest_log_decode. Every time the file is opened a new session is started,
+/// so a file that is appended to by consecutive runs stays decodable.
+class binary_file_backend
+    : public logging::sinks::basic_sink_backend<
+          logging::sinks::combine_requirements<logging::sinks::synchronized_feeding, logging::sinks::flushing>::type> {
+public:
+    /// \param file_name path of the log file, throws EverestConfigError if it can't be opened
+    /// \param append keep the existing content of the file instead of truncating it
+    /// \param auto_flush flush the file after every record
+    binary_file_backend(const std::string& file_name, bool append, bool auto_flush);
+
+    void consume(const logging::record_view& rec);
+    void flush();
+
+private:
+    void write_buffer();
+
+    std::ofstream file;
+    const bool auto_flush;
+    binary_log_encoder encoder;
+    std::vector<unsigned char> buffer;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // BINARY_FILE_SINK_HPP
@@ -0,0 +1,402 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "binary_log.hpp"
+
+#include <cstring>
+#include <iterator>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/attributes/constant.hpp>
+#include <boost/log/attributes/current_process_id.hpp>
+#include <boost/log/attributes/current_thread_id.hpp>
+#include <boost/log/attributes/value_extraction.hpp>
+
+#include <everest/deferred_message.hpp>
+#include <everest/exceptions.hpp>
+
+#include "time_stamp.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace attrs = logging::attributes;
+namespace posix_time = boost::posix_time;
+
+namespace {
+const logging::attribute_name severity_name("Severity");
+const logging::attribute_name timestamp_name("TimeStamp");
+const logging::attribute_name thread_id_name("ThreadID");
+const logging::attribute_name process_id_name("ProcessID");
+const logging::attribute_name process_name("Process");
+const logging::attribute_name line_id_name("LineID");
+const logging::attribute_name message_name("Message");
+
+void put_byte(std::vector<unsigned char>& out, std::uint8_t value) {
+    out.push_back(value);
+}
+
+void put_varint(std::vector<unsigned char>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+void put_signed_varint(std::vector<unsigned char>& out, std::int64_t value) {
+    put_varint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+void put_bytes(std::vector<unsigned char>& out, const void* data, std::size_t size) {
+    put_varint(out, size);
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+[[noreturn]] void throw_corrupt(const std::string& reason) {
+    throw EverestInternalError("Invalid binary log: " + reason);
+}
+
+std::uint8_t get_byte(std::istream& in) {
+    const auto value = in.get();
+    if (value == std::char_traits<char>::eof()) {
+        throw_corrupt("unexpected end of file");
+    }
+    return static_cast<std::uint8_t>(value);
+}
+
+std::uint64_t get_varint(std::istream& in) {
+    std::uint64_t value = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        const auto byte = get_byte(in);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw_corrupt("integer too long");
+}
+
+std::int64_t get_signed_varint(std::istream& in) {
+    const auto value = get_varint(in);
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+std::string get_bytes(std::istream& in) {
+    const auto size = get_varint(in);
+    std::string bytes;
+    // grown while reading, a corrupt size must not allocate more than the file holds
+    constexpr std::size_t chunk_size = 4096;
+    while (bytes.size() < size) {
+        const auto chunk = std::min<std::uint64_t>(size - bytes.size(), chunk_size);
+        const auto offset = bytes.size();
+        bytes.resize(offset + chunk);
+        if (!in.read(&bytes[offset], static_cast<std::streamsize>(chunk))) {
+            throw_corrupt("unexpected end of file");
+        }
+    }
+    return bytes;
+}
+
+template <typename T> void add_constant(logging::attribute_set& attributes, const logging::attribute_name& name, T value) {
+    attributes.insert(name, attrs::constant<T>(std::move(value)));
+}
+
+/// \brief attribute with a fixed Message value made by detail::make_message_value()
+class deferred_message_constant : public logging::attribute {
+    class impl : public logging::attribute::impl {
+    public:
+        explicit impl(logging::attribute_value value) : value(std::move(value)) {
+        }
+        logging::attribute_value get_value() override {
+            return value;
+        }
+
+    private:
+        const logging::attribute_value value;
+    };
+
+public:
+    explicit deferred_message_constant(deferred_message message) :
+        logging::attribute(new impl(detail::make_message_value(std::move(message)))) {
+    }
+};
+} // namespace
+
+void binary_log_encoder::begin_session(std::vector<unsigned char>& out) {
+    out.insert(out.end(), std::begin(binary_log::magic), std::end(binary_log::magic));
+    put_byte(out, binary_log::version);
+
+    static_strings.clear();
+    threads.clear();
+    defined_call_sites.clear();
+    last_process_name.clear();
+    last_process_name_id = 0;
+    next_string_id = 1;
+    last_timestamp = 0;
+}
+
+void binary_log_encoder::encode(const logging::record_view& rec, std::vector<unsigned char>& out) {
+    const auto& values = rec.attribute_values();
+
+    // definitions go first, the record itself is assembled in a second pass
+    std::uint8_t present = 0;
+
+    const auto site = logging::extract<const call_site*>(detail::call_site_attribute_name(), values);
+    if (site && site.get() != nullptr) {
+        define_call_site(*site.get(), out);
+        present |= binary_log::has_call_site;
+    }
+    const auto severity = logging::extract<severity_level>(severity_name, values);
+    if (severity) {
+        present |= binary_log::has_severity;
+    }
+    std::int64_t timestamp = 0;
+    if (const auto value = logging::extract<time_stamp>(timestamp_name, values)) {
+        timestamp = value.get().nanoseconds;
+        present |= binary_log::has_timestamp;
+    } else if (const auto time = logging::extract<posix_time::ptime>(timestamp_name, values)) {
+        if (!time.get().is_special()) {
+            timestamp = from_ptime(time.get()).nanoseconds;
+            present |= binary_log::has_timestamp;
+        }
+    }
+    std::uint32_t thread = 0;
+    if (const auto thread_id = logging::extract<attrs::current_thread_id::value_type>(thread_id_name, values)) {
+        thread = thread_index(thread_id.get().native_id(), out);
+        present |= binary_log::has_thread;
+    }
+    const auto process_id = logging::extract<attrs::current_process_id::value_type>(process_id_name, values);
+    if (process_id) {
+        present |= binary_log::has_process_id;
+    }
+    std::uint32_t name = 0;
+    if (const auto process = logging::extract<std::string>(process_name, values)) {
+        name = process_name_id(process.get(), out);
+        present |= binary_log::has_process_name;
+    }
+    const auto line_id = logging::extract<unsigned int>(line_id_name, values);
+    if (line_id) {
+        present |= binary_log::has_line_id;
+    }
+
+    put_byte(out, static_cast<std::uint8_t>(binary_log::entry::record));
+    put_byte(out, present);
+    if ((present & binary_log::has_call_site) != 0) {
+        put_varint(out, site.get()->id());
+    }
+    if ((present & binary_log::has_severity) != 0) {
+        put_byte(out, static_cast<std::uint8_t>(severity.get()));
+    }
+    if ((present & binary_log::has_timestamp) != 0) {
+        put_signed_varint(out, timestamp - last_timestamp);
+        last_timestamp = timestamp;
+    }
+    if ((present & binary_log::has_thread) != 0) {
+        put_varint(out, thread);
+    }
+    if ((present & binary_log::has_process_id) != 0) {
+        put_varint(out, process_id.get().native_id());
+    }
+    if ((present & binary_log::has_process_name) != 0) {
+        put_varint(out, name);
+    }
+    if ((present & binary_log::has_line_id) != 0) {
+        put_varint(out, line_id.get());
+    }
+
+    if (const auto message = logging::extract<deferred_message>(message_name, values)) {
+        put_byte(out, static_cast<std::uint8_t>(binary_log::message_kind::deferred));
+        put_bytes(out, message.get().data(), message.get().size());
+    } else if (const auto text = logging::extract<std::string>(message_name, values)) {
+        put_byte(out, static_cast<std::uint8_t>(binary_log::message_kind::text));
+        put_bytes(out, text.get().data(), text.get().size());
+    } else {
+        put_byte(out, static_cast<std::uint8_t>(binary_log::message_kind::none));
+    }
+}
+
+std::uint32_t binary_log_encoder::static_string_id(const char* string, std::vector<unsigned char>& out) {
+    const auto known = static_strings.find(string);
+    if (known != static_strings.end()) {
+        return known->second;
+    }
+    const auto id = define_string(string, std::strlen(string), out);
+    static_strings.emplace(string, id);
+    return id;
+}
+
+std::uint32_t binary_log_encoder::process_name_id(const std::string& name, std::vector<unsigned char>& out) {
+    // the process name hardly ever changes, it is only defined again if it does
+    if (last_process_name_id == 0 || name != last_process_name) {
+        last_process_name = name;
+        last_process_name_id = define_string(name.data(), name.size(), out);
+    }
+    return last_process_name_id;
+}
+
+std::uint32_t binary_log_encoder::define_string(const char* data, std::size_t size, std::vector<unsigned char>& out) {
+    const auto id = next_string_id++;
+    put_byte(out, static_cast<std::uint8_t>(binary_log::entry::string));
+    put_varint(out, id);
+    put_bytes(out, data, size);
+    return id;
+}
+
+std::uint32_t binary_log_encoder::thread_index(std::uint64_t native_id, std::vector<unsigned char>& out) {
+    const auto known = threads.find(native_id);
+    if (known != threads.end()) {
+        return known->second;
+    }
+    const auto index = static_cast<std::uint32_t>(threads.size() + 1);
+    threads.emplace(native_id, index);
+    put_byte(out, static_cast<std::uint8_t>(binary_log::entry::thread));
+    put_varint(out, index);
+    put_varint(out, native_id);
+    return index;
+}
+
+void binary_log_encoder::define_call_site(const call_site& site, std::vector<unsigned char>& out) {
+    const auto id = site.id();
+    if (id < defined_call_sites.size() && defined_call_sites[id]) {
+        return;
+    }
+    if (id >= defined_call_sites.size()) {
+        defined_call_sites.resize(id + 1);
+    }
+    defined_call_sites[id] = true;
+
+    const auto file = static_string_id(site.file, out);
+    const auto function = static_string_id(site.function, out);
+    put_byte(out, static_cast<std::uint8_t>(binary_log::entry::call_site));
+    put_varint(out, id);
+    put_varint(out, file);
+    put_varint(out, site.line);
+    put_varint(out, function);
+    put_byte(out, static_cast<std::uint8_t>(site.severity));
+    put_byte(out, static_cast<std::uint8_t>(site.shown));
+}
+
+bool binary_log_decoder::read(std::istream& in, logging::attribute_set& attributes) {
+    while (true) {
+        const auto next = in.get();
+        if (next == std::char_traits<char>::eof()) {
+            return false;
+        }
+
+        if (next == binary_log::magic[0]) {
+            read_session_header(in);
+            continue;
+        }
+        if (!in_session) {
+            throw_corrupt("missing session header");
+        }
+
+        switch (static_cast<binary_log::entry>(next)) {
+        case binary_log::entry::string: {
+            const auto id = static_cast<std::uint32_t>(get_varint(in));
+            string_storage.push_back(get_bytes(in));
+            strings[id] = string_storage.back().c_str();
+            break;
+        }
+        case binary_log::entry::thread: {
+            const auto index = static_cast<std::uint32_t>(get_varint(in));
+            threads[index] = get_varint(in);
+            break;
+        }
+        case binary_log::entry::call_site: {
+            const auto id = static_cast<std::uint32_t>(get_varint(in));
+            const auto* file = string(static_cast<std::uint32_t>(get_varint(in)));
+            const auto line = static_cast<unsigned int>(get_varint(in));
+            const auto* function = string(static_cast<std::uint32_t>(get_varint(in)));
+            const auto severity = static_cast<severity_level>(get_byte(in));
+            const auto shown = static_cast<unsigned int>(get_byte(in));
+            call_site_storage.push_back(std::make_unique<call_site>(file, line, function, severity, shown));
+            call_sites[id] = call_site_storage.back().get();
+            break;
+        }
+        case binary_log::entry::record: {
+            attributes.clear();
+            const auto present = get_byte(in);
+            if ((present & binary_log::has_call_site) != 0) {
+                const auto site = call_sites.find(static_cast<std::uint32_t>(get_varint(in)));
+                if (site == call_sites.end()) {
+                    throw_corrupt("undefined call site");
+                }
+                add_constant(attributes, detail::call_site_attribute_name(), site->second);
+            }
+            if ((present & binary_log::has_severity) != 0) {
+                add_constant(attributes, severity_name, static_cast<severity_level>(get_byte(in)));
+            }
+            if ((present & binary_log::has_timestamp) != 0) {
+                last_timestamp += get_signed_varint(in);
+                add_constant(attributes, timestamp_name, time_stamp{last_timestamp});
+            }
+            if ((present & binary_log::has_thread) != 0) {
+                const auto thread = threads.find(static_cast<std::uint32_t>(get_varint(in)));
+                if (thread == threads.end()) {
+                    throw_corrupt("undefined thread");
+                }
+                using thread_id = attrs::current_thread_id::value_type;
+                add_constant(attributes, thread_id_name,
+                             thread_id(static_cast<thread_id::native_type>(thread->second)));
+            }
+            if ((present & binary_log::has_process_id) != 0) {
+                using process_id = attrs::current_process_id::value_type;
+                add_constant(attributes, process_id_name,
+                             process_id(static_cast<process_id::native_type>(get_varint(in))));
+            }
+            if ((present & binary_log::has_process_name) != 0) {
+                add_constant(attributes, process_name,
+                             std::string(string(static_cast<std::uint32_t>(get_varint(in)))));
+            }
+            if ((present & binary_log::has_line_id) != 0) {
+                add_constant(attributes, line_id_name, static_cast<unsigned int>(get_varint(in)));
+            }
+
+            const auto kind = static_cast<binary_log::message_kind>(get_byte(in));
+            if (kind == binary_log::message_kind::text) {
+                add_constant(attributes, message_name, get_bytes(in));
+            } else if (kind == binary_log::message_kind::deferred) {
+                const auto data = get_bytes(in);
+                attributes.insert(message_name, deferred_message_constant(deferred_message(
+                                                    reinterpret_cast<const unsigned char*>(data.data()), data.size())));
+            } else if (kind != binary_log::message_kind::none) {
+                throw_corrupt("unknown message kind");
+            }
+            return true;
+        }
+        default:
+            throw_corrupt("unknown entry " + std::to_string(next));
+        }
+    }
+}
+
+void binary_log_decoder::read_session_header(std::istream& in) {
+    char rest[sizeof(binary_log::magic) - 1];
+    if (!in.read(rest, sizeof(rest)) || std::memcmp(rest, binary_log::magic + 1, sizeof(rest)) != 0) {
+        throw_corrupt("bad session header");
+    }
+    const auto session_version = get_byte(in);
+    if (session_version != binary_log::version) {
+        throw_corrupt("unsupported version " + std::to_string(session_version));
+    }
+
+    // ids are only unique within a session, the storage stays alive for the records already handed out
+    in_session = true;
+    strings.clear();
+    threads.clear();
+    call_sites.clear();
+    last_timestamp = 0;
+}
+
+const char* binary_log_decoder::string(std::uint32_t id) const {
+    const auto known = strings.find(id);
+    if (known == strings.end()) {
+        throw_corrupt("undefined string");
+    }
+    return known->second;
+}
+
+} // namespace Logging
+} // namespace Everest
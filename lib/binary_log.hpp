@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef BINARY_LOG_HPP
+#define BINARY_LOG_HPP
+
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/log/attributes/attribute_set.hpp>
+#include <boost/log/core/record_view.hpp>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief Compact binary encoding of log records
+///
+/// A binary log is a sequence of sessions, each starting with the 8 byte magic "EVLOGBIN" and a version byte. Within
+/// a session every entry starts with an entry byte:
+///  - string: id, length and characters of a static string, e.g. a file or function name
+///  - thread: id and native id of a thread
+///  - call_site: id, file string id, line, function string id, severity and shown fields of a call site
+///  - record: a byte of present_fields, followed by the present fields in the order of the enum, a message_kind byte
+///    and the message
+///
+/// All integers are LEB128 encoded, timestamps as zigzag encoded difference to the previous timestamp. Strings,
+/// threads and call sites are defined once per session right before the first record referring to them, so a
+/// session can be decoded on its own.
+namespace binary_log {
+constexpr char magic[8] = {'E', 'V', 'L', 'O', 'G', 'B', 'I', 'N'};
+constexpr std::uint8_t version = 1;
+
+enum class entry : std::uint8_t {
+    string = 1,
+    thread = 2,
+    call_site = 3,
+    record = 4,
+};
+
+enum present_fields : std::uint8_t {
+    has_call_site = 1 << 0,    ///< call site id
+    has_severity = 1 << 1,     ///< severity byte
+    has_timestamp = 1 << 2,    ///< TimeStamp in nanoseconds since 1970
+    has_thread = 1 << 3,       ///< thread id
+    has_process_id = 1 << 4,   ///< native ProcessID
+    has_process_name = 1 << 5, ///< string id of Process
+    has_line_id = 1 << 6,      ///< LineID
+};
+
+enum class message_kind : std::uint8_t {
+    none = 0,
+    text = 1,     ///< length and characters
+    deferred = 2, ///< length and the data of a deferred_message
+};
+} // namespace binary_log
+
+///
+/// \brief Encodes records into the binary log format
+///
+/// Only the attributes known to liblog are kept: CallSite, Severity, TimeStamp, ThreadID, ProcessID, Process, LineID
+/// and Message. Not thread safe.
+class binary_log_encoder {
+public:
+    /// \brief appends a session header to \p out, the next records are encoded independent of the previous ones
+    void begin_session(std::vector<unsigned char>& out);
+
+    /// \brief appends \p rec and all definitions it refers to to \p out
+    void encode(const logging::record_view& rec, std::vector<unsigned char>& out);
+
+private:
+    std::uint32_t static_string_id(const char* string, std::vector<unsigned char>& out);
+    std::uint32_t process_name_id(const std::string& name, std::vector<unsigned char>& out);
+    std::uint32_t define_string(const char* data, std::size_t size, std::vector<unsigned char>& out);
+    std::uint32_t thread_index(std::uint64_t native_id, std::vector<unsigned char>& out);
+    void define_call_site(const call_site& site, std::vector<unsigned char>& out);
+
+    std::unordered_map<const char*, std::uint32_t> static_strings;
+    std::unordered_map<std::uint64_t, std::uint32_t> threads;
+    std::vector<bool> defined_call_sites;
+    std::string last_process_name;
+    std::uint32_t last_process_name_id{0};
+    std::uint32_t next_string_id{1};
+    std::int64_t last_timestamp{0};
+};
+
+///
+/// \brief Decodes binary logs into attribute sets, to be pushed through the logging core again
+///
+/// The call sites and strings are kept for the lifetime of the decoder, records built from its attribute sets must
+/// not outlive it.
+class binary_log_decoder {
+public:
+    /// \brief reads the next record of \p in into \p attributes
+    /// \returns false at the end of \p in, throws EverestInternalError if \p in is no valid binary log
+    bool read(std::istream& in, logging::attribute_set& attributes);
+
+private:
+    void read_session_header(std::istream& in);
+    const char* string(std::uint32_t id) const;
+
+    bool in_session{false};
+    std::deque<std::string> string_storage;
+    std::deque<std::unique_ptr<call_site>> call_site_storage;
+    std::unordered_map<std::uint32_t, const char*> strings;
+    std::unordered_map<std::uint32_t, std::uint64_t> threads;
+    std::unordered_map<std::uint32_t, const call_site*> call_sites;
+    std::int64_t last_timestamp{0};
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // BINARY_LOG_HPP
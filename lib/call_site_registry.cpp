@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "call_site_registry.hpp"
+
+#include <algorithm>
+
+#include <fnmatch.h>
+
+#include <everest/exceptions.hpp>
+
+#include "sinks.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+bool matches(const std::string& pattern, const char* text) {
+    return pattern.empty() || ::fnmatch(pattern.c_str(), text, 0) == 0;
+}
+} // namespace
+
+call_site_rules call_site_rules::from_settings(const logging::settings& settings) {
+    call_site_rules parsed;
+    const auto section = settings.property_tree().get_child_optional("CallSites");
+    if (!section) {
+        return parsed;
+    }
+
+    for (const auto& entry : section.get()) {
+        if (entry.second.empty()) {
+            if (entry.first != "Default") {
+                throw EverestConfigError("Unknown setting CallSites." + entry.first);
+            }
+            parsed.default_severity = setting_to_severity("CallSites.Default", entry.second.data());
+            continue;
+        }
+
+        const auto name = "CallSites." + entry.first;
+        rule site_rule{entry.second.get<std::string>("File", ""), entry.second.get<std::string>("Function", ""),
+                       verbose};
+        if (site_rule.file.empty() && site_rule.function.empty()) {
+            throw EverestConfigError("Call site rule " + name + " needs a File or a Function pattern");
+        }
+        const auto severity = entry.second.get_optional<std::string>("Severity");
+        if (!severity) {
+            throw EverestConfigError("Call site rule " + name + " needs a Severity");
+        }
+        site_rule.severity = setting_to_severity(name + ".Severity", severity.get());
+        parsed.rules.push_back(std::move(site_rule));
+    }
+    return parsed;
+}
+
+severity_level call_site_rules::severity_of(const call_site& site) const {
+    for (auto it = rules.rbegin(); it != rules.rend(); ++it) {
+        if (matches(it->file, site.file) && matches(it->function, site.function)) {
+            return it->severity;
+        }
+    }
+    return default_severity;
+}
+
+call_site_registry& call_site_registry::instance() {
+    // never destroyed, the call_site_image of the executable is destroyed at exit and unregisters its call sites then
+    static auto* registry = new call_site_registry();
+    return *registry;
+}
+
+bool call_site_registry::add(const call_site& site) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // a concurrent first use might have registered the site already
+    if (site.enabled_state.load(std::memory_order_relaxed) == call_site::state_unknown) {
+        sites.push_back(&site);
+        update(site);
+    }
+    return site.enabled_state.load(std::memory_order_relaxed) == call_site::state_enabled;
+}
+
+void call_site_registry::remove_image(const call_site_image& image) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // the call sites of the image are still mapped while its static destructors run
+    sites.erase(std::remove_if(sites.begin(), sites.end(),
+                               [&image](const call_site* site) { return site->image == &image; }),
+                sites.end());
+}
+
+void call_site_registry::set_rules(call_site_rules new_rules) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rules = std::move(new_rules);
+    for (const auto* site : sites) {
+        update(*site);
+    }
+}
+
+void call_site_registry::update(const call_site& site) const {
+    const auto enabled = site.severity >= rules.severity_of(site);
+    site.enabled_state.store(enabled ? call_site::state_enabled : call_site::state_disabled,
+                             std::memory_order_relaxed);
+}
+
+bool call_site::register_site() const {
+    return call_site_registry::instance().add(*this);
+}
+
+call_site_image::~call_site_image() {
+    call_site_registry::instance().remove_image(*this);
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef CALL_SITE_REGISTRY_HPP
+#define CALL_SITE_REGISTRY_HPP
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/log/utility/setup/settings.hpp>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief Lowest severity of the EVLOG_* call sites that are enabled, per file and function
+///
+/// Configured by the [CallSites] section and its subsections:
+///  - CallSites.Default: severity for call sites no rule matches, defaults to VERB
+///  - CallSites.<name>.File: wildcard pattern (fnmatch) matched against the source file of the call site
+///  - CallSites.<name>.Function: wildcard pattern matched against the function signature of the call site
+///  - CallSites.<name>.Severity: lowest severity of the call sites the rule matches
+///
+/// A rule matches if all of its patterns match, the last matching rule decides.
+struct call_site_rules {
+    struct rule {
+        std::string file;
+        std::string function;
+        severity_level severity;
+    };
+
+    /// \brief parses the [CallSites] section of \p settings, throws EverestConfigError on invalid rules
+    static call_site_rules from_settings(const logging::settings& settings);
+
+    /// \brief lowest severity that is enabled for \p site
+    severity_level severity_of(const call_site& site) const;
+
+    severity_level default_severity{verbose};
+    std::vector<rule> rules;
+};
+
+///
+/// \brief Registry of all EVLOG_* call sites that were reached so far
+///
+/// Every call site caches whether it is enabled. The registry computes that flag when a call site is reached for the
+/// first time and recomputes it for all registered call sites when the rules change, so the EVLOG_* statements only
+/// read it. The call sites of an image are removed when its call_site_image is destroyed.
+class call_site_registry {
+public:
+    static call_site_registry& instance();
+
+    /// \brief registers \p site and computes its enabled flag, returns the flag
+    bool add(const call_site& site);
+
+    /// \brief unregisters the call sites of \p image, it's being unloaded
+    void remove_image(const call_site_image& image);
+
+    /// \brief replaces the rules and updates the enabled flag of all registered call sites
+    void set_rules(call_site_rules new_rules);
+
+private:
+    void update(const call_site& site) const;
+
+    std::mutex mutex;
+    std::vector<const call_site*> sites;
+    call_site_rules rules;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // CALL_SITE_REGISTRY_HPP
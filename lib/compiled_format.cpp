@@ -0,0 +1,327 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "compiled_format.hpp"
+
+#include <cctype>
+#include <type_traits>
+
+#include <sys/types.h>
+
+#include <boost/log/attributes/current_process_id.hpp>
+#include <boost/log/attributes/current_thread_id.hpp>
+#include <boost/log/attributes/value_extraction.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+
+#include <everest/logging.hpp>
+
+#include "formatters.hpp"
+#include "time_stamp.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+const logging::attribute_name time_stamp_name("TimeStamp");
+const logging::attribute_name process_name("Process");
+const logging::attribute_name process_id_name("ProcessID");
+const logging::attribute_name severity_name("Severity");
+const logging::attribute_name thread_id_name("ThreadID");
+const logging::attribute_name line_id_name("LineID");
+const logging::attribute_name file_name("file");
+const logging::attribute_name line_name("line");
+const logging::attribute_name function_name("function");
+
+constexpr char hex_digits[] = "0123456789abcdef";
+
+/// writes \p value as "0x" and all hex digits of its type, like Boost.Log writes thread and process ids
+template <typename T> void write_id(T value, logging::formatting_ostream& strm) {
+    char buffer[2 + 2 * sizeof(T)];
+    buffer[0] = '0';
+    buffer[1] = 'x';
+    for (std::size_t i = 0; i < 2 * sizeof(T); ++i) {
+        buffer[sizeof(buffer) - 1 - i] = hex_digits[(value >> (4 * i)) & 0xf];
+    }
+    strm.write(buffer, sizeof(buffer));
+}
+
+void write_unsigned(unsigned long value, logging::formatting_ostream& strm) {
+    char buffer[20];
+    auto* position = buffer + sizeof(buffer);
+    do {
+        *--position = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    strm.write(position, buffer + sizeof(buffer) - position);
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/// decodes the C escapes Boost.Log's formatter parser decodes in literal text
+std::string decode_escapes(const std::string& text) {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\' || i + 1 == text.size()) {
+            decoded += text[i];
+            continue;
+        }
+        const auto escaped = text[++i];
+        switch (escaped) {
+        case 'a':
+            decoded += '\a';
+            break;
+        case 'b':
+            decoded += '\b';
+            break;
+        case 'f':
+            decoded += '\f';
+            break;
+        case 'n':
+            decoded += '\n';
+            break;
+        case 'r':
+            decoded += '\r';
+            break;
+        case 't':
+            decoded += '\t';
+            break;
+        case 'v':
+            decoded += '\v';
+            break;
+        case 'x': {
+            int value = 0;
+            int digits = 0;
+            while (digits < 2 && i + 1 < text.size() && hex_value(text[i + 1]) >= 0) {
+                value = value * 16 + hex_value(text[++i]);
+                ++digits;
+            }
+            decoded += digits > 0 ? static_cast<char>(value) : 'x';
+            break;
+        }
+        default:
+            if (escaped >= '0' && escaped <= '7') {
+                int value = escaped - '0';
+                for (int digits = 1; digits < 3 && i + 1 < text.size() && text[i + 1] >= '0' && text[i + 1] <= '7';
+                     ++digits) {
+                    value = value * 8 + (text[++i] - '0');
+                }
+                decoded += static_cast<char>(value);
+            } else {
+                decoded += escaped;
+            }
+            break;
+        }
+    }
+    return decoded;
+}
+
+/// position after the placeholder starting with the '%' at \p start, std::string::npos if it isn't one
+std::size_t placeholder_end(const std::string& format, std::size_t start) {
+    auto position = start + 1;
+    while (position < format.size() &&
+           (std::isalnum(static_cast<unsigned char>(format[position])) != 0 || format[position] == '_')) {
+        ++position;
+    }
+    if (position == start + 1 || position == format.size()) {
+        return std::string::npos;
+    }
+    if (format[position] == '(') {
+        bool quoted = false;
+        for (++position; position < format.size(); ++position) {
+            if (quoted && format[position] == '\\') {
+                ++position;
+            } else if (format[position] == '"') {
+                quoted = !quoted;
+            } else if (!quoted && format[position] == ')') {
+                break;
+            }
+        }
+        if (position >= format.size()) {
+            return std::string::npos;
+        }
+        ++position;
+    }
+    if (position == format.size() || format[position] != '%') {
+        return std::string::npos;
+    }
+    return position + 1;
+}
+} // namespace
+
+compiled_format::compiled_format(const std::string& format) {
+    // reports invalid formats the same way as Boost.Log
+    const auto whole_format = logging::parse_formatter(format);
+
+    std::string literal;
+    for (std::size_t position = 0; position < format.size();) {
+        if (format[position] != '%') {
+            const auto next = format.find('%', position);
+            literal += format.substr(position, next - position);
+            position = next == std::string::npos ? format.size() : next;
+            continue;
+        }
+        const auto end = placeholder_end(format, position);
+        if (end == std::string::npos) {
+            // not understood, Boost.Log formats all of it
+            program.clear();
+            literals.clear();
+            delegated.assign(1, whole_format);
+            program.push_back({opcode::delegated, 0});
+            return;
+        }
+        add_literal(literal);
+        literal.clear();
+        add_placeholder(format.substr(position, end - position));
+        position = end;
+    }
+    add_literal(literal);
+}
+
+void compiled_format::add_literal(const std::string& text) {
+    if (text.empty()) {
+        return;
+    }
+    literals.push_back(decode_escapes(text));
+    program.push_back({opcode::literal, static_cast<std::uint32_t>(literals.size() - 1)});
+}
+
+void compiled_format::add_placeholder(const std::string& placeholder) {
+    static const std::vector<std::pair<std::string, opcode>> compiled_placeholders = {
+        {"%TimeStamp%", opcode::time_stamp},
+        {"%Process%", opcode::process},
+        {"%ProcessID%", opcode::process_id},
+        {"%Severity%", opcode::severity},
+        {"%ThreadID%", opcode::thread_id},
+        {"%LineID%", opcode::line_id},
+        {"%file%", opcode::file},
+        {"%line%", opcode::line},
+        {"%function%", opcode::function},
+        {"%Message%", opcode::message},
+        {"%FormattedMessage%", opcode::message},
+        {"%EscapedMessage%", opcode::escaped_message},
+        {"%JsonEscapedMessage%", opcode::json_escaped_message},
+    };
+
+    // every placeholder keeps the formatter of Boost.Log, values of unexpected types are written by it
+    delegated.push_back(logging::parse_formatter(placeholder));
+    auto code = opcode::delegated;
+    for (const auto& compiled : compiled_placeholders) {
+        if (compiled.first == placeholder) {
+            code = compiled.second;
+            break;
+        }
+    }
+    program.push_back({code, static_cast<std::uint32_t>(delegated.size() - 1)});
+}
+
+bool compiled_format::fully_compiled() const {
+    for (const auto& step : program) {
+        if (step.code == opcode::delegated) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void compiled_format::operator()(const logging::record_view& rec, logging::formatting_ostream& strm) const {
+    const auto& values = rec.attribute_values();
+    for (const auto& step : program) {
+        switch (step.code) {
+        case opcode::literal: {
+            const auto& text = literals[step.operand];
+            strm.write(text.data(), static_cast<std::streamsize>(text.size()));
+            continue;
+        }
+        case opcode::time_stamp: {
+            const auto value = logging::extract<time_stamp>(time_stamp_name, values);
+            if (value) {
+                write_time_stamp(value.get(), strm);
+                continue;
+            }
+            break;
+        }
+        case opcode::process: {
+            const auto value = logging::extract<std::string>(process_name, values);
+            if (value) {
+                strm.write(value.get().data(), static_cast<std::streamsize>(value.get().size()));
+                continue;
+            }
+            break;
+        }
+        case opcode::process_id: {
+            const auto value = logging::extract<logging::attributes::current_process_id::value_type>(process_id_name,
+                                                                                                    values);
+            if (value) {
+                // Boost.Log writes as many digits as a pid_t has
+                write_id(static_cast<std::make_unsigned_t<pid_t>>(value.get().native_id()), strm);
+                continue;
+            }
+            break;
+        }
+        case opcode::severity: {
+            const auto value = logging::extract<severity_level>(severity_name, values);
+            if (value) {
+                write_severity(value.get(), strm);
+                continue;
+            }
+            break;
+        }
+        case opcode::thread_id: {
+            const auto value = logging::extract<logging::attributes::current_thread_id::value_type>(thread_id_name,
+                                                                                                   values);
+            if (value) {
+                write_id(value.get().native_id(), strm);
+                continue;
+            }
+            break;
+        }
+        case opcode::line_id: {
+            const auto value = logging::extract<unsigned int>(line_id_name, values);
+            if (value) {
+                write_unsigned(value.get(), strm);
+                continue;
+            }
+            break;
+        }
+        case opcode::file:
+            format_call_site(rec, strm, call_site_field::file, file_name);
+            continue;
+        case opcode::line:
+            format_call_site(rec, strm, call_site_field::line, line_name);
+            continue;
+        case opcode::function:
+            format_call_site(rec, strm, call_site_field::function, function_name);
+            continue;
+        case opcode::message:
+            format_message(rec, strm);
+            continue;
+        case opcode::escaped_message:
+            format_escaped_message(rec, strm);
+            continue;
+        case opcode::json_escaped_message:
+            format_json_escaped_message(rec, strm);
+            continue;
+        case opcode::delegated:
+            break;
+        }
+        delegated[step.operand](rec, strm);
+    }
+}
+
+logging::formatter compile_formatter(const std::string& format) {
+    return logging::formatter(compiled_format(format));
+}
+
+} // namespace Logging
+} // namespace Everest
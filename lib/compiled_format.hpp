@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef COMPILED_FORMAT_HPP
+#define COMPILED_FORMAT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/log/attributes/attribute_name.hpp>
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/expressions/formatter.hpp>
+#include <boost/log/utility/formatting_ostream.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief Formatter compiled once from a Format setting into a flat list of instructions
+///
+/// Literal text between the placeholders is decoded (C escapes like Boost.Log's formatter parser) and concatenated,
+/// including the color escapes. The placeholders liblog configures by default (%TimeStamp%, %Process%, %ProcessID%,
+/// %Severity%, %ThreadID%, %LineID%, %function%, %file%, %line%, %Message%, %FormattedMessage%, %EscapedMessage%,
+/// %JsonEscapedMessage%) are written by dedicated instructions, producing the same text as Boost.Log. Other
+/// placeholders and placeholders with arguments are delegated to the formatter Boost.Log parses for them.
+class compiled_format {
+public:
+    /// \throws boost::log::parse_error like logging::parse_formatter() if \p format is invalid
+    explicit compiled_format(const std::string& format);
+
+    void operator()(const logging::record_view& rec, logging::formatting_ostream& strm) const;
+
+    /// \brief true if no placeholder of the format had to be delegated to Boost.Log
+    bool fully_compiled() const;
+
+private:
+    enum class opcode : std::uint8_t {
+        literal,
+        time_stamp,
+        process,
+        process_id,
+        severity,
+        thread_id,
+        line_id,
+        file,
+        line,
+        function,
+        message,
+        escaped_message,
+        json_escaped_message,
+        delegated,
+    };
+
+    struct instruction {
+        opcode code;
+        std::uint32_t operand; ///< index into literals or delegated
+    };
+
+    void add_literal(const std::string& text);
+    void add_placeholder(const std::string& placeholder);
+
+    std::vector<instruction> program;
+    std::vector<std::string> literals;
+    std::vector<logging::formatter> delegated;
+};
+
+/// \brief compiles \p format into a compiled_format, throws like logging::parse_formatter()
+logging::formatter compile_formatter(const std::string& format);
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // COMPILED_FORMAT_HPP
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "config_watcher.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <everest/exceptions.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+/// changes within this time after the first one are reported together, editors write files in several steps
+constexpr int settle_time_ms = 100;
+
+constexpr std::uint32_t watched_events = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+/// reads all pending events of \p inotify_fd, returns true if one of them concerns \p file_name
+bool read_events(int inotify_fd, const std::string& file_name) {
+    alignas(inotify_event) char buffer[4096];
+    bool concerned = false;
+    for (;;) {
+        const auto length = ::read(inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return concerned;
+        }
+        for (auto* position = buffer; position < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(position);
+            if (event->len > 0 && file_name == event->name) {
+                concerned = true;
+            }
+            position += sizeof(inotify_event) + event->len;
+        }
+    }
+}
+} // namespace
+
+config_watcher::config_watcher(const std::string& file_name, std::function<void()> changed) :
+    changed(std::move(changed)) {
+    const auto separator = file_name.rfind('/');
+    const auto directory = separator == std::string::npos ? std::string(".") : file_name.substr(0, separator + 1);
+    this->file_name = separator == std::string::npos ? file_name : file_name.substr(separator + 1);
+
+    inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stop_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotify_fd == -1 || stop_fd == -1 || ::inotify_add_watch(inotify_fd, directory.c_str(), watched_events) == -1) {
+        const auto error = errno;
+        if (inotify_fd != -1) {
+            ::close(inotify_fd);
+        }
+        if (stop_fd != -1) {
+            ::close(stop_fd);
+        }
+        throw EverestInternalError("Could not watch " + file_name + " for changes: " + std::strerror(error));
+    }
+
+    watcher = std::thread(&config_watcher::run, this);
+}
+
+config_watcher::~config_watcher() {
+    const std::uint64_t stop = 1;
+    // a single write to an eventfd only fails on an invalid descriptor
+    [[maybe_unused]] const auto written = ::write(stop_fd, &stop, sizeof(stop));
+    watcher.join();
+    ::close(inotify_fd);
+    ::close(stop_fd);
+}
+
+void config_watcher::run() {
+    pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+    bool pending = false;
+    for (;;) {
+        const auto ready = ::poll(fds, 2, pending ? settle_time_ms : -1);
+        if (ready == -1 && errno != EINTR) {
+            return;
+        }
+        if ((fds[1].revents & POLLIN) != 0) {
+            return;
+        }
+        if ((fds[0].revents & POLLIN) != 0) {
+            pending = read_events(inotify_fd, file_name) || pending;
+            continue;
+        }
+        if (ready == 0 && pending) {
+            pending = false;
+            changed();
+        }
+    }
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef CONFIG_WATCHER_HPP
+#define CONFIG_WATCHER_HPP
+
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief Calls a function from its own thread whenever a file changed
+///
+/// The directory of the file is watched with inotify, so files replaced by editors or configuration management are
+/// noticed as well. Changes that follow each other within a short time are reported once.
+class config_watcher {
+public:
+    /// \throws EverestInternalError if the directory of \p file_name can't be watched
+    config_watcher(const std::string& file_name, std::function<void()> changed);
+    ~config_watcher();
+    config_watcher(const config_watcher&) = delete;
+    config_watcher& operator=(const config_watcher&) = delete;
+
+private:
+    void run();
+
+    const std::function<void()> changed;
+    std::string file_name;
+    int inotify_fd{-1};
+    int stop_fd{-1};
+    std::thread watcher;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // CONFIG_WATCHER_HPP
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "crash_handler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+
+#include <execinfo.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+constexpr std::size_t max_flushables = 64;
+constexpr int max_backtrace_frames = 128;
+constexpr int crash_signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+std::atomic<crash_flushable*> flushables[max_flushables];
+std::atomic<std::int64_t> flush_timeout_ns{0};
+/// the thread handling a crash, 0 while there is none
+std::atomic<long> handling_thread{0};
+
+std::mutex install_mutex;
+bool installed = false;
+/// the signal handler runs on it in the installing thread, so a stack overflow there can be reported
+alignas(16) char alternate_stack[64 * 1024];
+
+/// writes all of \p size bytes, there's nowhere to report errors
+void write_all(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+void write_text(int fd, const char* text) {
+    write_all(fd, text, std::strlen(text));
+}
+
+void write_number(int fd, std::uintptr_t number, int base = 10) {
+    char digits[24];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), number, base).ptr;
+    write_all(fd, digits, static_cast<std::size_t>(end - digits));
+}
+
+const char* signal_name(int signo) {
+    switch (signo) {
+    case SIGSEGV:
+        return "SIGSEGV";
+    case SIGBUS:
+        return "SIGBUS";
+    case SIGFPE:
+        return "SIGFPE";
+    case SIGILL:
+        return "SIGILL";
+    case SIGABRT:
+        return "SIGABRT";
+    default:
+        return "signal";
+    }
+}
+
+std::int64_t monotonic_ns() {
+    timespec now{};
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<std::int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/// waits up to the flush timeout for the threads of the sinks to hand on their queued records, then writes the buffers
+void flush_sinks() {
+    for (auto& slot : flushables) {
+        if (auto* sink = slot.load(std::memory_order_acquire)) {
+            sink->begin_crash_flush();
+        }
+    }
+
+    const auto deadline = monotonic_ns() + flush_timeout_ns.load(std::memory_order_relaxed);
+    while (true) {
+        bool flushed = true;
+        for (const auto& slot : flushables) {
+            const auto* sink = slot.load(std::memory_order_acquire);
+            if (sink != nullptr && !sink->crash_flushed()) {
+                flushed = false;
+                break;
+            }
+        }
+        if (flushed || monotonic_ns() >= deadline) {
+            break;
+        }
+        const timespec pause{0, 1000000};
+        ::nanosleep(&pause, nullptr);
+    }
+
+    // the buffers are written even if the threads didn't make it in time, they might be blocked by a lock the crashed
+    // thread holds
+    for (auto& slot : flushables) {
+        if (auto* sink = slot.load(std::memory_order_acquire)) {
+            sink->write_pending_on_crash();
+        }
+    }
+}
+
+void write_report(int fd, int signo, const siginfo_t* info, void* const* pcs, int frame_count) {
+    write_text(fd, "Fatal signal ");
+    write_number(fd, static_cast<std::uintptr_t>(signo));
+    write_text(fd, " (");
+    write_text(fd, signal_name(signo));
+    write_text(fd, ")");
+    if (signo != SIGABRT && info != nullptr) {
+        write_text(fd, " at address 0x");
+        write_number(fd, reinterpret_cast<std::uintptr_t>(info->si_addr), 16);
+    }
+    write_text(fd, ", backtrace of thread ");
+    write_number(fd, static_cast<std::uintptr_t>(handling_thread.load(std::memory_order_relaxed)));
+    write_text(fd, " (resolve the offsets with addr2line -Cfe <binary> <offset>):\n");
+    backtrace_symbols_fd(pcs, frame_count, fd);
+}
+
+void handle_crash(int signo, siginfo_t* info, void* /* context */) {
+    const auto saved_errno = errno;
+    const auto self = static_cast<long>(::syscall(SYS_gettid));
+    long none = 0;
+    if (handling_thread.compare_exchange_strong(none, self)) {
+        flush_sinks();
+
+        void* pcs[max_backtrace_frames];
+        const auto frame_count = backtrace(pcs, max_backtrace_frames);
+        write_report(STDERR_FILENO, signo, info, pcs, frame_count);
+        // log files get the report too, file descriptors written to by several sinks get it only once
+        int reported[max_flushables];
+        std::size_t reported_count = 0;
+        for (const auto& slot : flushables) {
+            const auto* sink = slot.load(std::memory_order_acquire);
+            const auto fd = (sink != nullptr) ? sink->crash_report_fd() : -1;
+            if (fd <= STDERR_FILENO ||
+                std::find(reported, reported + reported_count, fd) != reported + reported_count) {
+                continue;
+            }
+            reported[reported_count++] = fd;
+            write_report(fd, signo, info, pcs, frame_count);
+        }
+    } else if (none != self) {
+        // another thread crashed as well, the process dies once the first one is done
+        while (true) {
+            ::pause();
+        }
+    }
+    // the handler crashed itself or is done, the default action dumps the core
+    std::signal(signo, SIG_DFL);
+    errno = saved_errno;
+    std::raise(signo);
+}
+} // namespace
+
+void register_crash_flushable(crash_flushable* sink) {
+    for (auto& slot : flushables) {
+        crash_flushable* empty = nullptr;
+        if (slot.compare_exchange_strong(empty, sink, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+}
+
+void unregister_crash_flushable(crash_flushable* sink) {
+    for (auto& slot : flushables) {
+        auto* registered = sink;
+        if (slot.compare_exchange_strong(registered, nullptr, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+}
+
+void install_crash_handler(std::chrono::milliseconds flush_timeout) {
+    flush_timeout_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(flush_timeout).count(),
+                           std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(install_mutex);
+    if (installed) {
+        return;
+    }
+    // the first backtrace() loads the unwinder, which allocates
+    void* warm_up[1];
+    backtrace(warm_up, 1);
+
+    stack_t stack{};
+    stack.ss_sp = alternate_stack;
+    stack.ss_size = sizeof(alternate_stack);
+    ::sigaltstack(&stack, nullptr);
+
+    struct sigaction action {};
+    action.sa_sigaction = handle_crash;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    for (const auto signo : crash_signals) {
+        ::sigaction(signo, &action, nullptr);
+    }
+    installed = true;
+}
+
+} // namespace Logging
+} // namespace Everest
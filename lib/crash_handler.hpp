@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef CRASH_HANDLER_HPP
+#define CRASH_HANDLER_HPP
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief A sink holding records that the crash handler of install_crash_handler() writes out before the process dies
+///
+/// All member functions are called from the signal handler and must be async-signal-safe: no locks, no allocations,
+/// only lock-free atomics and system calls like write(). A sink registers itself once it is fully constructed and
+/// unregisters before it is destroyed.
+class crash_flushable {
+public:
+    /// \brief asks the threads of the sink to write out what's queued now
+    virtual void begin_crash_flush() noexcept {
+    }
+    /// \brief whether everything queued at begin_crash_flush() was handed on, e.g. to the buffer of a backend
+    virtual bool crash_flushed() const noexcept {
+        return true;
+    }
+    /// \brief writes what's still buffered from the signal handler itself, once the queues are flushed or waiting for
+    /// them timed out
+    virtual void write_pending_on_crash() noexcept {
+    }
+    /// \brief file descriptor the records are written to, which also gets the crash report, -1 if there's none
+    virtual int crash_report_fd() const noexcept {
+        return -1;
+    }
+
+protected:
+    ~crash_flushable() = default;
+};
+
+/// \brief makes \p sink part of the crash flush, sinks beyond the first 64 are left out
+void register_crash_flushable(crash_flushable* sink);
+void unregister_crash_flushable(crash_flushable* sink);
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // CRASH_HANDLER_HPP
@@ -0,0 +1,293 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <everest/deferred_message.hpp>
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+#include <boost/log/attributes/attribute_value_impl.hpp>
+#include <boost/log/utility/formatting_ostream.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+using manipulator = deferred_message::manipulator;
+
+const std::array<std::pair<deferred_message::ios_manipulator, manipulator>, 20> ios_manipulators = {{
+    {std::boolalpha, manipulator::boolalpha},
+    {std::noboolalpha, manipulator::noboolalpha},
+    {std::showbase, manipulator::showbase},
+    {std::noshowbase, manipulator::noshowbase},
+    {std::showpoint, manipulator::showpoint},
+    {std::noshowpoint, manipulator::noshowpoint},
+    {std::showpos, manipulator::showpos},
+    {std::noshowpos, manipulator::noshowpos},
+    {std::uppercase, manipulator::uppercase},
+    {std::nouppercase, manipulator::nouppercase},
+    {std::left, manipulator::left},
+    {std::right, manipulator::right},
+    {std::internal, manipulator::internal},
+    {std::dec, manipulator::dec},
+    {std::hex, manipulator::hex},
+    {std::oct, manipulator::oct},
+    {std::fixed, manipulator::fixed},
+    {std::scientific, manipulator::scientific},
+    {std::hexfloat, manipulator::hexfloat},
+    {std::defaultfloat, manipulator::defaultfloat},
+}};
+
+const std::array<std::pair<deferred_message::ostream_manipulator, manipulator>, 3> ostream_manipulators = {{
+    {std::endl<char, std::char_traits<char>>, manipulator::endl},
+    {std::ends<char, std::char_traits<char>>, manipulator::ends},
+    {std::flush<char, std::char_traits<char>>, manipulator::flush},
+}};
+
+/// the parameterized manipulators have unspecified types, their value is read back from a stream they are applied to
+std::ostream& scratch_stream() {
+    thread_local std::ostream strm(nullptr);
+    return strm;
+}
+
+void apply_manipulator(std::ostream& strm, manipulator manip) {
+    for (const auto& entry : ios_manipulators) {
+        if (entry.second == manip) {
+            strm << entry.first;
+            return;
+        }
+    }
+    for (const auto& entry : ostream_manipulators) {
+        if (entry.second == manip) {
+            strm << entry.first;
+            return;
+        }
+    }
+}
+
+/// reads a value at \p position, restored messages might be truncated so nothing is read beyond \p end
+template <typename T> bool read_value(const unsigned char*& position, const unsigned char* end, T& value) {
+    if (static_cast<std::size_t>(end - position) < sizeof(T)) {
+        position = end;
+        return false;
+    }
+    std::memcpy(&value, position, sizeof(T));
+    position += sizeof(T);
+    return true;
+}
+
+template <typename T> void render_value(std::ostream& strm, const unsigned char*& position, const unsigned char* end) {
+    T value;
+    if (read_value(position, end, value)) {
+        strm << value;
+    }
+}
+} // namespace
+
+void deferred_message::append_string(const char* data, std::size_t size) {
+    const auto length = static_cast<std::uint32_t>(size);
+    const auto offset = buffer.size();
+    buffer.resize(offset + 1 + sizeof(length) + length);
+    buffer[offset] = static_cast<unsigned char>(tag::string);
+    std::memcpy(&buffer[offset + 1], &length, sizeof(length));
+    std::memcpy(&buffer[offset + 1 + sizeof(length)], data, length);
+}
+
+bool deferred_message::append_manipulator(ios_manipulator manip) {
+    for (const auto& entry : ios_manipulators) {
+        if (entry.first == manip) {
+            append_value(tag::manipulator, entry.second);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool deferred_message::append_manipulator(ostream_manipulator manip) {
+    for (const auto& entry : ostream_manipulators) {
+        if (entry.first == manip) {
+            append_value(tag::manipulator, entry.second);
+            return true;
+        }
+    }
+    return false;
+}
+
+void deferred_message::append_manipulator(setprecision_type manip) {
+    auto& strm = scratch_stream();
+    strm << manip;
+    append_value(tag::precision, static_cast<std::int64_t>(strm.precision()));
+}
+
+void deferred_message::append_manipulator(setw_type manip) {
+    auto& strm = scratch_stream();
+    strm << manip;
+    append_value(tag::width, static_cast<std::int64_t>(strm.width()));
+    strm.width(0);
+}
+
+void deferred_message::append_manipulator(setfill_type manip) {
+    auto& strm = scratch_stream();
+    strm << manip;
+    append_value(tag::fill, strm.fill());
+}
+
+void deferred_message::render(std::ostream& strm) const {
+    const auto* position = buffer.data();
+    const auto* const end = position + buffer.size();
+
+    while (position < end) {
+        const auto value_tag = static_cast<tag>(*position++);
+        switch (value_tag) {
+        case tag::boolean:
+            render_value<bool>(strm, position, end);
+            break;
+        case tag::character:
+            render_value<char>(strm, position, end);
+            break;
+        case tag::int16:
+            render_value<std::int16_t>(strm, position, end);
+            break;
+        case tag::uint16:
+            render_value<std::uint16_t>(strm, position, end);
+            break;
+        case tag::int32:
+            render_value<std::int32_t>(strm, position, end);
+            break;
+        case tag::uint32:
+            render_value<std::uint32_t>(strm, position, end);
+            break;
+        case tag::int64:
+            render_value<std::int64_t>(strm, position, end);
+            break;
+        case tag::uint64:
+            render_value<std::uint64_t>(strm, position, end);
+            break;
+        case tag::float32:
+            render_value<float>(strm, position, end);
+            break;
+        case tag::float64:
+            render_value<double>(strm, position, end);
+            break;
+        case tag::long_double:
+            render_value<long double>(strm, position, end);
+            break;
+        case tag::pointer: {
+            std::uintptr_t address = 0;
+            if (read_value(position, end, address)) {
+                strm << reinterpret_cast<const void*>(address);
+            }
+            break;
+        }
+        case tag::string: {
+            std::uint32_t length = 0;
+            if (read_value(position, end, length)) {
+                length = std::min<std::uint32_t>(length, static_cast<std::uint32_t>(end - position));
+                strm << std::string_view(reinterpret_cast<const char*>(position), length);
+                position += length;
+            }
+            break;
+        }
+        case tag::manipulator: {
+            manipulator manip{};
+            if (read_value(position, end, manip)) {
+                apply_manipulator(strm, manip);
+            }
+            break;
+        }
+        case tag::precision: {
+            std::int64_t precision = 0;
+            if (read_value(position, end, precision)) {
+                strm.precision(static_cast<std::streamsize>(precision));
+            }
+            break;
+        }
+        case tag::width: {
+            std::int64_t width = 0;
+            if (read_value(position, end, width)) {
+                strm.width(static_cast<std::streamsize>(width));
+            }
+            break;
+        }
+        case tag::fill: {
+            char fill = 0;
+            if (read_value(position, end, fill)) {
+                strm.fill(fill);
+            }
+            break;
+        }
+        default:
+            // not produced by this version, nothing after it can be interpreted
+            return;
+        }
+    }
+}
+
+std::string deferred_message::str() const {
+    std::string text;
+    boost::log::BOOST_LOG_VERSION_NAMESPACE::formatting_ostream strm(text);
+    render(strm.stream());
+    strm.flush();
+    return text;
+}
+
+std::ostream& operator<<(std::ostream& strm, const deferred_message& message) {
+    return strm << message.str();
+}
+
+namespace detail {
+namespace {
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+class message_value : public logging::attributes::attribute_value_impl<deferred_message> {
+public:
+    using attribute_value_impl::attribute_value_impl;
+
+    bool dispatch(logging::type_dispatcher& dispatcher) override {
+        if (auto callback = dispatcher.get_callback<deferred_message>()) {
+            callback(get());
+            return true;
+        }
+        // extracted values refer to the value, the text is rendered once for visitors that don't know deferred messages
+        if (auto callback = dispatcher.get_callback<std::string>()) {
+            std::call_once(rendered, [this]() { text = get().str(); });
+            callback(text);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    std::once_flag rendered;
+    std::string text;
+};
+} // namespace
+
+boost::log::BOOST_LOG_VERSION_NAMESPACE::attribute_value make_message_value(deferred_message message) {
+    return boost::log::BOOST_LOG_VERSION_NAMESPACE::attribute_value(new message_value(std::move(message)));
+}
+
+void deferred_record_stream::finish() {
+    namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+    if (text) {
+        text->flush();
+        text.reset();
+        return;
+    }
+
+    static const logging::attribute_name message_name("Message");
+    rec.attribute_values().insert(message_name, make_message_value(std::move(message)));
+}
+
+boost::log::BOOST_LOG_VERSION_NAMESPACE::record_ostream& deferred_record_stream::text_stream() {
+    if (!text) {
+        text.emplace(rec);
+        message.render(text->stream());
+    }
+    return *text;
+}
+} // namespace detail
+
+} // namespace Logging
+} // namespace Everest
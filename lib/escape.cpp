@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "escape.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+/// replacement of a character, a length of 0 means it's written as is
+struct escape {
+    char text[7];
+    std::uint8_t length;
+};
+
+using escape_table = std::array<escape, 256>;
+
+void set_escape(escape_table& table, char character, const char* text, std::uint8_t length) {
+    auto& entry = table[static_cast<unsigned char>(character)];
+    for (std::uint8_t i = 0; i < length; ++i) {
+        entry.text[i] = text[i];
+    }
+    entry.length = length;
+}
+
+/// the escapes of Boost.Log's c_decor
+const escape_table& c_escapes() {
+    static const escape_table table = [] {
+        escape_table escapes{};
+        set_escape(escapes, '\\', "\\\\", 2);
+        set_escape(escapes, '\a', "\\a", 2);
+        set_escape(escapes, '\b', "\\b", 2);
+        set_escape(escapes, '\f', "\\f", 2);
+        set_escape(escapes, '\n', "\\n", 2);
+        set_escape(escapes, '\r', "\\r", 2);
+        set_escape(escapes, '\t', "\\t", 2);
+        set_escape(escapes, '\v', "\\v", 2);
+        set_escape(escapes, '\'', "\\'", 2);
+        set_escape(escapes, '"', "\\\"", 2);
+        set_escape(escapes, '?', "\\?", 2);
+        return escapes;
+    }();
+    return table;
+}
+
+/// the escapes of RFC 8259, control characters without a short escape are written as \u00XX
+const escape_table& json_escapes() {
+    static const escape_table table = [] {
+        constexpr char hex_digits[] = "0123456789abcdef";
+        escape_table escapes{};
+        for (int character = 0; character < 0x20; ++character) {
+            const char text[] = {'\\', 'u', '0', '0', hex_digits[character >> 4], hex_digits[character & 0xf]};
+            set_escape(escapes, static_cast<char>(character), text, sizeof(text));
+        }
+        set_escape(escapes, '\b', "\\b", 2);
+        set_escape(escapes, '\f', "\\f", 2);
+        set_escape(escapes, '\n', "\\n", 2);
+        set_escape(escapes, '\r', "\\r", 2);
+        set_escape(escapes, '\t', "\\t", 2);
+        set_escape(escapes, '"', "\\\"", 2);
+        set_escape(escapes, '\\', "\\\\", 2);
+        return escapes;
+    }();
+    return table;
+}
+
+const char* find_in_table(const escape_table& table, const char* begin, const char* end) {
+    for (auto position = begin; position != end; ++position) {
+        if (table[static_cast<unsigned char>(*position)].length != 0) {
+            return position;
+        }
+    }
+    return end;
+}
+
+/// Collects short spans and escapes, every write to a formatting_ostream has a noticeable overhead.
+class buffered_writer {
+public:
+    explicit buffered_writer(logging::formatting_ostream& strm) : strm(strm) {
+    }
+
+    ~buffered_writer() {
+        flush();
+    }
+
+    void write(const char* data, std::size_t size) {
+        if (size > sizeof(buffer) - used) {
+            flush();
+            if (size >= sizeof(buffer)) {
+                strm.write(data, static_cast<std::streamsize>(size));
+                return;
+            }
+        }
+        std::memcpy(buffer + used, data, size);
+        used += size;
+    }
+
+private:
+    void flush() {
+        strm.write(buffer, static_cast<std::streamsize>(used));
+        used = 0;
+    }
+
+    logging::formatting_ostream& strm;
+    char buffer[256];
+    std::size_t used{0};
+};
+
+void write_with_escapes(const escape_table& table, const char* (*find)(const char*, const char*),
+                        const std::string& text, logging::formatting_ostream& strm) {
+    auto unwritten = text.data();
+    const auto end = text.data() + text.size();
+    auto position = find(unwritten, end);
+    if (position == end) {
+        strm.write(unwritten, end - unwritten);
+        return;
+    }
+
+    buffered_writer writer(strm);
+    for (; position != end; position = find(unwritten, end)) {
+        writer.write(unwritten, static_cast<std::size_t>(position - unwritten));
+        const auto& replacement = table[static_cast<unsigned char>(*position)];
+        writer.write(replacement.text, replacement.length);
+        unwritten = position + 1;
+    }
+    writer.write(unwritten, static_cast<std::size_t>(end - unwritten));
+}
+} // namespace
+
+const char* find_c_escape(const char* begin, const char* end) {
+    auto position = begin;
+#if defined(__SSE2__)
+    for (; end - position >= 16; position += 16) {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+        auto found = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'));
+        found = _mm_or_si128(found, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')));
+        found = _mm_or_si128(found, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\'')));
+        found = _mm_or_si128(found, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('?')));
+        // \a to \r are consecutive, an unsigned comparison finds all of them
+        const auto control = _mm_sub_epi8(chunk, _mm_set1_epi8('\a'));
+        found = _mm_or_si128(found, _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8('\r' - '\a')), control));
+        const auto mask = _mm_movemask_epi8(found);
+        if (mask != 0) {
+            return position + __builtin_ctz(static_cast<unsigned int>(mask));
+        }
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    for (; end - position >= 16; position += 16) {
+        const auto chunk = vld1q_u8(reinterpret_cast<const std::uint8_t*>(position));
+        auto found = vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('\\')), vceqq_u8(chunk, vdupq_n_u8('"')));
+        found = vorrq_u8(found, vceqq_u8(chunk, vdupq_n_u8('\'')));
+        found = vorrq_u8(found, vceqq_u8(chunk, vdupq_n_u8('?')));
+        // \a to \r are consecutive, an unsigned comparison finds all of them
+        found = vorrq_u8(found, vcleq_u8(vsubq_u8(chunk, vdupq_n_u8('\a')), vdupq_n_u8('\r' - '\a')));
+        if (vmaxvq_u8(found) != 0) {
+            break;
+        }
+    }
+#endif
+    return find_in_table(c_escapes(), position, end);
+}
+
+const char* find_json_escape(const char* begin, const char* end) {
+    auto position = begin;
+#if defined(__SSE2__)
+    for (; end - position >= 16; position += 16) {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+        auto found = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'));
+        found = _mm_or_si128(found, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')));
+        found = _mm_or_si128(found, _mm_cmpeq_epi8(_mm_min_epu8(chunk, _mm_set1_epi8(0x1f)), chunk));
+        const auto mask = _mm_movemask_epi8(found);
+        if (mask != 0) {
+            return position + __builtin_ctz(static_cast<unsigned int>(mask));
+        }
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    for (; end - position >= 16; position += 16) {
+        const auto chunk = vld1q_u8(reinterpret_cast<const std::uint8_t*>(position));
+        auto found = vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('\\')), vceqq_u8(chunk, vdupq_n_u8('"')));
+        found = vorrq_u8(found, vcltq_u8(chunk, vdupq_n_u8(0x20)));
+        if (vmaxvq_u8(found) != 0) {
+            break;
+        }
+    }
+#endif
+    return find_in_table(json_escapes(), position, end);
+}
+
+void write_escaped(const std::string& text, logging::formatting_ostream& strm) {
+    write_with_escapes(c_escapes(), &find_c_escape, text, strm);
+}
+
+void write_json_escaped(const std::string& text, logging::formatting_ostream& strm) {
+    write_with_escapes(json_escapes(), &find_json_escape, text, strm);
+}
+
+} // namespace Logging
+} // namespace Everest
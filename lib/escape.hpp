@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef ESCAPE_HPP
+#define ESCAPE_HPP
+
+#include <string>
+
+#include <boost/log/utility/formatting_ostream.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief first character in [\p begin, \p end) that write_escaped() escapes, \p end if there is none
+///
+/// Checks 16 characters at once with SSE2 or NEON where available, most messages contain nothing to escape.
+const char* find_c_escape(const char* begin, const char* end);
+
+/// \brief first character in [\p begin, \p end) that write_json_escaped() escapes, \p end if there is none
+const char* find_json_escape(const char* begin, const char* end);
+
+/// \brief writes \p text with the C escapes of Boost.Log's c_decor, as %EscapedMessage% does
+void write_escaped(const std::string& text, logging::formatting_ostream& strm);
+
+/// \brief writes \p text escaped as the content of a JSON string, as %JsonEscapedMessage% does
+///
+/// Quotes, backslashes and control characters are escaped, all other bytes including UTF-8 sequences are written
+/// as they are.
+void write_json_escaped(const std::string& text, logging::formatting_ostream& strm);
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // ESCAPE_HPP
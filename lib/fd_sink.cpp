@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "fd_sink.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <boost/log/attributes/value_extraction.hpp>
+
+#include <everest/exceptions.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+const logging::attribute_name severity_name("Severity");
+
+/// writes all of \p vectors, records that can't be written are dropped, there's nowhere to report the error
+void write_all(int fd, iovec* vectors, int count) {
+    while (count > 0) {
+        const auto written = ::writev(fd, vectors, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        auto remaining = static_cast<std::size_t>(written);
+        while (count > 0 && remaining >= vectors->iov_len) {
+            remaining -= vectors->iov_len;
+            ++vectors;
+            --count;
+        }
+        if (count > 0) {
+            vectors->iov_base = static_cast<char*>(vectors->iov_base) + remaining;
+            vectors->iov_len -= remaining;
+        }
+    }
+}
+} // namespace
+
+fd_backend::fd_backend(int fd, bool close_fd, const fd_flush_policy& policy,
+                       logging::sinks::auto_newline_mode auto_newline) :
+    fd(fd), close_fd(close_fd), policy(policy), auto_newline(auto_newline), buffer(policy.buffer_size) {
+    if (policy.interval.count() > 0) {
+        flusher = std::thread(&fd_backend::run_flusher, this);
+    }
+    register_crash_flushable(this);
+}
+
+fd_backend::~fd_backend() {
+    unregister_crash_flushable(this);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    pending_changed.notify_one();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    write_out(nullptr, 0, false);
+    if (close_fd) {
+        ::close(fd);
+    }
+}
+
+int fd_backend::open_file(const std::string& file_name, bool append) {
+    const auto fd =
+        ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (append ? 0 : O_TRUNC), 0644);
+    if (fd < 0) {
+        throw EverestConfigError("Could not open log file " + file_name + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+void fd_backend::consume(const logging::record_view& rec, const std::string& formatted) {
+    const bool add_newline =
+        auto_newline == logging::sinks::always_insert ||
+        (auto_newline == logging::sinks::insert_if_missing && (formatted.empty() || formatted.back() != '\n'));
+    const auto size = formatted.size() + (add_newline ? 1 : 0);
+    const auto severity = logging::extract<severity_level>(severity_name, rec);
+    const bool urgent = policy.interval.count() == 0 || (severity && severity.get() >= policy.severity);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    const bool was_empty = used == 0;
+    if (size > buffer.size() - used) {
+        // the record is written straight from the formatting buffer, together with the buffered ones
+        write_out(formatted.data(), formatted.size(), add_newline);
+        return;
+    }
+
+    std::memcpy(buffer.data() + used, formatted.data(), formatted.size());
+    used += formatted.size();
+    if (add_newline) {
+        buffer[used++] = '\n';
+    }
+    crash_pending.store(used, std::memory_order_release);
+    if (urgent || used == buffer.size()) {
+        write_out(nullptr, 0, false);
+    } else if (was_empty) {
+        lock.unlock();
+        pending_changed.notify_one();
+    }
+}
+
+void fd_backend::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    write_out(nullptr, 0, false);
+}
+
+void fd_backend::write_out(const char* extra, std::size_t extra_size, bool extra_newline) {
+    static char newline = '\n';
+    iovec vectors[3];
+    int count = 0;
+    // the crash handler might have written the buffer already
+    const auto unclaimed = crash_pending.exchange(0, std::memory_order_acq_rel);
+    if (unclaimed > 0) {
+        vectors[count++] = {buffer.data(), unclaimed};
+    }
+    if (extra_size > 0) {
+        vectors[count++] = {const_cast<char*>(extra), extra_size};
+    }
+    if (extra_newline) {
+        vectors[count++] = {&newline, 1};
+    }
+    write_all(fd, vectors, count);
+    used = 0;
+}
+
+void fd_backend::write_pending_on_crash() noexcept {
+    iovec vector{buffer.data(), crash_pending.exchange(0, std::memory_order_acq_rel)};
+    write_all(fd, &vector, 1);
+}
+
+int fd_backend::crash_report_fd() const noexcept {
+    return fd;
+}
+
+void fd_backend::run_flusher() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (used == 0) {
+            pending_changed.wait(lock);
+            continue;
+        }
+        // the first buffered record arrived just before the notification, it is written after at most the interval
+        pending_changed.wait_for(lock, policy.interval, [this] { return stopping; });
+        write_out(nullptr, 0, false);
+    }
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef FD_SINK_HPP
+#define FD_SINK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/log/sinks/auto_newline_mode.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+
+#include <everest/logging.hpp>
+
+#include "crash_handler.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief When an fd_backend writes its buffer to the file descriptor
+struct fd_flush_policy {
+    /// \brief longest time a record stays in the buffer, zero writes every record right away
+    std::chrono::milliseconds interval{20};
+    /// \brief the buffer is written once it holds this many bytes, larger records are written without copying them
+    std::size_t buffer_size{64 * 1024};
+    /// \brief records of this severity or above are written right away, together with the ones buffered before
+    severity_level severity{error};
+};
+
+///
+/// \brief Sink backend writing formatted records to a file descriptor through a user space buffer
+///
+/// Unlike a text_ostream_backend with AutoFlush, a record doesn't cost a write() of its own. The buffer is written with
+/// a single writev(), together with the record that didn't fit anymore, when it reaches the high-water mark, when a
+/// record of the flush severity arrives, when flush() is called and at the latest after the flush interval, by a
+/// thread of the backend that sleeps as long as the buffer is empty. A crash handler writes out what's left in the buffer
+/// itself.
+class fd_backend
+    : public logging::sinks::basic_formatted_sink_backend<
+          char, logging::sinks::combine_requirements<logging::sinks::synchronized_feeding,
+                                                     logging::sinks::flushing>::type>,
+      public crash_flushable {
+public:
+    /// \param fd the file descriptor to write to
+    /// \param close_fd close \p fd when the backend is destroyed
+    fd_backend(int fd, bool close_fd, const fd_flush_policy& policy,
+               logging::sinks::auto_newline_mode auto_newline = logging::sinks::insert_if_missing);
+    ~fd_backend();
+    fd_backend(const fd_backend&) = delete;
+    fd_backend& operator=(const fd_backend&) = delete;
+
+    /// \brief opens \p file_name for appending, truncating it unless \p append is set, throws EverestConfigError
+    static int open_file(const std::string& file_name, bool append);
+
+    void consume(const logging::record_view& rec, const std::string& formatted);
+    void flush();
+
+    void write_pending_on_crash() noexcept override;
+    int crash_report_fd() const noexcept override;
+
+private:
+    /// writes the buffer followed by \p extra and a newline if \p extra_newline is set, the mutex must be held
+    void write_out(const char* extra, std::size_t extra_size, bool extra_newline);
+    void run_flusher();
+
+    const int fd;
+    const bool close_fd;
+    const fd_flush_policy policy;
+    const logging::sinks::auto_newline_mode auto_newline;
+
+    std::mutex mutex;
+    std::condition_variable pending_changed;
+    std::vector<char> buffer;
+    std::size_t used{0};
+    /// the complete bytes at the start of the buffer, a copy of used, whoever exchanges it for 0 writes them
+    std::atomic<std::size_t> crash_pending{0};
+    bool stopping{false};
+    std::thread flusher;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // FD_SINK_HPP
@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "flight_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include <boost/log/attributes/attribute.hpp>
+#include <boost/log/attributes/constant.hpp>
+#include <boost/log/attributes/value_extraction.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/utility/setup/filter_parser.hpp>
+#include <boost/make_shared.hpp>
+
+#include <everest/exceptions.hpp>
+
+#include "binary_log.hpp"
+#include "formatters.hpp"
+#include "sinks.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+/// the record currently opened by this thread is only recorded, it's marked as such
+thread_local bool recording = false;
+/// the record currently opened by this thread writes out the recorded ones once the recorder consumes it
+thread_local bool triggering = false;
+/// this thread writes out recorded records, they pass the core filter
+thread_local bool replaying = false;
+
+std::mutex installed_mutex;
+boost::shared_ptr<flight_recorder> installed_recorder;
+
+const logging::attribute_name severity_name("Severity");
+/// keeps the decoder of written out records alive as long as they are, it owns their call sites
+const logging::attribute_name decoder_name("FlightRecorderDecoder");
+
+constexpr std::size_t default_ring_size = 1024 * 1024;
+
+/// Factory of the %FlightRecorded% filter, true while the record opened by this thread is only recorded. The core and
+/// sink filters are evaluated in the same open_record() call, so the flag set by the core filter is still valid.
+class marker_filter_factory : public logging::filter_factory<char> {
+public:
+    logging::filter on_exists_test(const logging::attribute_name&) override {
+        return [](const logging::attribute_value_set&) { return recording; };
+    }
+};
+
+/// encodes the records recorded by this thread, every frame is a session of its own so it can be dropped on its own
+std::vector<unsigned char>& encode(const logging::record_view& rec) {
+    thread_local binary_log_encoder encoder;
+    thread_local std::vector<unsigned char> frame;
+    frame.clear();
+    encoder.begin_session(frame);
+    encoder.encode(rec, frame);
+    return frame;
+}
+} // namespace
+
+flight_recorder::flight_recorder(logging::filter core_filter, std::size_t capacity, std::size_t ring_size,
+                                 severity_level min_severity, severity_level trigger) :
+    // records are encoded by the thread logging them, they don't have to be detached
+    logging::sinks::sink(false),
+    filter(std::move(core_filter)),
+    capacity(capacity),
+    min_severity(min_severity),
+    trigger(trigger),
+    ring(ring_size) {
+}
+
+bool flight_recorder::will_consume(const logging::attribute_value_set&) {
+    return recording || triggering;
+}
+
+void flight_recorder::consume(const logging::record_view& rec) {
+    // the flags may belong to a record opened while this one was formatted, the record itself decides
+    const auto& values = rec.attribute_values();
+    const auto severity = logging::extract<severity_level>(severity_name, values);
+    if (severity && severity.get() >= trigger && filter(values)) {
+        dump();
+        return;
+    }
+    record(encode(rec));
+}
+
+bool flight_recorder::try_consume(const logging::record_view& rec) {
+    consume(rec);
+    return true;
+}
+
+void flight_recorder::flush() {
+}
+
+bool flight_recorder::core_filter(const logging::attribute_value_set& attributes) {
+    if (replaying) {
+        return true;
+    }
+
+    recording = false;
+    triggering = false;
+    const auto severity = logging::extract<severity_level>(severity_name, attributes);
+    if (filter(attributes)) {
+        triggering = severity && severity.get() >= trigger;
+        return true;
+    }
+    if (severity && severity.get() >= min_severity) {
+        recording = true;
+        return true;
+    }
+    return false;
+}
+
+void flight_recorder::record(const std::vector<unsigned char>& frame) {
+    const auto frame_size = static_cast<std::uint32_t>(frame.size());
+    const auto size = sizeof(frame_size) + frame.size();
+    if (size > ring.size()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(records_mutex);
+    while (count == capacity || used + size > ring.size()) {
+        drop_oldest();
+    }
+    const auto end = (oldest + used) % ring.size();
+    copy_in(end, &frame_size, sizeof(frame_size));
+    copy_in((end + sizeof(frame_size)) % ring.size(), frame.data(), frame.size());
+    used += size;
+    ++count;
+}
+
+void flight_recorder::drop_oldest() {
+    std::uint32_t frame_size = 0;
+    copy_out(oldest, &frame_size, sizeof(frame_size));
+    const auto size = sizeof(frame_size) + frame_size;
+    oldest = (oldest + size) % ring.size();
+    used -= size;
+    --count;
+}
+
+void flight_recorder::copy_in(std::size_t position, const void* data, std::size_t size) {
+    const auto first = std::min(size, ring.size() - position);
+    std::memcpy(ring.data() + position, data, first);
+    std::memcpy(ring.data(), static_cast<const unsigned char*>(data) + first, size - first);
+}
+
+void flight_recorder::copy_out(std::size_t position, void* data, std::size_t size) const {
+    const auto first = std::min(size, ring.size() - position);
+    std::memcpy(data, ring.data() + position, first);
+    std::memcpy(static_cast<unsigned char*>(data) + first, ring.data(), size - first);
+}
+
+void flight_recorder::dump() {
+    // the frames are sessions of the binary log format, together they form a binary log
+    std::string recorded;
+    {
+        std::lock_guard<std::mutex> lock(records_mutex);
+        auto position = oldest;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint32_t frame_size = 0;
+            copy_out(position, &frame_size, sizeof(frame_size));
+            const auto offset = recorded.size();
+            recorded.resize(offset + frame_size);
+            copy_out((position + sizeof(frame_size)) % ring.size(), &recorded[offset], frame_size);
+            position = (position + sizeof(frame_size) + frame_size) % ring.size();
+        }
+        oldest = 0;
+        used = 0;
+        count = 0;
+    }
+    if (recorded.empty()) {
+        return;
+    }
+
+    struct replay_guard {
+        replay_guard() {
+            recording = false;
+            triggering = false;
+            replaying = true;
+        }
+        ~replay_guard() {
+            replaying = false;
+        }
+    } guard;
+
+    auto decoder = boost::make_shared<binary_log_decoder>();
+    const logging::attribute keep_decoder =
+        logging::attributes::constant<boost::shared_ptr<binary_log_decoder>>(decoder);
+    std::istringstream in(recorded);
+    logging::attribute_set attributes;
+    auto core = logging::core::get();
+    while (decoder->read(in, attributes)) {
+        attributes.insert(decoder_name, keep_decoder);
+        if (auto replayed = core->open_record(attributes)) {
+            core->push_record(std::move(replayed));
+        }
+    }
+}
+
+boost::shared_ptr<flight_recorder> flight_recorder::from_settings(const logging::settings& settings) {
+    if (!enabled(settings)) {
+        return nullptr;
+    }
+
+    const auto capacity = setting_to_size("Capacity", settings["FlightRecorder.Capacity"].get().get());
+    auto ring_size = default_ring_size;
+    if (auto ring_size_setting = settings["FlightRecorder.RingSize"].get()) {
+        ring_size = setting_to_size("RingSize", ring_size_setting.get());
+    }
+    auto min_severity = verbose;
+    if (auto severity = settings["FlightRecorder.Severity"].get()) {
+        min_severity = setting_to_severity("Severity", severity.get());
+    }
+    auto trigger = error;
+    if (auto trigger_setting = settings["FlightRecorder.Trigger"].get()) {
+        trigger = setting_to_severity("Trigger", trigger_setting.get());
+    }
+    logging::filter core_filter;
+    if (auto filter_setting = settings["Core.Filter"].get()) {
+        core_filter = logging::parse_filter(filter_setting.get());
+    }
+
+    return boost::make_shared<flight_recorder>(core_filter, capacity, ring_size, min_severity, trigger);
+}
+
+void flight_recorder::install(boost::shared_ptr<flight_recorder> recorder) {
+    auto core = logging::core::get();
+
+    std::lock_guard<std::mutex> lock(installed_mutex);
+    if (installed_recorder) {
+        core->remove_sink(installed_recorder);
+    }
+    installed_recorder = std::move(recorder);
+    if (!installed_recorder) {
+        return;
+    }
+
+    // installed after the sinks of the settings, they get a trigger record before the recorder writes out the others
+    core->add_sink(installed_recorder);
+    core->set_filter([recorder = installed_recorder](const logging::attribute_value_set& attributes) {
+        return recorder->core_filter(attributes);
+    });
+}
+
+void flight_recorder::setup(const logging::settings& settings) {
+    install(from_settings(settings));
+}
+
+void flight_recorder::register_marker_filter() {
+    logging::register_filter_factory(marker_name(), boost::make_shared<marker_filter_factory>());
+}
+
+bool flight_recorder::enabled(const logging::settings& settings) {
+    return settings.has_section("FlightRecorder") && settings["FlightRecorder.Capacity"].get();
+}
+
+boost::shared_ptr<flight_recorder> flight_recorder::installed() {
+    std::lock_guard<std::mutex> lock(installed_mutex);
+    return installed_recorder;
+}
+
+const logging::attribute_name& flight_recorder::marker_name() {
+    static const logging::attribute_name name("FlightRecorded");
+    return name;
+}
+
+void dump_flight_recorder() {
+    if (auto recorder = flight_recorder::installed()) {
+        recorder->dump();
+    }
+}
+
+} // namespace Logging
+} // namespace Everest
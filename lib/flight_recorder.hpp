@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef FLIGHT_RECORDER_HPP
+#define FLIGHT_RECORDER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/expressions/filter.hpp>
+#include <boost/log/sinks/sink.hpp>
+#include <boost/log/utility/setup/settings.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief Keeps the last records the Core filter rejects in memory and writes them out when an error is logged
+///
+/// Configured by the [FlightRecorder] section:
+///  - Capacity: number of records kept, the recorder is disabled if it is missing or 0
+///  - RingSize: bytes the kept records take at most, 1048576 (1 MiB) by default
+///  - Severity: lowest severity that is recorded, defaults to VERB
+///  - Trigger: records of this severity or above that pass the Core filter write out the recorded ones right after
+///    them, defaults to ERRO
+///
+/// The recorder replaces the core filter by one that lets records it wants to keep pass as well, the Message attribute
+/// is only added to records that passed it. The %FlightRecorded% filter matches these records, prepare_sink_settings()
+/// makes all configured sinks ignore them. Sinks added to the core in code get them as well, their filters need
+/// "not %FlightRecorded%" to skip them. The recorder encodes them with binary_log_encoder into a fixed ring of RingSize
+/// bytes in the logging thread, so they are not detached.
+/// Written out records are decoded again and go through the sinks as if they had passed the Core filter right away,
+/// with the attributes the binary log keeps.
+///
+/// The recorder is the last sink in the core, it writes out the recorded records when it consumes a trigger record,
+/// after the other sinks got it. The core filter never writes out records itself.
+class flight_recorder : public logging::sinks::sink {
+public:
+    /// \param core_filter the Core filter of the settings
+    flight_recorder(logging::filter core_filter, std::size_t capacity, std::size_t ring_size,
+                    severity_level min_severity, severity_level trigger);
+
+    bool will_consume(const logging::attribute_value_set& attributes) override;
+    void consume(const logging::record_view& rec) override;
+    bool try_consume(const logging::record_view& rec) override;
+    void flush() override;
+
+    /// \brief the filter to install into the logging core
+    bool core_filter(const logging::attribute_value_set& attributes);
+
+    /// \brief writes out and forgets the recorded records, oldest first
+    void dump();
+
+    /// \brief creates the recorder configured in \p settings, nullptr if \p settings don't enable it
+    static boost::shared_ptr<flight_recorder> from_settings(const logging::settings& settings);
+
+    /// \brief installs \p recorder into the logging core in place of the one installed before, nullptr only removes it
+    static void install(boost::shared_ptr<flight_recorder> recorder);
+
+    /// \brief installs the recorder configured in \p settings, or removes the one installed before if \p settings
+    /// don't enable it
+    static void setup(const logging::settings& settings);
+
+    /// \brief true if \p settings enable a recorder
+    static bool enabled(const logging::settings& settings);
+
+    /// \brief the recorder currently installed, if any
+    static boost::shared_ptr<flight_recorder> installed();
+
+    /// \brief registers the %FlightRecorded% filter, matching records that are only recorded
+    static void register_marker_filter();
+
+    /// \brief name of the filter matching records that are only recorded
+    static const logging::attribute_name& marker_name();
+
+private:
+    /// \brief appends an encoded record to the ring, dropping the oldest ones until it fits
+    void record(const std::vector<unsigned char>& frame);
+    void drop_oldest();
+
+    void copy_in(std::size_t position, const void* data, std::size_t size);
+    void copy_out(std::size_t position, void* data, std::size_t size) const;
+
+    const logging::filter filter;
+    const std::size_t capacity;
+    const severity_level min_severity;
+    const severity_level trigger;
+
+    std::mutex records_mutex;
+    /// ring of frames, each a std::uint32_t size followed by a binary log session holding a single record
+    std::vector<unsigned char> ring;
+    std::size_t oldest{0}; ///< position of the oldest frame
+    std::size_t used{0};   ///< bytes taken by the frames
+    std::size_t count{0};  ///< number of frames
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // FLIGHT_RECORDER_HPP
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef FORMATTERS_HPP
+#define FORMATTERS_HPP
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include <boost/log/attributes/attribute_name.hpp>
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/utility/formatting_ostream.hpp>
+#include <boost/log/utility/setup/settings.hpp>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief registers the filter and formatter factories of liblog
+///
+/// These are %EscapedMessage%, %JsonEscapedMessage%, %FormattedMessage%, %file%, %line%, %function%, %Severity% and
+/// %TimeStamp%. Needs to be called before a Format or Filter setting is parsed.
+void register_formatter_factories();
+
+/// \brief takes the colors %Severity% is printed with from the SeverityStringColor* settings of \p sink
+void set_severity_colors(const logging::settings_section& sink);
+
+/// \brief writes the severity string of \p level in the colors of set_severity_colors()
+std::ostream& operator<<(std::ostream& strm, severity_level level);
+
+/// \brief same as operator<<(), without the overhead of a formatted output operation
+void write_severity(severity_level level, logging::formatting_ostream& strm);
+
+/// \brief parses the severity strings used by %Severity% (VERB, DEBG, INFO, ...)
+std::istream& operator>>(std::istream& strm, severity_level& level);
+
+/// \brief writes the message of \p rec, which is either plain text or was captured in deferred formatting mode
+void format_message(const logging::record_view& rec, logging::formatting_ostream& strm);
+
+/// \brief writes the message of \p rec with the C escapes of %EscapedMessage%
+void format_escaped_message(const logging::record_view& rec, logging::formatting_ostream& strm);
+
+/// \brief writes the message of \p rec escaped as the content of a JSON string, for %JsonEscapedMessage%
+void format_json_escaped_message(const logging::record_view& rec, logging::formatting_ostream& strm);
+
+/// \brief the call site fields of the %file%, %line% and %function% placeholders
+enum class call_site_field {
+    file,
+    line,
+    function,
+};
+
+///
+/// \brief writes \p field of the call site of \p rec
+///
+/// Records that were not emitted by an EVLOG_* statement might carry a plain attribute \p name instead, which is
+/// written as is.
+void format_call_site(const logging::record_view& rec, logging::formatting_ostream& strm, call_site_field field,
+                      const logging::attribute_name& name);
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // FORMATTERS_HPP
@@ -0,0 +1,278 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "lockfree_sink.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+std::atomic<std::uint64_t> next_sink_id{1};
+
+constexpr auto min_poll_interval = std::chrono::microseconds(100);
+constexpr auto max_poll_interval = std::chrono::milliseconds(10);
+
+std::int64_t queue_timestamp() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+} // namespace
+
+/// The rings a thread produces into, one per lockfree_sink it logged into.
+struct lockfree_sink::thread_producers {
+    std::vector<std::pair<std::uint64_t, std::shared_ptr<producer>>> entries;
+
+    ~thread_producers() {
+        for (auto& entry : entries) {
+            entry.second->abandoned.store(true, std::memory_order_release);
+        }
+    }
+};
+
+lockfree_sink::lockfree_sink(boost::shared_ptr<logging::sinks::sink> target, logging::filter filter,
+                             std::size_t queue_capacity) :
+    logging::sinks::sink(true),
+    id(next_sink_id.fetch_add(1, std::memory_order_relaxed)),
+    target(std::move(target)),
+    queue_capacity(queue_capacity),
+    filter(nullptr) {
+    set_filter(std::move(filter));
+    writer = std::thread(&lockfree_sink::run, this);
+    register_crash_flushable(this);
+}
+
+lockfree_sink::~lockfree_sink() {
+    unregister_crash_flushable(this);
+    stop();
+}
+
+bool lockfree_sink::will_consume(const logging::attribute_value_set& attributes) {
+    return (*filter.load(std::memory_order_acquire))(attributes);
+}
+
+void lockfree_sink::set_filter(logging::filter new_filter) {
+    std::lock_guard<std::mutex> lock(filters_mutex);
+    filters.push_back(std::make_unique<const logging::filter>(std::move(new_filter)));
+    filter.store(filters.back().get(), std::memory_order_release);
+}
+
+void lockfree_sink::consume(const logging::record_view& rec) {
+    auto& local = local_producer();
+    local.pushing.store(true);
+    if (stopped.load()) {
+        local.pushing.store(false, std::memory_order_release);
+        target->consume(rec);
+        return;
+    }
+
+    queued_record entry{queue_timestamp(), rec};
+    while (!local.ring.try_push(std::move(entry))) {
+        wake_writer();
+        std::this_thread::yield();
+    }
+    local.pushing.store(false, std::memory_order_release);
+
+    const auto queued = local.ring.size();
+#ifdef LIBLOG_STATS
+    if (counters) {
+        counters->note_queue_depth(queued);
+    }
+#endif
+    if (queued > local.ring.capacity() / 2) {
+        wake_writer();
+    }
+}
+
+bool lockfree_sink::try_consume(const logging::record_view& rec) {
+    auto& local = local_producer();
+    local.pushing.store(true);
+    if (stopped.load()) {
+        local.pushing.store(false, std::memory_order_release);
+        return target->try_consume(rec);
+    }
+
+    queued_record entry{queue_timestamp(), rec};
+    const auto pushed = local.ring.try_push(std::move(entry));
+    local.pushing.store(false, std::memory_order_release);
+
+    if (!pushed) {
+        wake_writer();
+    }
+    return pushed;
+}
+
+void lockfree_sink::set_counters(std::shared_ptr<sink_counters> new_counters) {
+    counters = std::move(new_counters);
+}
+
+void lockfree_sink::flush() {
+    if (stopped.load(std::memory_order_acquire)) {
+        target->flush();
+        return;
+    }
+
+    const auto ticket = flush_requested.fetch_add(1, std::memory_order_acq_rel) + 1;
+    std::unique_lock<std::mutex> lock(writer_mutex);
+    writer_wakeup.notify_one();
+    flush_done.wait(lock, [this, ticket]() {
+        return flush_completed.load(std::memory_order_acquire) >= ticket || stopped.load(std::memory_order_acquire);
+    });
+}
+
+void lockfree_sink::begin_crash_flush() noexcept {
+    // the writer polls, it notices the request without being notified
+    crash_flush_ticket.store(flush_requested.fetch_add(1, std::memory_order_acq_rel) + 1, std::memory_order_release);
+    wake_requested.store(true, std::memory_order_release);
+}
+
+bool lockfree_sink::crash_flushed() const noexcept {
+    return flush_completed.load(std::memory_order_acquire) >= crash_flush_ticket.load(std::memory_order_acquire) ||
+           stopped.load(std::memory_order_acquire);
+}
+
+void lockfree_sink::stop() {
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        if (stopping.exchange(true)) {
+            return;
+        }
+    }
+    writer_wakeup.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+lockfree_sink::producer& lockfree_sink::local_producer() {
+    thread_local thread_producers local;
+
+    for (auto& entry : local.entries) {
+        if (entry.first == id) {
+            return *entry.second;
+        }
+    }
+
+    // first record of this thread for this sink, forget about the rings of sinks that are gone meanwhile
+    local.entries.erase(std::remove_if(local.entries.begin(), local.entries.end(),
+                                       [](const auto& entry) { return entry.second->closed.load(); }),
+                        local.entries.end());
+
+    auto created = std::make_shared<producer>(queue_capacity);
+    {
+        std::lock_guard<std::mutex> lock(producers_mutex);
+        producers.push_back(created);
+    }
+    local.entries.emplace_back(id, created);
+    return *created;
+}
+
+void lockfree_sink::wake_writer() {
+    if (!wake_requested.exchange(true, std::memory_order_acq_rel)) {
+        writer_wakeup.notify_one();
+    }
+}
+
+void lockfree_sink::run() {
+    std::vector<std::shared_ptr<producer>> active;
+    auto poll_interval = std::chrono::duration_cast<std::chrono::microseconds>(min_poll_interval);
+
+    while (true) {
+        const auto stop_requested = stopping.load(std::memory_order_acquire);
+        const auto flush_ticket = flush_requested.load(std::memory_order_acquire);
+        wake_requested.store(false, std::memory_order_release);
+
+        {
+            std::lock_guard<std::mutex> lock(producers_mutex);
+            active = producers;
+        }
+
+        const auto written = drain(active);
+
+        {
+            // rings of exited threads can go once they are drained, the thread can't push anymore
+            std::lock_guard<std::mutex> lock(producers_mutex);
+            producers.erase(std::remove_if(producers.begin(), producers.end(),
+                                           [](const auto& p) {
+                                               return p->abandoned.load(std::memory_order_acquire) &&
+                                                      p->ring.front() == nullptr;
+                                           }),
+                            producers.end());
+        }
+
+        if (stop_requested) {
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock(writer_mutex);
+        if (flush_ticket > flush_completed.load(std::memory_order_relaxed)) {
+            target->flush();
+            flush_completed.store(flush_ticket, std::memory_order_release);
+            flush_done.notify_all();
+        }
+
+        if (written != 0) {
+            poll_interval = min_poll_interval;
+            continue;
+        }
+
+        writer_wakeup.wait_for(lock, poll_interval, [this, flush_ticket]() {
+            return stopping.load(std::memory_order_acquire) || wake_requested.load(std::memory_order_acquire) ||
+                   flush_requested.load(std::memory_order_acquire) != flush_ticket;
+        });
+        poll_interval = std::min(poll_interval * 2, std::chrono::duration_cast<std::chrono::microseconds>(
+                                                        max_poll_interval));
+    }
+
+    // anything logged from now on is written synchronously by the producers, the ones currently pushing are waited
+    // for (and drained, they might wait for room in their ring)
+    stopped.store(true);
+    {
+        std::lock_guard<std::mutex> lock(producers_mutex);
+        for (auto& p : producers) {
+            while (p->pushing.load()) {
+                drain({p});
+                std::this_thread::yield();
+            }
+        }
+        drain(producers);
+        for (auto& p : producers) {
+            p->closed.store(true, std::memory_order_release);
+        }
+    }
+    target->flush();
+
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    flush_completed.store(flush_requested.load(std::memory_order_acquire), std::memory_order_release);
+    flush_done.notify_all();
+}
+
+std::size_t lockfree_sink::drain(const std::vector<std::shared_ptr<producer>>& active) {
+    std::size_t written = 0;
+    while (true) {
+        producer* oldest = nullptr;
+        queued_record* oldest_entry = nullptr;
+        for (const auto& candidate : active) {
+            auto* entry = candidate->ring.front();
+            if (entry != nullptr && (oldest_entry == nullptr || entry->timestamp < oldest_entry->timestamp)) {
+                oldest = candidate.get();
+                oldest_entry = entry;
+            }
+        }
+
+        if (oldest == nullptr) {
+            return written;
+        }
+
+        try {
+            target->consume(oldest_entry->record);
+        } catch (...) {
+            // there is nobody to report to on the writer thread, the record is lost but the others are not
+        }
+        oldest->ring.pop();
+        ++written;
+    }
+}
+
+} // namespace Logging
+} // namespace Everest
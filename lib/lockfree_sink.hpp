@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef LOCKFREE_SINK_HPP
+#define LOCKFREE_SINK_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/expressions/filter.hpp>
+#include <boost/log/sinks/sink.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "crash_handler.hpp"
+#include "spsc_ring.hpp"
+#include "stats_counters.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief Asynchronous sink frontend with one bounded lock-free queue per producing thread
+///
+/// Producers only ever touch their own spsc_ring, a single writer thread merges all rings by the time the records
+/// were queued and hands them to the wrapped \p target sink. The only lock taken on behalf of a producer is the one
+/// registering its ring on the first record it logs into this sink. If a ring is full the producer yields until the
+/// writer made room. A crash handler asks the writer thread to write out the queued records like flush() does.
+class lockfree_sink : public logging::sinks::sink, public crash_flushable {
+public:
+    /// \param target sink receiving the records on the writer thread, usually an unfiltered synchronous_sink
+    /// \param filter applied on the producer side, must be safe to call concurrently
+    /// \param queue_capacity number of records every producing thread can have in flight
+    lockfree_sink(boost::shared_ptr<logging::sinks::sink> target, logging::filter filter,
+                  std::size_t queue_capacity);
+    ~lockfree_sink() override;
+
+    bool will_consume(const logging::attribute_value_set& attributes) override;
+    void consume(const logging::record_view& rec) override;
+    bool try_consume(const logging::record_view& rec) override;
+
+    /// \brief blocks until all records queued before the call have been written and the target is flushed
+    void flush() override;
+
+    /// \brief writes all queued records and stops the writer thread, later records are written synchronously
+    void stop();
+
+    /// \brief replaces the producer side filter without blocking producers
+    void set_filter(logging::filter new_filter);
+
+    /// \brief counters noting how full the ring of a producer got, must be set before the sink is added to the core
+    void set_counters(std::shared_ptr<sink_counters> new_counters);
+
+    void begin_crash_flush() noexcept override;
+    bool crash_flushed() const noexcept override;
+
+private:
+    struct queued_record {
+        std::int64_t timestamp{0};
+        logging::record_view record;
+    };
+
+    struct producer {
+        explicit producer(std::size_t capacity) : ring(capacity) {
+        }
+        spsc_ring<queued_record> ring;
+        std::atomic<bool> pushing{false};   ///< the producing thread is between checking stopped and pushing
+        std::atomic<bool> abandoned{false}; ///< the producing thread exited
+        std::atomic<bool> closed{false};    ///< the sink stopped, the ring won't be drained anymore
+    };
+
+    struct thread_producers;
+
+    producer& local_producer();
+    void wake_writer();
+    void run();
+    std::size_t drain(const std::vector<std::shared_ptr<producer>>& active);
+
+    const std::uint64_t id;
+    const boost::shared_ptr<logging::sinks::sink> target;
+    const std::size_t queue_capacity;
+
+    std::atomic<const logging::filter*> filter;
+    std::mutex filters_mutex;
+    /// every filter that was set, producers might still evaluate a replaced one
+    std::vector<std::unique_ptr<const logging::filter>> filters;
+
+    std::mutex producers_mutex;
+    std::vector<std::shared_ptr<producer>> producers;
+
+    std::mutex writer_mutex;
+    std::condition_variable writer_wakeup;
+    std::condition_variable flush_done;
+    std::atomic<bool> wake_requested{false};
+    std::atomic<std::uint64_t> flush_requested{0};
+    std::atomic<std::uint64_t> flush_completed{0};
+    std::atomic<std::uint64_t> crash_flush_ticket{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> stopped{false};
+    std::thread writer;
+
+    std::shared_ptr<sink_counters> counters;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // LOCKFREE_SINK_HPP
@@ -8,25 +8,45 @@
 #include <boost/log/attributes/current_process_id.hpp>
 #include <boost/log/attributes/current_process_name.hpp>
 #include <boost/log/attributes/current_thread_id.hpp>
+#include <boost/log/attributes/value_extraction.hpp>
+#include <boost/log/attributes/value_visitation.hpp>
 #include <boost/log/expressions.hpp>
 #include <boost/log/expressions/attr.hpp>
 #include <boost/log/expressions/formatter.hpp>
-#include <boost/log/expressions/formatters/c_decorator.hpp>
 #include <boost/log/expressions/formatters/format.hpp>
 #include <boost/log/expressions/formatters/stream.hpp>
 #include <boost/log/sources/record_ostream.hpp>
 #include <boost/log/trivial.hpp>
-#include <boost/log/utility/setup/common_attributes.hpp>
 #include <boost/log/utility/setup/filter_parser.hpp>
 #include <boost/log/utility/setup/formatter_parser.hpp>
 #include <boost/log/utility/setup/from_settings.hpp>
 #include <boost/log/utility/setup/from_stream.hpp>
 #include <boost/log/utility/setup/settings.hpp>
 #include <boost/log/utility/setup/settings_parser.hpp>
+#include <boost/mpl/vector.hpp>
+#include <atomic>
+#include <charconv>
+#include <cstring>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
 
+#include <everest/deferred_message.hpp>
 #include <everest/exceptions.hpp>
 #include <everest/logging.hpp>
+#include <everest/trace.hpp>
+
+#include "call_site_registry.hpp"
+#include "config_watcher.hpp"
+#include "escape.hpp"
+#include "flight_recorder.hpp"
+#include "formatters.hpp"
+#include "optional_attributes.hpp"
+#include "process_name.hpp"
+#include "sinks.hpp"
+#include "stats_counters.hpp"
+#include "time_stamp.hpp"
 
 // this will only be used while bootstrapping our logging (e.g. the logging settings aren't yet applied)
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
@@ -56,14 +76,27 @@ std::array<std::string, 6> severity_strings = {
     "CRIT", //
 };
 
-std::array<std::string, 6> severity_strings_colors = {
-    "", //
-    "", //
-    "", //
-    "", //
-    "", //
-    "", //
-};
+/// the severity strings, each one already between its color and the reset escape
+using severity_colors = std::array<std::string, 6>;
+
+severity_colors color_severity_strings(const severity_colors& colors) {
+    severity_colors colored;
+    for (std::size_t i = 0; i < colored.size(); ++i) {
+        colored[i] = colors[i] + severity_strings[i] + "\033[0m";
+    }
+    return colored;
+}
+
+const severity_colors no_severity_colors = color_severity_strings({});
+std::mutex severity_colors_mutex;
+/// every color set that was installed, formatting threads might still read a replaced one
+std::vector<std::unique_ptr<const severity_colors>> installed_severity_colors;
+std::atomic<const severity_colors*> current_severity_colors{&no_severity_colors};
+
+/// logging.ini given to init(), reloaded by reload()
+std::mutex logconf_mutex;
+std::string current_logconf;
+std::unique_ptr<config_watcher> logconf_watcher;
 
 std::string process_name_padding(const std::string& process_name) {
     const unsigned int process_name_padding_length = 15;
@@ -75,12 +108,12 @@ std::string process_name_padding(const std::string& process_name) {
     return padded_process_name;
 }
 
-attrs::mutable_constant<std::string> current_process_name(process_name_padding(logging::aux::get_process_name()));
+process_name_attribute current_process_name(process_name_padding(logging::aux::get_process_name()));
 
 // The operator puts a human-friendly representation of the severity level to the stream
 std::ostream& operator<<(std::ostream& strm, severity_level level) {
     if (static_cast<std::size_t>(level) < severity_strings.size()) {
-        strm << severity_strings_colors.at(level) << severity_strings.at(level) << "\033[0m";
+        strm << (*current_severity_colors.load(std::memory_order_acquire))[level];
     } else {
         strm << static_cast<int>(level);
     }
@@ -88,6 +121,15 @@ std::ostream& operator<<(std::ostream& strm, severity_level level) {
     return strm;
 }
 
+void write_severity(severity_level level, logging::formatting_ostream& strm) {
+    if (static_cast<std::size_t>(level) < severity_strings.size()) {
+        const auto& colored = (*current_severity_colors.load(std::memory_order_acquire))[level];
+        strm.write(colored.data(), static_cast<std::streamsize>(colored.size()));
+    } else {
+        strm << static_cast<int>(level);
+    }
+}
+
 // The operator parses the severity level from the stream
 std::istream& operator>>(std::istream& strm, severity_level& level) {
     if (strm.good()) {
@@ -107,29 +149,245 @@ std::istream& operator>>(std::istream& strm, severity_level& level) {
     return strm;
 }
 
-/// Custom formatter for escaped messages.
+void format_message(logging::record_view const& rec, logging::formatting_ostream& strm) {
+    using message_types = boost::mpl::vector<std::string, deferred_message>;
+    static const logging::attribute_name message_name("Message");
+    logging::visit<message_types>(message_name, rec, [&strm](const auto& message) { strm << message; });
+}
+
+/// Custom formatter for the message, resolving deferred messages.
 ///
-/// Not really clear but just a wrapper around the c_decor formatter.
+/// Configured as %Message%, which is rewritten to %FormattedMessage% by prepare_sink_settings(). Formatters parsed
+/// elsewhere keep Boost.Log's own %Message%, it gets the text of deferred messages from detail::make_message_value().
+struct message_formatter {
+    void operator()(logging::record_view const& rec, logging::formatting_ostream& strm) const {
+        format_message(rec, strm);
+    }
+};
+
+/// The factory for the FormattedMessage formatter.
+struct message_formatter_factory : public logging::formatter_factory<char> {
+    formatter_type create_formatter(logging::attribute_name const& attr_name, args_map const& args) {
+        return formatter_type(message_formatter());
+    }
+};
+
+namespace {
+/// writes the message of \p rec with \p escape, deferred messages are formatted into a buffer of the thread first
+void format_message_escaped(logging::record_view const& rec, logging::formatting_ostream& strm,
+                            void (*escape)(const std::string&, logging::formatting_ostream&)) {
+    static const logging::attribute_name message_name("Message");
+    if (const auto text = logging::extract<std::string>(message_name, rec)) {
+        escape(text.get(), strm);
+        return;
+    }
+
+    static thread_local std::string message;
+    static thread_local logging::formatting_ostream message_strm(message);
+    message.clear();
+    format_message(rec, message_strm);
+    message_strm.flush();
+    escape(message, strm);
+}
+} // namespace
+
+void format_escaped_message(logging::record_view const& rec, logging::formatting_ostream& strm) {
+    format_message_escaped(rec, strm, &write_escaped);
+}
+
+void format_json_escaped_message(logging::record_view const& rec, logging::formatting_ostream& strm) {
+    format_message_escaped(rec, strm, &write_json_escaped);
+}
+
+/// Custom formatter for escaped messages, escaping like Boost.Log's c_decor.
 struct escaped_message_formatter {
-    explicit escaped_message_formatter(logging::attribute_name const& name) :
-        f_{expr::stream << expr::c_decor[expr::stream << expr::smessage]} {
+    void operator()(logging::record_view const& rec, logging::formatting_ostream& strm) const {
+        format_escaped_message(rec, strm);
     }
+};
+
+/// The factory for the EscMessage formatter.
+struct escaped_message_formatter_factory : public logging::formatter_factory<char> {
+    formatter_type create_formatter(logging::attribute_name const& attr_name, args_map const& args) {
+        return formatter_type(escaped_message_formatter());
+    }
+};
+
+/// Custom formatter for messages escaped as the content of a JSON string.
+struct json_escaped_message_formatter {
     void operator()(logging::record_view const& rec, logging::formatting_ostream& strm) const {
-        f_(rec, strm);
+        format_json_escaped_message(rec, strm);
+    }
+};
+
+/// The factory for the JsonEscapedMessage formatter.
+struct json_escaped_message_formatter_factory : public logging::formatter_factory<char> {
+    formatter_type create_formatter(logging::attribute_name const& attr_name, args_map const& args) {
+        return formatter_type(json_escaped_message_formatter());
+    }
+};
+
+std::uint32_t call_site::id() const {
+    static std::atomic<std::uint32_t> next_site_id{1};
+
+    auto id = site_id.load(std::memory_order_acquire);
+    if (id == 0) {
+        const auto new_id = next_site_id.fetch_add(1, std::memory_order_relaxed);
+        // a concurrent first use might have won, in that case its id is kept
+        id = site_id.compare_exchange_strong(id, new_id, std::memory_order_acq_rel) ? new_id : id;
+    }
+    return id;
+}
+
+namespace detail {
+const logging::attribute_name& call_site_attribute_name() {
+    static const logging::attribute_name name("CallSite");
+    return name;
+}
+} // namespace detail
+
+void format_call_site(logging::record_view const& rec, logging::formatting_ostream& strm, call_site_field field,
+                      logging::attribute_name const& name) {
+    using fallback_types = boost::mpl::vector<std::string, const char*, int, unsigned int>;
+
+    const auto site = logging::extract<const call_site*>(detail::call_site_attribute_name(), rec);
+    if (!site) {
+        logging::visit<fallback_types>(name, rec, [&strm](const auto& value) { strm << value; });
+        return;
+    }
+
+    const auto& location = *site.get();
+    switch (field) {
+    case call_site_field::file:
+        if ((location.shown & call_site::show_location) != 0) {
+            strm.write(location.file, static_cast<std::streamsize>(std::strlen(location.file)));
+        }
+        break;
+    case call_site_field::line:
+        if ((location.shown & call_site::show_location) != 0) {
+            char digits[16];
+            const auto end = std::to_chars(digits, digits + sizeof(digits), location.line).ptr;
+            strm.write(digits, end - digits);
+        }
+        break;
+    case call_site_field::function:
+        if ((location.shown & call_site::show_function) != 0) {
+            strm.write(location.function, static_cast<std::streamsize>(std::strlen(location.function)));
+        }
+        break;
+    }
+}
+
+/// Custom formatter for the %file%, %line% and %function% placeholders.
+struct call_site_formatter {
+    call_site_formatter(logging::attribute_name const& name, call_site_field selected) :
+        name_(name), field_(selected) {
+    }
+
+    void operator()(logging::record_view const& rec, logging::formatting_ostream& strm) const {
+        format_call_site(rec, strm, field_, name_);
     }
 
 private:
-    /// @brief The formatter itself.
-    boost::log::formatter f_;
+    logging::attribute_name name_;
+    call_site_field field_;
 };
 
-/// The factory for the EscMessage formatter.
-struct escaped_message_formatter_factory : public logging::formatter_factory<char> {
+/// The factory for the call site placeholders.
+struct call_site_formatter_factory : public logging::formatter_factory<char> {
+    explicit call_site_formatter_factory(call_site_field selected) : field_(selected) {
+    }
+
     formatter_type create_formatter(logging::attribute_name const& attr_name, args_map const& args) {
-        return formatter_type(escaped_message_formatter(attr_name));
+        return formatter_type(call_site_formatter(attr_name, field_));
+    }
+
+private:
+    call_site_field field_;
+};
+
+void register_formatter_factories() {
+    logging::register_formatter_factory("EscapedMessage", boost::make_shared<escaped_message_formatter_factory>());
+    logging::register_formatter_factory("JsonEscapedMessage",
+                                        boost::make_shared<json_escaped_message_formatter_factory>());
+    logging::register_formatter_factory("FormattedMessage", boost::make_shared<message_formatter_factory>());
+    logging::register_formatter_factory(
+        "file", boost::make_shared<call_site_formatter_factory>(call_site_field::file));
+    logging::register_formatter_factory(
+        "line", boost::make_shared<call_site_formatter_factory>(call_site_field::line));
+    logging::register_formatter_factory(
+        "function", boost::make_shared<call_site_formatter_factory>(call_site_field::function));
+    logging::register_simple_filter_factory<severity_level>("Severity");
+    flight_recorder::register_marker_filter();
+    register_time_stamp_formatter_factory();
+    logging::register_simple_formatter_factory<severity_level, char>("Severity");
+}
+
+void set_severity_colors(const logging::settings_section& sink) {
+    severity_colors colors;
+    colors[severity_level::verbose] = sink["SeverityStringColorTrace"].get<std::string>().get_value_or("");
+    colors[severity_level::debug] = sink["SeverityStringColorDebug"].get<std::string>().get_value_or("");
+    colors[severity_level::info] = sink["SeverityStringColorInfo"].get<std::string>().get_value_or("");
+    colors[severity_level::warning] = sink["SeverityStringColorWarning"].get<std::string>().get_value_or("");
+    colors[severity_level::error] = sink["SeverityStringColorError"].get<std::string>().get_value_or("");
+    colors[severity_level::critical] = sink["SeverityStringColorCritical"].get<std::string>().get_value_or("");
+
+    auto colored = std::make_unique<severity_colors>(color_severity_strings(colors));
+
+    std::lock_guard<std::mutex> lock(severity_colors_mutex);
+    if (*colored == *current_severity_colors.load(std::memory_order_relaxed)) {
+        return;
     }
+    installed_severity_colors.push_back(std::move(colored));
+    current_severity_colors.store(installed_severity_colors.back().get(), std::memory_order_release);
+}
+
+namespace {
+/// The LineID attribute, numbering records from 1 like the counter of Boost.Log, its values come from the record pool
+class line_id_counter : public logging::attribute {
+public:
+    line_id_counter() : logging::attribute(new impl()) {
+    }
+
+private:
+    class impl : public logging::attribute::impl {
+    public:
+        logging::attribute_value get_value() override {
+            return detail::make_pooled_value(next.fetch_add(1, std::memory_order_relaxed));
+        }
+
+    private:
+        std::atomic<unsigned int> next{1};
+    };
 };
 
+/// serializes reload() calls, including the ones of the watcher
+std::mutex reload_mutex;
+
+bool open_logconf(const std::string& logconf, std::ifstream& logging_config) {
+    logging_config.open(fs::path(logconf).c_str());
+    return logging_config.is_open();
+}
+
+bool watch_enabled(const logging::settings& settings) {
+    const auto watch = settings["Reload.Watch"].get();
+    return watch && setting_to_bool("Reload.Watch", watch.get());
+}
+
+bool trace_preload_enabled(const logging::settings& settings) {
+    const auto preload = settings["Trace.Preload"].get();
+    return preload && setting_to_bool("Trace.Preload", preload.get());
+}
+
+void reload_from_watcher() {
+    try {
+        reload();
+    } catch (const EverestConfigError& e) {
+        EVLOG_error << "Keeping the current logging settings: " << e.what();
+    }
+}
+} // namespace
+
 void init(const std::string& logconf) {
     init(logconf, "");
 }
@@ -137,11 +395,17 @@ void init(const std::string& logconf) {
 void init(const std::string& logconf, std::string process_name) {
     BOOST_LOG_FUNCTION();
 
-    // First thing - register the custom formatter for EscMessage
-    logging::register_formatter_factory("EscapedMessage", boost::make_shared<escaped_message_formatter_factory>());
+    // First thing - register the custom formatters
+    register_formatter_factories();
 
-    // add useful attributes
-    logging::add_common_attributes();
+    // add useful attributes, the TimeStamp of Boost.Log is replaced by the cheaper one of liblog, ThreadID, ProcessID
+    // and Scope are only added once the settings show they are needed
+    logging::core::get()->add_global_attribute("LineID", line_id_counter());
+    auto time_stamp_attribute = logging::core::get()->add_global_attribute("TimeStamp", time_stamp_clock());
+    if (!time_stamp_attribute.second) {
+        logging::core::get()->remove_global_attribute(time_stamp_attribute.first);
+        logging::core::get()->add_global_attribute("TimeStamp", time_stamp_clock());
+    }
 
     std::string padded_process_name;
 
@@ -153,42 +417,120 @@ void init(const std::string& logconf, std::string process_name) {
     if (!padded_process_name.empty()) {
         current_process_name.set(padded_process_name);
     }
-    logging::core::get()->add_global_attribute("Scope", attrs::named_scope());
 
-    // Before initializing the library from settings, we need to register any custom filter and formatter factories
-    logging::register_simple_filter_factory<severity_level>("Severity");
-    logging::register_simple_formatter_factory<severity_level, char>("Severity");
+    // Before initializing the library from settings, we need to register the sink factories
+    register_sink_factories();
 
     // open logging.ini config file located at our base_dir and use it to configure boost::log logging (filters and
     // format)
-    fs::path logging_path = fs::path(logconf);
-    std::ifstream logging_config(logging_path.c_str());
-    if (!logging_config.is_open()) {
+    std::ifstream logging_config;
+    if (!open_logconf(logconf, logging_config)) {
         EVEREST_INTERNAL_LOG_AND_THROW(EverestConfigError(std::string("Could not open logging config file at ") +
-                                                          std::string(fs::absolute(logging_path).c_str())));
+                                                          std::string(fs::absolute(fs::path(logconf)).c_str())));
     }
 
     auto settings = logging::parse_settings(logging_config);
 
-    auto sink = settings["Sinks.Console"].get_section();
-
-    severity_strings_colors[severity_level::verbose] =
-        sink["SeverityStringColorTrace"].get<std::string>().get_value_or("");
-    severity_strings_colors[severity_level::debug] =
-        sink["SeverityStringColorDebug"].get<std::string>().get_value_or("");
-    severity_strings_colors[severity_level::info] = sink["SeverityStringColorInfo"].get<std::string>().get_value_or("");
-    severity_strings_colors[severity_level::warning] =
-        sink["SeverityStringColorWarning"].get<std::string>().get_value_or("");
-    severity_strings_colors[severity_level::error] =
-        sink["SeverityStringColorError"].get<std::string>().get_value_or("");
-    severity_strings_colors[severity_level::critical] =
-        sink["SeverityStringColorCritical"].get<std::string>().get_value_or("");
+    optional_attributes::from_settings(settings).install();
+    set_severity_colors(settings["Sinks.Console"].get_section());
+    set_time_stamp_precision(time_stamp_precision_from_settings(settings));
 
+    call_site_registry::instance().set_rules(call_site_rules::from_settings(settings));
+    prepare_sink_settings(settings);
+    configured_sinks::instance().setup(settings);
     logging::init_from_settings(settings);
+    flight_recorder::setup(settings);
+    stats_reporter::setup(settings);
+    if (trace_preload_enabled(settings)) {
+        preload_trace();
+    }
+
+    // the previous watcher is stopped outside of the lock, it might be reloading right now
+    std::unique_ptr<config_watcher> previous_watcher;
+    {
+        std::lock_guard<std::mutex> lock(logconf_mutex);
+        current_logconf = logconf;
+        previous_watcher = std::move(logconf_watcher);
+    }
+    previous_watcher.reset();
+    if (watch_enabled(settings)) {
+        auto watcher = std::make_unique<config_watcher>(logconf, &reload_from_watcher);
+        std::lock_guard<std::mutex> lock(logconf_mutex);
+        logconf_watcher = std::move(watcher);
+    }
 
     EVLOG_debug << "Logger initialized (using " << logconf << ")...";
 }
 
+void reload() {
+    std::lock_guard<std::mutex> reload_lock(reload_mutex);
+
+    std::string logconf;
+    {
+        std::lock_guard<std::mutex> lock(logconf_mutex);
+        logconf = current_logconf;
+    }
+    if (logconf.empty()) {
+        throw EverestConfigError("Logging was not initialized from a logging config file, there's nothing to reload");
+    }
+
+    std::ifstream logging_config;
+    if (!open_logconf(logconf, logging_config)) {
+        throw EverestConfigError("Could not open logging config file at " + logconf);
+    }
+
+    // everything that can fail happens before the first setting is applied, the sinks are only parsed
+    logging::settings settings;
+    call_site_rules rules;
+    auto precision = time_stamp_precision::microseconds;
+    optional_attributes attributes;
+    logging::filter core_filter;
+    boost::shared_ptr<flight_recorder> recorder;
+    bool logging_enabled = true;
+    std::function<void()> apply_sinks;
+    try {
+        settings = logging::parse_settings(logging_config);
+        rules = call_site_rules::from_settings(settings);
+        precision = time_stamp_precision_from_settings(settings);
+        attributes = optional_attributes::from_settings(settings);
+        if (auto filter = settings["Core.Filter"].get()) {
+            core_filter = logging::parse_filter(filter.get());
+        }
+        if (auto disable_logging = settings["Core.DisableLogging"].get()) {
+            logging_enabled = !setting_to_bool("DisableLogging", disable_logging.get());
+        }
+        prepare_sink_settings(settings);
+        recorder = flight_recorder::from_settings(settings);
+        apply_sinks = configured_sinks::instance().prepare_reload(settings);
+    } catch (const EverestConfigError&) {
+        throw;
+    } catch (const std::exception& e) {
+        throw EverestConfigError("Invalid logging config file " + logconf + ": " + e.what());
+    }
+
+    // creating new sinks might fail, e.g. if a file can't be opened, nothing is applied then
+    try {
+        apply_sinks();
+    } catch (const EverestConfigError&) {
+        throw;
+    } catch (const std::exception& e) {
+        throw EverestConfigError("Could not create the sinks of logging config file " + logconf + ": " + e.what());
+    }
+    attributes.install();
+    set_severity_colors(settings["Sinks.Console"].get_section());
+    set_time_stamp_precision(precision);
+    call_site_registry::instance().set_rules(std::move(rules));
+    auto core = logging::core::get();
+    if (!recorder) {
+        core->set_filter(core_filter);
+    }
+    // a recorder replaces the core filter by its own
+    flight_recorder::install(recorder);
+    core->set_logging_enabled(logging_enabled);
+
+    EVLOG_debug << "Logger reloaded (using " << logconf << ")...";
+}
+
 void update_process_name(std::string process_name) {
     if (!process_name.empty()) {
         std::string padded_process_name;
@@ -0,0 +1,286 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "mapped_file_sink.hpp"
+
+#ifdef LIBLOG_USE_BOOST_FILESYSTEM
+#include <boost/filesystem.hpp>
+#else
+#include <filesystem>
+#endif
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <everest/exceptions.hpp>
+
+#ifdef LIBLOG_USE_BOOST_FILESYSTEM
+namespace fs = boost::filesystem;
+#else
+namespace fs = std::filesystem;
+#endif
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+/// the index of \p name if it names a segment of \p file_name, and the extension a compressed segment has
+bool parse_segment_name(const std::string& name, const std::string& file_name, std::uint64_t& index,
+                        std::string& extension) {
+    const auto prefix = file_name + ".";
+    if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    const auto digits_end = std::find_if(name.begin() + static_cast<std::ptrdiff_t>(prefix.size()), name.end(),
+                                         [](unsigned char c) { return std::isdigit(c) == 0; });
+    extension.assign(digits_end, name.end());
+    if (digits_end == name.begin() + static_cast<std::ptrdiff_t>(prefix.size()) ||
+        (!extension.empty() && extension.front() != '.')) {
+        return false;
+    }
+    index = std::stoull(std::string(name.begin() + static_cast<std::ptrdiff_t>(prefix.size()), digits_end));
+    return true;
+}
+
+bool has_suffix(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/// the size of the content of a segment a crashed process didn't truncate, its unwritten rest is zero
+std::uint64_t content_size(int fd, std::uint64_t size) {
+    char chunk[4096];
+    while (size > 0) {
+        const auto length = static_cast<std::size_t>(std::min<std::uint64_t>(size, sizeof(chunk)));
+        const auto offset = size - length;
+        if (::pread(fd, chunk, length, static_cast<off_t>(offset)) != static_cast<ssize_t>(length)) {
+            return size;
+        }
+        for (auto position = length; position > 0; --position) {
+            if (chunk[position - 1] != '\0') {
+                return offset + position;
+            }
+        }
+        size = offset;
+    }
+    return 0;
+}
+} // namespace
+
+mapped_file_backend::mapped_file_backend(const mapped_file_settings& settings,
+                                         logging::sinks::auto_newline_mode auto_newline) :
+    settings(settings), auto_newline(auto_newline) {
+    if (settings.codec != nullptr) {
+        compressor = std::make_unique<segment_compressor>(*settings.codec, settings.compression_threads);
+    }
+
+    const fs::path file_path(settings.file_name);
+    const auto directory = file_path.has_parent_path() ? file_path.parent_path() : fs::path(".");
+    const auto file_name = file_path.filename().string();
+    if (fs::is_directory(directory)) {
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            std::uint64_t index = 0;
+            std::string extension;
+            if (!parse_segment_name(entry.path().filename().string(), file_name, index, extension)) {
+                continue;
+            }
+            const auto name = segment_name(settings.file_name, index) + extension;
+            if (has_suffix(extension, ".tmp")) {
+                // compression of a previous process that didn't complete
+                ::unlink(name.c_str());
+                continue;
+            }
+            completed.push_back({index, name, static_cast<std::uint64_t>(fs::file_size(entry.path())), false});
+        }
+    }
+    std::sort(completed.begin(), completed.end(),
+              [](const segment& a, const segment& b) { return a.index < b.index; });
+
+    if (!completed.empty()) {
+        next_index = completed.back().index + 1;
+        // the newest segment was still being written if the previous process crashed
+        const auto newest = segment_name(settings.file_name, completed.back().index);
+        const auto newest_fd = completed.back().name == newest ? ::open(newest.c_str(), O_RDWR | O_CLOEXEC) : -1;
+        if (newest_fd >= 0) {
+            const auto size = content_size(newest_fd, completed.back().size);
+            if (size != completed.back().size && ::ftruncate(newest_fd, static_cast<off_t>(size)) == 0) {
+                completed.back().size = size;
+            }
+            ::close(newest_fd);
+        }
+    }
+    if (compressor) {
+        for (auto& kept : completed) {
+            if (kept.name == segment_name(settings.file_name, kept.index)) {
+                kept.compressing = true;
+                compressor->compress(kept.name);
+            }
+        }
+    }
+
+    open_segment();
+    apply_retention();
+}
+
+mapped_file_backend::~mapped_file_backend() {
+    if (fd >= 0) {
+        close_segment();
+    }
+}
+
+std::string mapped_file_backend::segment_name(const std::string& file_name, std::uint64_t index) {
+    return file_name + "." + std::to_string(index);
+}
+
+void mapped_file_backend::consume(const logging::record_view&, const std::string& formatted) {
+    const bool add_newline =
+        auto_newline == logging::sinks::always_insert ||
+        (auto_newline == logging::sinks::insert_if_missing && (formatted.empty() || formatted.back() != '\n'));
+    const auto size = formatted.size() + (add_newline ? 1 : 0);
+
+    if (fd < 0 || (used > 0 && size > settings.segment_size - used)) {
+        try {
+            if (fd >= 0) {
+                close_segment();
+            }
+            open_segment();
+            apply_retention();
+        } catch (const EverestConfigError&) {
+            // the records are dropped until a segment can be created again, e.g. once there is space again
+            return;
+        }
+    }
+
+    write(formatted.data(), formatted.size());
+    if (add_newline) {
+        write("\n", 1);
+    }
+}
+
+void mapped_file_backend::flush() {
+    if (mapping != nullptr) {
+        ::msync(mapping, used, MS_ASYNC);
+    }
+}
+
+void mapped_file_backend::open_segment() {
+    const auto name = segment_name(settings.file_name, next_index);
+    fd = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw EverestConfigError("Could not create log segment " + name + ": " + std::strerror(errno));
+    }
+    ++next_index;
+
+    const auto size = static_cast<off_t>(settings.segment_size);
+#ifdef __linux__
+    auto error = ::fallocate(fd, 0, 0, size) == 0 ? 0 : errno;
+#else
+    auto error = ::posix_fallocate(fd, 0, size);
+#endif
+    const bool preallocated = error == 0;
+    // a sparse mapping raises SIGBUS when the disk is full, file systems without preallocation are written instead
+    if (error == EOPNOTSUPP || error == ENOSYS) {
+        error = 0;
+    }
+    void* mapped = nullptr;
+    if (preallocated) {
+        mapped = ::mmap(nullptr, settings.segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            error = errno;
+        }
+    }
+    if (error != 0) {
+        ::close(fd);
+        ::unlink(name.c_str());
+        fd = -1;
+        throw EverestConfigError("Could not allocate log segment " + name + ": " + std::strerror(error));
+    }
+    mapping = static_cast<char*>(mapped);
+    used = 0;
+}
+
+void mapped_file_backend::close_segment() {
+    if (mapping != nullptr) {
+        ::munmap(mapping, settings.segment_size);
+        mapping = nullptr;
+    }
+    // readers see the records only, without the unwritten rest
+    if (::ftruncate(fd, static_cast<off_t>(used)) != 0) {
+        used = settings.segment_size;
+    }
+    ::close(fd);
+    fd = -1;
+    const auto name = segment_name(settings.file_name, next_index - 1);
+    completed.push_back({next_index - 1, name, used, compressor != nullptr});
+    if (compressor) {
+        compressor->compress(name);
+    }
+}
+
+void mapped_file_backend::write(const char* data, std::size_t size) {
+    const auto length = std::min(size, settings.segment_size - used);
+    if (mapping != nullptr) {
+        std::memcpy(mapping + used, data, length);
+        used += length;
+        return;
+    }
+    // the segment couldn't be preallocated, what doesn't fit on the disk anymore is dropped
+    for (std::size_t written = 0; written < length;) {
+        const auto result = ::write(fd, data + written, length - written);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return;
+        }
+        written += static_cast<std::size_t>(result);
+        used += static_cast<std::size_t>(result);
+    }
+}
+
+void mapped_file_backend::update_compressed() {
+    for (auto& kept : completed) {
+        struct stat status {};
+        if (!kept.compressing || ::stat(kept.name.c_str(), &status) == 0) {
+            continue;
+        }
+        // the plain segment is only removed once the compressed one is complete
+        kept.name = compressor->compressed_name(kept.name);
+        kept.compressing = false;
+        if (::stat(kept.name.c_str(), &status) == 0) {
+            kept.size = static_cast<std::uint64_t>(status.st_size);
+        }
+    }
+}
+
+void mapped_file_backend::apply_retention() {
+    if (compressor) {
+        update_compressed();
+    }
+    std::uint64_t total = settings.segment_size;
+    for (const auto& kept : completed) {
+        total += kept.size;
+    }
+    auto count = completed.size() + 1;
+
+    auto removed = completed.begin();
+    while (removed != completed.end() && ((settings.max_files != 0 && count > settings.max_files) ||
+                                          (settings.max_total_size != 0 && total > settings.max_total_size))) {
+        if (removed->compressing) {
+            compressor->discard(removed->name);
+            ::unlink(compressor->compressed_name(removed->name).c_str());
+        }
+        ::unlink(removed->name.c_str());
+        total -= removed->size;
+        --count;
+        ++removed;
+    }
+    completed.erase(completed.begin(), removed);
+}
+
+} // namespace Logging
+} // namespace Everest
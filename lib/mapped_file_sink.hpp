@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef MAPPED_FILE_SINK_HPP
+#define MAPPED_FILE_SINK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/log/sinks/auto_newline_mode.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+
+#include "segment_compressor.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief Where a mapped_file_backend writes and how many of its segments it keeps
+struct mapped_file_settings {
+    /// \brief segments are named "<file_name>.<index>", the index keeps counting across restarts
+    std::string file_name;
+    /// \brief bytes preallocated for every segment
+    std::size_t segment_size{16 * 1024 * 1024};
+    /// \brief segments kept at most including the one being written, 0 keeps all
+    std::size_t max_files{0};
+    /// \brief bytes the segments may take at most including the one being written, 0 doesn't limit them
+    std::uint64_t max_total_size{0};
+    /// \brief compresses the complete segments in the background if set
+    const compression_codec* codec{nullptr};
+    /// \brief segments compressed at the same time at most
+    std::size_t compression_threads{1};
+};
+
+///
+/// \brief Sink backend copying formatted records into memory mapped, preallocated file segments
+///
+/// A segment is allocated with fallocate() once and mapped, records are copied into the mapping, so neither a record
+/// nor the file growing cost a system call or a metadata update. When a record doesn't fit anymore, the segment is
+/// truncated to its content and the next one is started. The oldest segments are removed to stay within max_files and
+/// max_total_size. Records larger than a segment are cut off at its size.
+///
+/// With a codec, complete segments are handed to a segment_compressor and replaced by "<file_name>.<index><extension>",
+/// the retention limits then apply to the compressed sizes. Segments that a previous process left uncompressed are
+/// queued on startup.
+///
+/// Until the segment is complete, its unwritten rest reads as zero bytes. The mapping is shared, so the records survive
+/// a crash of the process, flush() only schedules the write back.
+///
+/// Segments on file systems that can't preallocate them aren't mapped, a sparse mapping would raise SIGBUS once the
+/// disk is full. Their records are written with write(), records that don't fit on the disk anymore are dropped.
+class mapped_file_backend
+    : public logging::sinks::basic_formatted_sink_backend<
+          char, logging::sinks::combine_requirements<logging::sinks::synchronized_feeding,
+                                                     logging::sinks::flushing>::type> {
+public:
+    /// \brief opens the segment following the existing ones, throws EverestConfigError if it can't be created
+    explicit mapped_file_backend(const mapped_file_settings& settings,
+                                 logging::sinks::auto_newline_mode auto_newline = logging::sinks::insert_if_missing);
+    ~mapped_file_backend();
+    mapped_file_backend(const mapped_file_backend&) = delete;
+    mapped_file_backend& operator=(const mapped_file_backend&) = delete;
+
+    void consume(const logging::record_view& rec, const std::string& formatted);
+    void flush();
+
+    /// \brief name of the segment \p index of \p file_name
+    static std::string segment_name(const std::string& file_name, std::uint64_t index);
+
+private:
+    struct segment {
+        std::uint64_t index;
+        /// the file on disk, the plain segment until it's compressed
+        std::string name;
+        std::uint64_t size;
+        bool compressing;
+    };
+
+    void open_segment();
+    void close_segment();
+    void write(const char* data, std::size_t size);
+    /// picks up the segments the compressor completed
+    void update_compressed();
+    /// removes the oldest segments until the limits are met again
+    void apply_retention();
+
+    const mapped_file_settings settings;
+    const logging::sinks::auto_newline_mode auto_newline;
+
+    /// the completed segments on disk, oldest first
+    std::vector<segment> completed;
+    std::uint64_t next_index{0};
+    /// the segment being written, -1 if none could be created
+    int fd{-1};
+    /// the mapping of the segment, nullptr if it couldn't be preallocated
+    char* mapping{nullptr};
+    std::size_t used{0};
+    std::unique_ptr<segment_compressor> compressor;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // MAPPED_FILE_SINK_HPP
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "optional_attributes.hpp"
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/log/attributes/attribute_value_impl.hpp>
+#include <boost/log/attributes/current_process_id.hpp>
+#include <boost/log/attributes/current_thread_id.hpp>
+#include <boost/log/attributes/named_scope.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/utility/type_dispatch/type_dispatcher.hpp>
+
+#include <everest/exceptions.hpp>
+#include <everest/record_stream.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace attrs = logging::attributes;
+
+namespace {
+const logging::attribute_name thread_id_name("ThreadID");
+const logging::attribute_name process_id_name("ProcessID");
+const logging::attribute_name scope_name("Scope");
+
+/// \p expression refers to the attribute \p name as %name% or %name(...)%
+bool refers_to(const std::string& expression, const std::string& name) {
+    const auto placeholder = "%" + name;
+    for (auto position = expression.find(placeholder); position != std::string::npos;
+         position = expression.find(placeholder, position + 1)) {
+        const auto end = position + placeholder.size();
+        if (end < expression.size() && (expression[end] == '%' || expression[end] == '(')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void select_referenced(optional_attributes& selected, const std::string& expression) {
+    selected.thread_id = selected.thread_id || refers_to(expression, thread_id_name.string());
+    selected.process_id = selected.process_id || refers_to(expression, process_id_name.string());
+    selected.scope = selected.scope || refers_to(expression, scope_name.string());
+}
+
+void select_always(optional_attributes& selected, const std::string& names) {
+    std::size_t begin = 0;
+    while (begin <= names.size()) {
+        const auto end = std::min(names.find(',', begin), names.size());
+        const auto name = boost::algorithm::trim_copy(names.substr(begin, end - begin));
+        if (name == thread_id_name.string()) {
+            selected.thread_id = true;
+        } else if (name == process_id_name.string()) {
+            selected.process_id = true;
+        } else if (name == scope_name.string()) {
+            selected.scope = true;
+        } else if (!name.empty()) {
+            throw EverestConfigError("Unknown attribute \"" + name +
+                                     "\" in setting Always, expected ThreadID, ProcessID or Scope");
+        }
+        begin = end + 1;
+    }
+}
+
+void select_global_attribute(logging::attribute_set& attributes, const logging::attribute_name& name, bool selected,
+                             const logging::attribute& attribute) {
+    if (!selected) {
+        attributes.erase(name);
+    } else if (attributes.find(name) == attributes.end()) {
+        attributes.insert(name, attribute);
+    }
+}
+
+/// ThreadID, every thread keeps the value of its id.
+class cached_thread_id : public logging::attribute {
+public:
+    cached_thread_id() : logging::attribute(new impl()) {
+    }
+
+private:
+    class impl : public logging::attribute::impl {
+    public:
+        logging::attribute_value get_value() override {
+            thread_local const auto value = attrs::make_attribute_value(logging::aux::this_thread::get_id());
+            return value;
+        }
+    };
+};
+
+/// ProcessID, read for every record like the one of Boost.Log since a fork() changes it.
+class pooled_process_id : public logging::attribute {
+public:
+    pooled_process_id() : logging::attribute(new impl()) {
+    }
+
+private:
+    class impl : public logging::attribute::impl {
+    public:
+        logging::attribute_value get_value() override {
+            return detail::make_pooled_value(logging::aux::this_process::get_id());
+        }
+    };
+};
+
+/// Scope value referring to the scope list of the thread, valid as long as the record isn't detached from it.
+class lazy_scope_value : public logging::attribute_value::impl {
+public:
+    explicit lazy_scope_value(const attrs::named_scope_list& scopes) : scopes(scopes) {
+    }
+
+    static void* operator new(std::size_t size) {
+        return detail::allocate_record_block(size);
+    }
+
+    static void operator delete(void* block, std::size_t size) noexcept {
+        detail::free_record_block(block, size);
+    }
+
+    bool dispatch(logging::type_dispatcher& dispatcher) override {
+        if (auto callback = dispatcher.get_callback<attrs::named_scope_list>()) {
+            callback(scopes);
+            return true;
+        }
+        return false;
+    }
+
+    boost::intrusive_ptr<logging::attribute_value::impl> detach_from_thread() override {
+        return new detail::pooled_attribute_value<attrs::named_scope_list>(scopes);
+    }
+
+    boost::typeindex::type_index get_type() const override {
+        return boost::typeindex::type_id<attrs::named_scope_list>();
+    }
+
+private:
+    const attrs::named_scope_list& scopes;
+};
+} // namespace
+
+optional_attributes optional_attributes::from_settings(const logging::settings& settings) {
+    optional_attributes selected;
+    if (auto core_filter = settings["Core.Filter"].get()) {
+        select_referenced(selected, core_filter.get());
+    }
+    if (auto always = settings["Attributes.Always"].get()) {
+        select_always(selected, always.get());
+    }
+
+    const auto sink_sections = settings.property_tree().get_child_optional("Sinks");
+    if (!sink_sections) {
+        return selected;
+    }
+    for (const auto& sink_section : sink_sections.get()) {
+        for (const auto* expression_setting : {"Format", "Filter"}) {
+            if (auto expression = sink_section.second.get_optional<std::string>(expression_setting)) {
+                select_referenced(selected, expression.get());
+            }
+        }
+        // binary logs are formatted later, with a format that isn't known yet
+        const auto destination = sink_section.second.get_optional<std::string>("Destination");
+        if (destination && (destination.get() == "BinaryFile" || destination.get() == "SharedMemory")) {
+            selected.thread_id = true;
+            selected.process_id = true;
+        }
+    }
+    return selected;
+}
+
+void optional_attributes::install() const {
+    auto core = logging::core::get();
+    auto attributes = core->get_global_attributes();
+    select_global_attribute(attributes, thread_id_name, thread_id, cached_thread_id());
+    select_global_attribute(attributes, process_id_name, process_id, pooled_process_id());
+    select_global_attribute(attributes, scope_name, scope, lazy_named_scope());
+    core->set_global_attributes(attributes);
+}
+
+class lazy_named_scope::impl : public logging::attribute::impl {
+public:
+    logging::attribute_value get_value() override {
+        return logging::attribute_value(new lazy_scope_value(attrs::named_scope::get_scopes()));
+    }
+};
+
+lazy_named_scope::lazy_named_scope() : logging::attribute(new impl()) {
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef OPTIONAL_ATTRIBUTES_HPP
+#define OPTIONAL_ATTRIBUTES_HPP
+
+#include <string>
+
+#include <boost/log/attributes/attribute.hpp>
+#include <boost/log/utility/setup/settings.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief The global attributes that are only installed if the configuration needs them
+///
+/// ThreadID, ProcessID and Scope add to the cost of every record. An attribute is installed if a Format or Filter
+/// setting of a sink or the Core filter refers to it. BinaryFile and SharedMemory sinks keep ThreadID and ProcessID
+/// for the sinks that decode them later. Sinks that are added in code can request attributes with the
+/// Attributes.Always setting, a comma separated list like "ThreadID,Scope".
+struct optional_attributes {
+    /// \brief the attributes \p settings needs, throws EverestConfigError for unknown names in Attributes.Always
+    static optional_attributes from_settings(const logging::settings& settings);
+
+    /// \brief adds the selected global attributes and removes the others
+    void install() const;
+
+    bool thread_id{false};
+    bool process_id{false};
+    bool scope{false};
+};
+
+///
+/// \brief The Scope attribute, the named scopes of the thread opening the record
+///
+/// Unlike logging::attributes::named_scope, the value only refers to the scope list of the thread. The list is only
+/// copied when Boost.Log detaches the record from the thread, which it does for sinks that format records later or
+/// in another thread.
+class lazy_named_scope : public logging::attribute {
+public:
+    lazy_named_scope();
+
+private:
+    class impl;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // OPTIONAL_ATTRIBUTES_HPP
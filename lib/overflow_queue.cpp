@@ -0,0 +1,229 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "overflow_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+#include <boost/log/attributes/constant.hpp>
+#include <boost/log/attributes/value_extraction.hpp>
+#include <boost/log/core.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+const logging::attribute_name severity_name("Severity");
+const logging::attribute_name message_name("Message");
+
+/// the records dropped by all overflow queues of the process
+std::atomic<std::uint64_t> total_dropped[critical + 1];
+
+bool below(const logging::record_view& rec, severity_level severity) {
+    // records without a severity are never dropped in favour of others
+    const auto level = logging::extract<severity_level>(severity_name, rec);
+    return level && level.get() < severity;
+}
+
+/// the warning written for \p count dropped records
+logging::record_view make_report(std::uint64_t count) {
+    logging::attribute_set attributes;
+    attributes.insert(severity_name, logging::attributes::make_constant(warning));
+    attributes.insert(message_name, logging::attributes::make_constant(std::to_string(count) +
+                                                                       " records dropped, the sink queue was full"));
+    auto rec = logging::core::get()->open_record(attributes);
+    return rec ? rec.lock() : logging::record_view();
+}
+} // namespace
+
+std::uint64_t dropped_records(severity_level level) {
+    if (level < verbose || level > critical) {
+        return 0;
+    }
+    return total_dropped[level].load(std::memory_order_relaxed);
+}
+
+overflow_queue::overflow_queue() {
+    register_crash_flushable(this);
+}
+
+overflow_queue::~overflow_queue() {
+    unregister_crash_flushable(this);
+}
+
+void overflow_queue::set_overflow_policy(const overflow_policy& new_policy) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        policy = new_policy;
+    }
+    space_available.notify_all();
+}
+
+std::uint64_t overflow_queue::dropped(severity_level level) const {
+    if (level < verbose || level > critical) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped_by_severity[level];
+}
+
+void overflow_queue::set_counters(std::shared_ptr<sink_counters> new_counters) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counters = std::move(new_counters);
+}
+
+void overflow_queue::enqueue(const logging::record_view& rec) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (policy.capacity != 0 && records.size() >= policy.capacity) {
+        if (policy.action == overflow_action::drop_newest ||
+            (policy.action == overflow_action::drop_below_severity && below(rec, policy.severity))) {
+            count_dropped(rec);
+            return;
+        }
+        if (policy.action == overflow_action::drop_oldest) {
+            count_dropped(records.front());
+            records.pop_front();
+            ++dropped_queued;
+            continue;
+        }
+        if (policy.action == overflow_action::drop_below_severity) {
+            const auto oldest = oldest_below_severity();
+            if (oldest != records.end()) {
+                count_dropped(*oldest);
+                records.erase(oldest);
+                ++dropped_queued;
+                continue;
+            }
+        }
+        if (released) {
+            count_dropped(rec);
+            return;
+        }
+        space_available.wait(lock);
+    }
+    push(rec);
+    if (records.size() == 1) {
+        records_available.notify_one();
+    }
+}
+
+bool overflow_queue::try_enqueue(const logging::record_view& rec) {
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    // the overflow policy isn't applied, it might block
+    if (!lock.owns_lock() || (policy.capacity != 0 && records.size() >= policy.capacity)) {
+        return false;
+    }
+    push(rec);
+    if (records.size() == 1) {
+        records_available.notify_one();
+    }
+    return true;
+}
+
+bool overflow_queue::try_dequeue_ready(logging::record_view& rec) {
+    return try_dequeue(rec);
+}
+
+bool overflow_queue::try_dequeue(logging::record_view& rec) {
+    std::unique_lock<std::mutex> lock(mutex);
+    note_consumed();
+    return !records.empty() && pop(lock, rec);
+}
+
+bool overflow_queue::dequeue_ready(logging::record_view& rec) {
+    std::unique_lock<std::mutex> lock(mutex);
+    note_consumed();
+    while (!interruption_requested) {
+        if (!records.empty()) {
+            return pop(lock, rec);
+        }
+        records_available.wait(lock);
+    }
+    interruption_requested = false;
+    return false;
+}
+
+void overflow_queue::interrupt_dequeue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        interruption_requested = true;
+    }
+    records_available.notify_one();
+}
+
+void overflow_queue::release_producers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = true;
+    }
+    space_available.notify_all();
+}
+
+void overflow_queue::count_dropped(const logging::record_view& rec) {
+    const auto level = logging::extract<severity_level>(severity_name, rec);
+    if (level && level.get() >= verbose && level.get() <= critical) {
+        ++dropped_by_severity[level.get()];
+        total_dropped[level.get()].fetch_add(1, std::memory_order_relaxed);
+    }
+    ++unreported;
+}
+
+std::deque<logging::record_view>::iterator overflow_queue::oldest_below_severity() {
+    return std::find_if(records.begin(), records.end(),
+                        [this](const logging::record_view& queued) { return below(queued, policy.severity); });
+}
+
+bool overflow_queue::pop(std::unique_lock<std::mutex>& lock, logging::record_view& rec) {
+    if (unreported != 0) {
+        const auto now = std::chrono::steady_clock::now();
+        if (!last_report || now - *last_report >= policy.report_interval) {
+            const auto count = unreported;
+            unreported = 0;
+            last_report = now;
+            // opening a record evaluates the filters of all sinks, including the one of this queue
+            lock.unlock();
+            auto report = make_report(count);
+            if (report) {
+                rec.swap(report);
+                return true;
+            }
+            lock.lock();
+            if (records.empty()) {
+                return false;
+            }
+        }
+    }
+    rec.swap(records.front());
+    records.pop_front();
+    ++popped;
+    space_available.notify_one();
+    return true;
+}
+
+void overflow_queue::push(const logging::record_view& rec) {
+    records.push_back(rec);
+    // only written with the mutex held
+    queued_total.store(queued_total.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+#ifdef LIBLOG_STATS
+    if (counters) {
+        counters->note_queue_depth(records.size());
+    }
+#endif
+}
+
+void overflow_queue::note_consumed() {
+    released = false;
+    retired_total.store(popped + dropped_queued, std::memory_order_release);
+}
+
+void overflow_queue::begin_crash_flush() noexcept {
+    crash_flush_target.store(queued_total.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+bool overflow_queue::crash_flushed() const noexcept {
+    return retired_total.load(std::memory_order_acquire) >= crash_flush_target.load(std::memory_order_acquire);
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef OVERFLOW_QUEUE_HPP
+#define OVERFLOW_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+
+#include <everest/logging.hpp>
+
+#include "crash_handler.hpp"
+#include "stats_counters.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief What an overflow_queue does with a record when it's full
+enum class overflow_action {
+    /// the producer waits until the sink made room
+    block,
+    /// the record is dropped
+    drop_newest,
+    /// the oldest queued record is dropped to make room
+    drop_oldest,
+    /// a record below the severity is dropped, for others the oldest queued record below it is dropped to make room,
+    /// if there is none the producer waits
+    drop_below_severity,
+};
+
+///
+/// \brief Capacity of an overflow_queue and how it treats records when it's full
+struct overflow_policy {
+    /// \brief records queued at most, 0 doesn't limit the queue
+    std::size_t capacity{0};
+    overflow_action action{overflow_action::block};
+    /// \brief records below it are dropped by drop_below_severity
+    severity_level severity{info};
+    /// \brief the sink writes a warning how many records were dropped at most this often
+    std::chrono::milliseconds report_interval{1000};
+};
+
+///
+/// \brief Queueing strategy of a Boost.Log asynchronous_sink with a capacity and overflow_policy set at runtime
+///
+/// Boost.Log only has a compile-time bounded queue. A dropped record is counted by severity for dropped_records(),
+/// the feeding thread of the sink writes a "N records dropped" warning with the attributes of the core before the next
+/// record, the first one right away and later ones once the report interval has passed. The warning isn't written if
+/// the Core filter rejects it. A crash handler waits for the feeding thread to write out the records queued when the
+/// process crashed.
+class overflow_queue : public crash_flushable {
+public:
+    /// \brief replaces the policy, records already queued beyond a smaller capacity are kept
+    void set_overflow_policy(const overflow_policy& policy);
+
+    /// \brief records of \p level dropped by this queue
+    std::uint64_t dropped(severity_level level) const;
+
+    /// \brief counters noting how many records were queued at most
+    void set_counters(std::shared_ptr<sink_counters> new_counters);
+
+    void begin_crash_flush() noexcept override;
+    bool crash_flushed() const noexcept override;
+
+protected:
+    overflow_queue();
+    template <typename ArgsT> explicit overflow_queue(const ArgsT&) : overflow_queue() {
+    }
+    ~overflow_queue();
+
+    void enqueue(const logging::record_view& rec);
+    bool try_enqueue(const logging::record_view& rec);
+    bool try_dequeue_ready(logging::record_view& rec);
+    bool try_dequeue(logging::record_view& rec);
+    bool dequeue_ready(logging::record_view& rec);
+    void interrupt_dequeue();
+
+    /// \brief nobody feeds the sink anymore, producers waiting for space drop their record until it's fed again
+    void release_producers();
+
+private:
+    /// counts \p rec as dropped, the mutex must be held
+    void count_dropped(const logging::record_view& rec);
+    /// the oldest queued record below the severity of the policy, the mutex must be held
+    std::deque<logging::record_view>::iterator oldest_below_severity();
+    /// pops the next record, or makes the drop report if it's due, the lock is released for the report
+    bool pop(std::unique_lock<std::mutex>& lock, logging::record_view& rec);
+    /// counts \p rec as queued, the mutex must be held
+    void push(const logging::record_view& rec);
+    /// the feeding thread asks for the next record, so it consumed the ones popped before, the mutex must be held
+    void note_consumed();
+
+    mutable std::mutex mutex;
+    std::condition_variable records_available;
+    std::condition_variable space_available;
+    std::deque<logging::record_view> records;
+    overflow_policy policy;
+    bool interruption_requested{false};
+    /// the sink was stopped, producers don't wait for space
+    bool released{false};
+
+    std::uint64_t dropped_by_severity[critical + 1]{};
+    std::uint64_t unreported{0};
+    /// unset until the first report, which is due right away
+    std::optional<std::chrono::steady_clock::time_point> last_report;
+
+    std::shared_ptr<sink_counters> counters;
+
+    /// records popped and queued records dropped, they left the queue
+    std::uint64_t popped{0};
+    std::uint64_t dropped_queued{0};
+    /// records queued so far, and popped and consumed or dropped so far, read by the crash handler
+    std::atomic<std::uint64_t> queued_total{0};
+    std::atomic<std::uint64_t> retired_total{0};
+    std::atomic<std::uint64_t> crash_flush_target{0};
+};
+
+///
+/// \brief Boost.Log asynchronous_sink with an overflow_queue, stopping it releases the producers waiting for space
+template <typename BackendT>
+class overflow_sink : public logging::sinks::asynchronous_sink<BackendT, overflow_queue> {
+public:
+    using logging::sinks::asynchronous_sink<BackendT, overflow_queue>::asynchronous_sink;
+
+    void stop() {
+        logging::sinks::asynchronous_sink<BackendT, overflow_queue>::stop();
+        this->release_producers();
+    }
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // OVERFLOW_QUEUE_HPP
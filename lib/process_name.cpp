@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "process_name.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/log/attributes/attribute_value_impl.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+/// a name that was set, the generation tells the per thread caches apart from the ones of other attributes
+struct published_name {
+    std::string name;
+    std::uint64_t generation;
+};
+
+std::atomic<std::uint64_t> next_generation{1};
+} // namespace
+
+class process_name_attribute::impl : public logging::attribute::impl {
+public:
+    explicit impl(const std::string& name) {
+        set(name);
+    }
+
+    logging::attribute_value get_value() override {
+        struct cache {
+            std::uint64_t generation{0};
+            logging::attribute_value value;
+        };
+        thread_local cache cached;
+
+        const auto* published = current.load(std::memory_order_acquire);
+        if (cached.generation != published->generation) {
+            cached.value = logging::attributes::make_attribute_value(published->name);
+            cached.generation = published->generation;
+        }
+        return cached.value;
+    }
+
+    void set(const std::string& name) {
+        auto published =
+            std::make_unique<const published_name>(published_name{name, next_generation.fetch_add(1)});
+
+        std::lock_guard<std::mutex> lock(names_mutex);
+        names.push_back(std::move(published));
+        current.store(names.back().get(), std::memory_order_release);
+    }
+
+    std::string get() const {
+        return current.load(std::memory_order_acquire)->name;
+    }
+
+private:
+    std::mutex names_mutex;
+    /// every name that was set, threads might still read a replaced one
+    std::vector<std::unique_ptr<const published_name>> names;
+    std::atomic<const published_name*> current{nullptr};
+};
+
+process_name_attribute::process_name_attribute(const std::string& name) : logging::attribute(new impl(name)) {
+}
+
+void process_name_attribute::set(const std::string& name) {
+    static_cast<impl*>(get_impl())->set(name);
+}
+
+std::string process_name_attribute::get() const {
+    return static_cast<impl*>(get_impl())->get();
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef PROCESS_NAME_HPP
+#define PROCESS_NAME_HPP
+
+#include <string>
+
+#include <boost/log/attributes/attribute.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief The Process attribute, a std::string that can be replaced while other threads are logging
+///
+/// Every name that was set stays alive, the current one is published through an atomic pointer. Each thread keeps
+/// the attribute value of the name it has seen last, so reading the attribute neither locks nor allocates and threads
+/// don't share a reference count. Replacing the name is meant to be rare, e.g. once after startup.
+class process_name_attribute : public logging::attribute {
+public:
+    explicit process_name_attribute(const std::string& name);
+
+    /// \brief records opened after this call carry \p name
+    void set(const std::string& name);
+
+    /// \brief the current name
+    std::string get() const;
+
+private:
+    class impl;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // PROCESS_NAME_HPP
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <everest/record_stream.hpp>
+
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/log/attributes/attribute_name.hpp>
+
+namespace Everest {
+namespace Logging {
+namespace detail {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+namespace {
+/// blocks a thread keeps at most, the rest is returned to operator delete
+constexpr std::size_t max_cached_blocks = 256;
+/// larger message buffers are released instead of being reused
+constexpr std::size_t max_recycled_message_capacity = 4096;
+
+struct free_block {
+    free_block* next;
+};
+
+/// Everything a thread keeps for its next records.
+struct thread_cache {
+    ~thread_cache();
+
+    free_block* blocks{nullptr};
+    std::size_t block_count{0};
+    /// buffer of the last released message
+    std::string message_buffer;
+    /// streams that aren't writing a message, nested EVLOG_* statements need more than one
+    std::vector<std::unique_ptr<logging::formatting_ostream>> streams;
+};
+
+/// attribute values might be released while thread_local objects are destroyed, they mustn't use the cache anymore
+thread_local bool cache_destroyed = false;
+thread_local thread_cache cache;
+
+thread_cache::~thread_cache() {
+    cache_destroyed = true;
+    while (blocks != nullptr) {
+        auto* block = blocks;
+        blocks = block->next;
+        ::operator delete(block);
+    }
+}
+
+/// Message of an EVLOG_* record, its string reuses the buffer of the previous message of the thread.
+class message_value : public pooled_attribute_value<std::string> {
+public:
+    message_value() : pooled_attribute_value<std::string>(take_buffer()) {
+    }
+
+    ~message_value() override {
+        auto& buffer = text();
+        if (!cache_destroyed && buffer.capacity() <= max_recycled_message_capacity &&
+            buffer.capacity() > cache.message_buffer.capacity()) {
+            cache.message_buffer.swap(buffer);
+        }
+    }
+
+    std::string& text() {
+        // the stream writes into the value like the one of the Boost.Log record stream does
+        return const_cast<std::string&>(get());
+    }
+
+private:
+    static std::string take_buffer() {
+        std::string buffer;
+        if (!cache_destroyed) {
+            buffer.swap(cache.message_buffer);
+            buffer.clear();
+        }
+        return buffer;
+    }
+};
+
+logging::formatting_ostream* acquire_stream() {
+    if (cache_destroyed || cache.streams.empty()) {
+        return new logging::formatting_ostream();
+    }
+    auto* strm = cache.streams.back().release();
+    cache.streams.pop_back();
+    return strm;
+}
+
+void release_stream(logging::formatting_ostream* strm) {
+    strm->detach();
+    // the next message starts with the defaults of a fresh stream
+    strm->clear();
+    strm->flags(std::ios_base::dec | std::ios_base::skipws);
+    strm->width(0);
+    strm->precision(6);
+    strm->fill(' ');
+    if (cache_destroyed) {
+        delete strm;
+        return;
+    }
+    cache.streams.emplace_back(strm);
+}
+} // namespace
+
+void* allocate_record_block(std::size_t size) {
+    if (size > record_block_size) {
+        return ::operator new(size);
+    }
+    if (cache_destroyed || cache.blocks == nullptr) {
+        return ::operator new(record_block_size);
+    }
+    auto* block = cache.blocks;
+    cache.blocks = block->next;
+    --cache.block_count;
+    return block;
+}
+
+void free_record_block(void* block, std::size_t size) noexcept {
+    if (size > record_block_size || cache_destroyed || cache.block_count >= max_cached_blocks) {
+        ::operator delete(block);
+        return;
+    }
+    cache.blocks = new (block) free_block{cache.blocks};
+    ++cache.block_count;
+}
+
+record_stream::record_stream(logging::record& rec) : rec(rec), strm(acquire_stream()) {
+    static const logging::attribute_name message_name("Message");
+    auto* message = new message_value();
+    logging::attribute_value value(message);
+    auto inserted = rec.attribute_values().insert(message_name, value);
+    if (!inserted.second) {
+        const_cast<logging::attribute_value&>(inserted.first->second).swap(value);
+    }
+    strm->attach(message->text());
+}
+
+record_stream::~record_stream() {
+    release_stream(strm);
+}
+
+void record_stream::finish() {
+    // the record might be released by the sinks, the stream must not refer to its message anymore
+    strm->detach();
+}
+
+} // namespace detail
+} // namespace Logging
+} // namespace Everest
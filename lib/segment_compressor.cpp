@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "segment_compressor.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(LIBLOG_COMPRESSION_ZSTD)
+#include <zstd.h>
+#elif defined(LIBLOG_COMPRESSION_LZ4)
+#include <lz4frame.h>
+#endif
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+[[maybe_unused]] ssize_t read_some(int fd, char* data, std::size_t size) {
+    ssize_t length = 0;
+    do {
+        length = ::read(fd, data, size);
+    } while (length < 0 && errno == EINTR);
+    return length;
+}
+
+[[maybe_unused]] bool write_all(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+#if defined(LIBLOG_COMPRESSION_ZSTD)
+bool compress_zstd(int in_fd, int out_fd, const std::atomic<bool>& stop) {
+    const std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+    if (!context) {
+        return false;
+    }
+    std::vector<char> in(ZSTD_CStreamInSize());
+    std::vector<char> out(ZSTD_CStreamOutSize());
+    while (!stop.load(std::memory_order_relaxed)) {
+        const auto length = read_some(in_fd, in.data(), in.size());
+        if (length < 0) {
+            return false;
+        }
+        const auto mode = length == 0 ? ZSTD_e_end : ZSTD_e_continue;
+        ZSTD_inBuffer input{in.data(), static_cast<std::size_t>(length), 0};
+        bool finished = false;
+        while (!finished) {
+            ZSTD_outBuffer output{out.data(), out.size(), 0};
+            const auto remaining = ZSTD_compressStream2(context.get(), &output, &input, mode);
+            if (ZSTD_isError(remaining) || !write_all(out_fd, out.data(), output.pos)) {
+                return false;
+            }
+            finished = mode == ZSTD_e_end ? remaining == 0 : input.pos == input.size;
+        }
+        if (length == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const compression_codec zstd_codec{".zst", &compress_zstd};
+#elif defined(LIBLOG_COMPRESSION_LZ4)
+bool compress_lz4(int in_fd, int out_fd, const std::atomic<bool>& stop) {
+    LZ4F_cctx* raw_context = nullptr;
+    if (LZ4F_isError(LZ4F_createCompressionContext(&raw_context, LZ4F_VERSION))) {
+        return false;
+    }
+    const std::unique_ptr<LZ4F_cctx, decltype(&LZ4F_freeCompressionContext)> context(raw_context,
+                                                                                     &LZ4F_freeCompressionContext);
+    constexpr std::size_t chunk_size = 64 * 1024;
+    std::vector<char> in(chunk_size);
+    std::vector<char> out(LZ4F_compressBound(chunk_size, nullptr));
+
+    auto written = LZ4F_compressBegin(context.get(), out.data(), out.size(), nullptr);
+    if (LZ4F_isError(written) || !write_all(out_fd, out.data(), written)) {
+        return false;
+    }
+    while (!stop.load(std::memory_order_relaxed)) {
+        const auto length = read_some(in_fd, in.data(), in.size());
+        if (length < 0) {
+            return false;
+        }
+        written = length == 0 ? LZ4F_compressEnd(context.get(), out.data(), out.size(), nullptr)
+                              : LZ4F_compressUpdate(context.get(), out.data(), out.size(), in.data(),
+                                                    static_cast<std::size_t>(length), nullptr);
+        if (LZ4F_isError(written) || !write_all(out_fd, out.data(), written)) {
+            return false;
+        }
+        if (length == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const compression_codec lz4_codec{".lz4", &compress_lz4};
+#endif
+
+/// compression only gets the time and disk bandwidth nothing else needs
+void lower_priority() {
+#ifdef __linux__
+    sched_param parameters{};
+    if (::pthread_setschedparam(::pthread_self(), SCHED_IDLE, &parameters) != 0) {
+        // the nice value of the calling thread only on Linux
+        ::setpriority(PRIO_PROCESS, 0, 19);
+    }
+#ifdef SYS_ioprio_set
+    constexpr int ioprio_who_process = 1;
+    constexpr int ioprio_class_idle = 3;
+    constexpr int ioprio_class_shift = 13;
+    ::syscall(SYS_ioprio_set, ioprio_who_process, 0, ioprio_class_idle << ioprio_class_shift);
+#endif
+#endif
+}
+} // namespace
+
+const compression_codec* built_in_codec() {
+#if defined(LIBLOG_COMPRESSION_ZSTD)
+    return &zstd_codec;
+#elif defined(LIBLOG_COMPRESSION_LZ4)
+    return &lz4_codec;
+#else
+    return nullptr;
+#endif
+}
+
+segment_compressor::segment_compressor(const compression_codec& codec, std::size_t max_concurrent) : codec(codec) {
+    for (std::size_t i = 0; i < std::max<std::size_t>(max_concurrent, 1); ++i) {
+        workers.emplace_back(&segment_compressor::run_worker, this);
+    }
+}
+
+segment_compressor::~segment_compressor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queue_changed.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void segment_compressor::compress(const std::string& file_name) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(file_name);
+    }
+    queue_changed.notify_one();
+}
+
+void segment_compressor::discard(const std::string& file_name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.erase(std::remove(queue.begin(), queue.end(), file_name), queue.end());
+    if (running.count(file_name) != 0) {
+        discarded.insert(file_name);
+    }
+}
+
+std::string segment_compressor::compressed_name(const std::string& file_name) const {
+    return file_name + codec.extension;
+}
+
+void segment_compressor::run_worker() {
+    lower_priority();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (queue.empty()) {
+            queue_changed.wait(lock);
+            continue;
+        }
+        const auto file_name = queue.front();
+        queue.pop_front();
+        running.insert(file_name);
+        lock.unlock();
+        compress_file(file_name);
+        lock.lock();
+        running.erase(file_name);
+        discarded.erase(file_name);
+    }
+}
+
+void segment_compressor::compress_file(const std::string& file_name) {
+    const auto compressed = compressed_name(file_name);
+    const auto temporary = compressed + ".tmp";
+    const auto in_fd = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in_fd < 0) {
+        return;
+    }
+    const auto out_fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out_fd < 0) {
+        ::close(in_fd);
+        return;
+    }
+    // a stopped codec leaves an incomplete file, which is removed like the result of a failed one
+    const auto compressed_ok = codec.compress(in_fd, out_fd, stopping);
+    ::close(in_fd);
+    const auto closed_ok = ::close(out_fd) == 0;
+
+    // a discarded file may be removed meanwhile, deciding under the lock keeps the compressed one from outliving it
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!compressed_ok || !closed_ok || discarded.count(file_name) != 0 ||
+        ::rename(temporary.c_str(), compressed.c_str()) != 0) {
+        ::unlink(temporary.c_str());
+        return;
+    }
+    ::unlink(file_name.c_str());
+}
+
+} // namespace Logging
+} // namespace Everest
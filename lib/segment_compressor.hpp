@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef SEGMENT_COMPRESSOR_HPP
+#define SEGMENT_COMPRESSOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief Streaming codec for the complete segments of a file sink
+struct compression_codec {
+    /// \brief appended to the name of a compressed file, e.g. ".zst"
+    const char* extension;
+    /// \brief compresses everything read from \p in_fd into \p out_fd, returns false on errors
+    ///
+    /// \p stop is polled between chunks, once it's set the codec gives up and returns false.
+    bool (*compress)(int in_fd, int out_fd, const std::atomic<bool>& stop);
+};
+
+///
+/// \brief The codec selected with the LIBLOG_COMPRESSION CMake option
+/// \returns nullptr if liblog was built without one
+const compression_codec* built_in_codec();
+
+///
+/// \brief Compresses files on background threads of idle priority
+///
+/// compress() only queues the file, at most max_concurrent files are compressed at the same time. The codec writes
+/// to "<file><extension>.tmp", which is renamed to "<file><extension>" once it's complete, then the file is removed.
+/// Queued files that haven't been started when the compressor is destroyed stay uncompressed, the ones being compressed
+/// are given up and their "<file><extension>.tmp" is removed.
+class segment_compressor {
+public:
+    segment_compressor(const compression_codec& codec, std::size_t max_concurrent);
+    ~segment_compressor();
+    segment_compressor(const segment_compressor&) = delete;
+    segment_compressor& operator=(const segment_compressor&) = delete;
+
+    /// \brief queues \p file_name for compression and returns right away
+    void compress(const std::string& file_name);
+
+    /// \brief drops \p file_name from the queue, or the result of compressing it if that already started
+    void discard(const std::string& file_name);
+
+    /// \brief name of \p file_name once it's compressed
+    std::string compressed_name(const std::string& file_name) const;
+
+private:
+    void run_worker();
+    void compress_file(const std::string& file_name);
+
+    const compression_codec codec;
+
+    std::mutex mutex;
+    std::condition_variable queue_changed;
+    std::deque<std::string> queue;
+    /// files that are being compressed and those of them that were discarded meanwhile
+    std::set<std::string> running;
+    std::set<std::string> discarded;
+    /// set by the destructor, the workers and the codecs they run stop
+    std::atomic<bool> stopping{false};
+    std::vector<std::thread> workers;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // SEGMENT_COMPRESSOR_HPP
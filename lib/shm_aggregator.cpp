@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "shm_aggregator.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+#include <dirent.h>
+
+#include <boost/log/core.hpp>
+
+#include <everest/exceptions.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+// where POSIX shared memory segments show up on Linux
+const char* const shm_directory = "/dev/shm";
+
+/// heap order of the pending records, the oldest one first
+struct later {
+    template <typename T> bool operator()(const T& lhs, const T& rhs) const {
+        return lhs.timestamp != rhs.timestamp ? lhs.timestamp > rhs.timestamp : lhs.sequence > rhs.sequence;
+    }
+};
+} // namespace
+
+shm_aggregator::shm_aggregator(std::string segment, std::chrono::milliseconds reorder_window) :
+    segment(std::move(segment)), reorder_window(reorder_window) {
+}
+
+shm_aggregator::~shm_aggregator() {
+    flush();
+}
+
+std::size_t shm_aggregator::poll() {
+    discover();
+    collect();
+    return emit(shm_ring::now() - std::chrono::nanoseconds(reorder_window).count());
+}
+
+std::size_t shm_aggregator::flush() {
+    collect();
+    const auto pushed = emit(INT64_MAX);
+    logging::core::get()->flush();
+    return pushed;
+}
+
+std::size_t shm_aggregator::sources() const {
+    return attached.size();
+}
+
+void shm_aggregator::discover() {
+    const auto prefix = segment + ".";
+    std::unique_ptr<DIR, int (*)(DIR*)> directory(::opendir(shm_directory), &::closedir);
+    if (!directory) {
+        return;
+    }
+
+    while (const auto* entry = ::readdir(directory.get())) {
+        const std::string name = entry->d_name;
+        if (name.compare(0, prefix.size(), prefix) != 0 || name.size() == prefix.size() ||
+            !std::all_of(name.begin() + prefix.size(), name.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            continue;
+        }
+        const auto ring_name = "/" + name;
+        if (attached_names.count(ring_name) != 0) {
+            continue;
+        }
+        if (auto ring = shm_ring::attach(ring_name)) {
+            auto created = std::make_shared<source>();
+            created->ring = std::move(ring);
+            attached.push_back(created);
+            attached_names.insert(ring_name);
+        }
+    }
+}
+
+void shm_aggregator::collect() {
+    for (auto it = attached.begin(); it != attached.end();) {
+        auto& origin = *it;
+        // checked before draining, whatever an exited process wrote is visible by now
+        const auto abandoned = origin->ring->abandoned();
+
+        std::int64_t timestamp = 0;
+        while (origin->ring->peek(frame, timestamp)) {
+            std::istringstream frame_stream(std::string(frame.begin(), frame.end()));
+            logging::attribute_set attributes;
+            try {
+                if (origin->decoder.read(frame_stream, attributes)) {
+                    pending.push_back({timestamp, next_sequence++, std::move(attributes), origin});
+                    std::push_heap(pending.begin(), pending.end(), later());
+                }
+            } catch (const EverestInternalError& e) {
+                EVLOG_error << "Skipping record of process " << origin->ring->pid() << ": " << e.what();
+            }
+            origin->ring->pop();
+        }
+
+        if (const auto dropped = origin->ring->take_dropped()) {
+            EVLOG_warning << "Process " << origin->ring->pid() << " dropped " << dropped
+                          << " records, its shared memory ring was full";
+        }
+
+        if (abandoned) {
+            if (origin.use_count() == 1) {
+                // no pending records keep the ring alive, asynchronous sinks might still refer to its call sites
+                logging::core::get()->flush();
+            }
+            origin->ring->unlink();
+            attached_names.erase(origin->ring->name());
+            it = attached.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::size_t shm_aggregator::emit(std::int64_t until) {
+    auto core = logging::core::get();
+    std::size_t pushed = 0;
+    while (!pending.empty() && pending.front().timestamp <= until) {
+        std::pop_heap(pending.begin(), pending.end(), later());
+        auto next = std::move(pending.back());
+        pending.pop_back();
+
+        if (auto rec = core->open_record(next.attributes)) {
+            core->push_record(std::move(rec));
+            ++pushed;
+        }
+        if (next.origin.use_count() == 1) {
+            // the last record of a removed ring, asynchronous sinks might still refer to its call sites
+            core->flush();
+        }
+    }
+    return pushed;
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef SHM_AGGREGATOR_HPP
+#define SHM_AGGREGATOR_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/log/attributes/attribute_set.hpp>
+
+#include "binary_log.hpp"
+#include "shm_ring.hpp"
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief Consumer side of the SharedMemory sinks of all processes using the same segment
+///
+/// Picks up the rings of new processes, decodes their records and pushes them into the logging core of the calling
+/// process, ordered by the time they were written into the rings. Records are held back for \p reorder_window so that
+/// records of other processes written at the same time can still be sorted in. Rings of exited processes are removed
+/// once they are drained. Not thread safe, meant to be driven by a single thread.
+class shm_aggregator {
+public:
+    shm_aggregator(std::string segment, std::chrono::milliseconds reorder_window);
+    ~shm_aggregator();
+    shm_aggregator(const shm_aggregator&) = delete;
+    shm_aggregator& operator=(const shm_aggregator&) = delete;
+
+    /// \brief collects the records written so far and pushes the ones older than the reorder window
+    /// \returns the number of records pushed
+    std::size_t poll();
+
+    /// \brief collects the records written so far and pushes all of them
+    std::size_t flush();
+
+    /// \brief number of rings currently attached
+    std::size_t sources() const;
+
+private:
+    struct source {
+        std::unique_ptr<shm_ring> ring;
+        binary_log_decoder decoder;
+    };
+
+    struct pending_record {
+        std::int64_t timestamp;
+        std::uint64_t sequence;
+        logging::attribute_set attributes;
+        std::shared_ptr<source> origin; ///< keeps the call sites and strings of the decoded record alive
+    };
+
+    void discover();
+    void collect();
+    std::size_t emit(std::int64_t until);
+
+    const std::string segment;
+    const std::chrono::milliseconds reorder_window;
+    std::vector<std::shared_ptr<source>> attached;
+    std::set<std::string> attached_names;
+    std::vector<pending_record> pending; ///< min heap by timestamp and sequence
+    std::uint64_t next_sequence{0};
+    std::vector<unsigned char> frame;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // SHM_AGGREGATOR_HPP
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "shm_ring.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <everest/exceptions.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+constexpr char ring_magic[8] = {'E', 'V', 'L', 'O', 'G', 'S', 'H', 'M'};
+constexpr std::uint32_t ring_version = 1;
+constexpr std::uint32_t ring_ready = 1;
+
+struct frame_header {
+    std::uint32_t size;
+    std::int64_t timestamp;
+};
+
+std::size_t round_up_to_power_of_two(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+} // namespace
+
+/// Layout of the start of the segment, the ring data follows it. Shared between processes, so only lock-free atomics.
+struct shm_ring::header {
+    char magic[sizeof(ring_magic)];
+    std::uint32_t version;
+    std::uint32_t pid;
+    std::uint64_t capacity;
+    std::atomic<std::uint32_t> ready;
+    std::atomic<std::uint32_t> closed;
+    std::atomic<std::uint64_t> dropped;
+    alignas(64) std::atomic<std::uint64_t> write_position;
+    alignas(64) std::atomic<std::uint64_t> read_position;
+    alignas(64) unsigned char data[1];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the shared memory ring needs lock-free atomics");
+
+std::unique_ptr<shm_ring> shm_ring::create(const std::string& name, std::size_t capacity) {
+    capacity = round_up_to_power_of_two(std::max<std::size_t>(capacity, 2 * sizeof(frame_header)));
+    const auto mapped_size = offsetof(header, data) + capacity;
+
+    // a segment of the same name is left over by a process that had the same pid
+    ::shm_unlink(name.c_str());
+    const auto fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+    if (fd == -1) {
+        throw EverestInternalError("Could not create shared memory segment " + name + ": " + std::strerror(errno));
+    }
+    struct stat status {};
+    if (::ftruncate(fd, static_cast<off_t>(mapped_size)) == -1 || ::fstat(fd, &status) == -1) {
+        const auto error = errno;
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw EverestInternalError("Could not size shared memory segment " + name + ": " + std::strerror(error));
+    }
+    auto* mapping = ::mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        throw EverestInternalError("Could not map shared memory segment " + name + ": " + std::strerror(errno));
+    }
+
+    // the segment is zero filled, ready is published last so an attaching consumer sees a complete header
+    auto* shared = static_cast<header*>(mapping);
+    std::memcpy(shared->magic, ring_magic, sizeof(ring_magic));
+    shared->version = ring_version;
+    shared->pid = static_cast<std::uint32_t>(::getpid());
+    shared->capacity = capacity;
+    shared->ready.store(ring_ready, std::memory_order_release);
+
+    return std::unique_ptr<shm_ring>(new shm_ring(name, shared, mapped_size, status.st_dev, status.st_ino));
+}
+
+std::unique_ptr<shm_ring> shm_ring::attach(const std::string& name) {
+    const auto fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd == -1) {
+        return nullptr;
+    }
+    struct stat status {};
+    if (::fstat(fd, &status) == -1 || static_cast<std::size_t>(status.st_size) < offsetof(header, data)) {
+        // still being created
+        ::close(fd);
+        return nullptr;
+    }
+    const auto mapped_size = static_cast<std::size_t>(status.st_size);
+    auto* mapping = ::mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+
+    auto* shared = static_cast<header*>(mapping);
+    if (shared->ready.load(std::memory_order_acquire) != ring_ready ||
+        std::memcmp(shared->magic, ring_magic, sizeof(ring_magic)) != 0 || shared->version != ring_version ||
+        offsetof(header, data) + shared->capacity != mapped_size) {
+        ::munmap(mapping, mapped_size);
+        return nullptr;
+    }
+    return std::unique_ptr<shm_ring>(new shm_ring(name, shared, mapped_size, status.st_dev, status.st_ino));
+}
+
+shm_ring::shm_ring(std::string name, header* shared, std::size_t mapped_size, dev_t device, ino_t inode) :
+    name_(std::move(name)), shared(shared), mapped_size(mapped_size), data(shared->data), device(device), inode(inode) {
+}
+
+shm_ring::~shm_ring() {
+    ::munmap(shared, mapped_size);
+}
+
+bool shm_ring::try_write(const unsigned char* frame, std::size_t size) {
+    const frame_header frame_head{static_cast<std::uint32_t>(size), now()};
+    const auto write_position = shared->write_position.load(std::memory_order_relaxed);
+    const auto read_position = shared->read_position.load(std::memory_order_acquire);
+    if (sizeof(frame_head) + size > shared->capacity - (write_position - read_position)) {
+        shared->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    copy_in(write_position, &frame_head, sizeof(frame_head));
+    copy_in(write_position + sizeof(frame_head), frame, size);
+    shared->write_position.store(write_position + sizeof(frame_head) + size, std::memory_order_release);
+    return true;
+}
+
+void shm_ring::close() {
+    shared->closed.store(1, std::memory_order_release);
+}
+
+bool shm_ring::peek(std::vector<unsigned char>& frame, std::int64_t& timestamp) {
+    const auto read_position = shared->read_position.load(std::memory_order_relaxed);
+    const auto write_position = shared->write_position.load(std::memory_order_acquire);
+    if (write_position - read_position < sizeof(frame_header)) {
+        return false;
+    }
+
+    frame_header frame_head{};
+    copy_out(read_position, &frame_head, sizeof(frame_head));
+    if (frame_head.size > write_position - read_position - sizeof(frame_head)) {
+        throw EverestInternalError("Corrupt frame in shared memory segment " + name_);
+    }
+    frame.resize(frame_head.size);
+    copy_out(read_position + sizeof(frame_head), frame.data(), frame.size());
+    timestamp = frame_head.timestamp;
+    peeked_size = sizeof(frame_head) + frame_head.size;
+    return true;
+}
+
+void shm_ring::pop() {
+    shared->read_position.fetch_add(peeked_size, std::memory_order_release);
+    peeked_size = 0;
+}
+
+std::uint64_t shm_ring::take_dropped() {
+    return shared->dropped.exchange(0, std::memory_order_relaxed);
+}
+
+bool shm_ring::abandoned() const {
+    if (shared->closed.load(std::memory_order_acquire) != 0) {
+        return true;
+    }
+    return ::kill(static_cast<pid_t>(shared->pid), 0) == -1 && errno == ESRCH;
+}
+
+std::uint32_t shm_ring::pid() const {
+    return shared->pid;
+}
+
+const std::string& shm_ring::name() const {
+    return name_;
+}
+
+void shm_ring::unlink() {
+    // a sink that was recreated, or a new process with the same pid, replaced the segment under the same name
+    const auto fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd == -1) {
+        return;
+    }
+    struct stat status {};
+    const auto same_segment = ::fstat(fd, &status) == 0 && status.st_dev == device && status.st_ino == inode;
+    ::close(fd);
+    if (same_segment) {
+        ::shm_unlink(name_.c_str());
+    }
+}
+
+std::int64_t shm_ring::now() {
+    timespec time{};
+    ::clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<std::int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+void shm_ring::copy_in(std::uint64_t position, const void* source, std::size_t size) {
+    const auto offset = position & (shared->capacity - 1);
+    const auto first = std::min<std::size_t>(size, shared->capacity - offset);
+    std::memcpy(data + offset, source, first);
+    std::memcpy(data, static_cast<const unsigned char*>(source) + first, size - first);
+}
+
+void shm_ring::copy_out(std::uint64_t position, void* destination, std::size_t size) const {
+    const auto offset = position & (shared->capacity - 1);
+    const auto first = std::min<std::size_t>(size, shared->capacity - offset);
+    std::memcpy(destination, data + offset, first);
+    std::memcpy(static_cast<unsigned char*>(destination) + first, data, size - first);
+}
+
+} // namespace Logging
+} // namespace Everest
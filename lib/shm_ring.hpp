@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef SHM_RING_HPP
+#define SHM_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief Single producer / single consumer byte ring in a named POSIX shared memory segment
+///
+/// The producing process creates the segment, another process attaches to it and consumes. Every frame carries the
+/// CLOCK_MONOTONIC time it was written at, which is comparable between processes. The ring never blocks the
+/// producer, frames that don't fit are dropped and counted.
+class shm_ring {
+public:
+    /// \brief creates the segment \p name of \p capacity bytes for the calling process, replacing a stale one
+    /// \throws EverestInternalError if the segment can't be created
+    static std::unique_ptr<shm_ring> create(const std::string& name, std::size_t capacity);
+
+    /// \brief attaches to the segment \p name, returns nullptr if it doesn't exist or is not initialized yet
+    static std::unique_ptr<shm_ring> attach(const std::string& name);
+
+    ~shm_ring();
+    shm_ring(const shm_ring&) = delete;
+    shm_ring& operator=(const shm_ring&) = delete;
+
+    /// \brief producer side, appends a frame of \p size bytes, returns false and counts a drop if it doesn't fit
+    bool try_write(const unsigned char* data, std::size_t size);
+
+    /// \brief producer side, tells the consumer that no more frames will follow
+    void close();
+
+    /// \brief consumer side, copies the oldest frame into \p frame without consuming it
+    /// \returns false if the ring is empty
+    bool peek(std::vector<unsigned char>& frame, std::int64_t& timestamp);
+
+    /// \brief consumer side, consumes the frame returned by peek()
+    void pop();
+
+    /// \brief consumer side, frames dropped since the last call
+    std::uint64_t take_dropped();
+
+    /// \brief the producer closed the ring or exited
+    bool abandoned() const;
+
+    std::uint32_t pid() const;
+    const std::string& name() const;
+
+    /// \brief removes the segment, attached rings stay usable until they are destroyed
+    ///
+    /// The name is left alone if it already refers to a segment the producer created again, e.g. after a sink was
+    /// recreated on reload.
+    void unlink();
+
+    /// \brief CLOCK_MONOTONIC in nanoseconds
+    static std::int64_t now();
+
+private:
+    struct header;
+
+    shm_ring(std::string name, header* shared, std::size_t mapped_size, dev_t device, ino_t inode);
+
+    void copy_in(std::uint64_t position, const void* data, std::size_t size);
+    void copy_out(std::uint64_t position, void* data, std::size_t size) const;
+
+    const std::string name_;
+    header* const shared;
+    const std::size_t mapped_size;
+    unsigned char* const data;
+    std::uint64_t peeked_size{0};
+    /// identify the segment independent of its name
+    const dev_t device;
+    const ino_t inode;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // SHM_RING_HPP
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "shm_sink.hpp"
+
+#include <unistd.h>
+
+namespace Everest {
+namespace Logging {
+
+shm_backend::shm_backend(const std::string& segment, std::size_t ring_size) :
+    ring(shm_ring::create(ring_name(segment, static_cast<std::uint32_t>(::getpid())), ring_size)) {
+}
+
+shm_backend::~shm_backend() {
+    ring->close();
+}
+
+void shm_backend::consume(const logging::record_view& rec) {
+    // every frame carries exactly one record, preceded by the definitions it needs
+    if (!session_started) {
+        encoder.begin_session(buffer);
+        session_started = true;
+    }
+    encoder.encode(rec, buffer);
+
+    // a dropped frame might have defined strings or call sites, the next frame starts over with a new session
+    if (!ring->try_write(buffer.data(), buffer.size())) {
+        session_started = false;
+    }
+    buffer.clear();
+}
+
+std::string shm_backend::ring_name(const std::string& segment, std::uint32_t pid) {
+    return "/" + segment + "." + std::to_string(pid);
+}
+
+} // namespace Logging
+} // namespace Everest
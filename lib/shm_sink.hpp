@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef SHM_SINK_HPP
+#define SHM_SINK_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/log/sinks/basic_sink_backend.hpp>
+
+#include "binary_log.hpp"
+#include "shm_ring.hpp"
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief Sink backend handing records in the binary log format to an everest_log_aggregator process
+///
+/// Every process owns one shm_ring named "/<segment>.<pid>", the aggregator picks up all rings of \p segment. Records
+/// that don't fit into the ring, e.g. because no aggregator is running, are dropped and reported by the aggregator
+/// later on.
+class shm_backend : public logging::sinks::basic_sink_backend<logging::sinks::synchronized_feeding> {
+public:
+    /// \param segment common name prefix of the rings of all processes
+    /// \param ring_size capacity of the ring of this process in bytes
+    shm_backend(const std::string& segment, std::size_t ring_size);
+    ~shm_backend();
+
+    void consume(const logging::record_view& rec);
+
+    /// \brief name of the ring of the process \p pid in \p segment
+    static std::string ring_name(const std::string& segment, std::uint32_t pid);
+
+private:
+    std::unique_ptr<shm_ring> ring;
+    binary_log_encoder encoder;
+    std::vector<unsigned char> buffer;
+    bool session_started{false};
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // SHM_SINK_HPP
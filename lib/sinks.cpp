@@ -0,0 +1,671 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "sinks.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include <unistd.h>
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/utility/setup/filter_parser.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <boost/log/utility/setup/from_settings.hpp>
+#include <boost/optional.hpp>
+
+#include <everest/exceptions.hpp>
+
+#include "binary_file_sink.hpp"
+#include "compiled_format.hpp"
+#include "fd_sink.hpp"
+#include "flight_recorder.hpp"
+#include "formatters.hpp"
+#include "lockfree_sink.hpp"
+#include "mapped_file_sink.hpp"
+#include "overflow_queue.hpp"
+#include "shm_sink.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace sinks = logging::sinks;
+
+using settings_section = logging::settings_section;
+
+namespace {
+constexpr std::size_t default_queue_capacity = 1024;
+constexpr std::size_t default_shm_ring_size = 1024 * 1024;
+const char* const default_shm_segment = "everest_log";
+
+std::string lowercase(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+sinks::auto_newline_mode setting_to_auto_newline_mode(const std::string& value) {
+    if (value == "Disabled") {
+        return sinks::disabled_auto_newline;
+    }
+    if (value == "AlwaysInsert") {
+        return sinks::always_insert;
+    }
+    if (value == "InsertIfMissing") {
+        return sinks::insert_if_missing;
+    }
+    throw EverestConfigError("Invalid value \"" + value + "\" for sink setting AutoNewline");
+}
+
+logging::filter parse_filter_setting(const settings_section& settings) {
+    if (auto filter = settings["Filter"].get()) {
+        return logging::parse_filter(filter.get());
+    }
+    return logging::filter();
+}
+
+/// The Format setting of a sink section, none if it has none or the backend writes unformatted records.
+template <typename BackendT>
+boost::optional<logging::formatter> parse_format_setting(const settings_section& settings) {
+    if constexpr (sinks::has_requirement<typename BackendT::frontend_requirements, sinks::formatted_records>::value) {
+        if (auto format = settings["Format"].get()) {
+            return compile_formatter(format.get());
+        }
+    }
+    return boost::none;
+}
+
+/// Applies a Format setting parsed by parse_format_setting() to a Boost.Log sink frontend.
+template <typename BackendT, typename FrontendT>
+void apply_format(FrontendT& frontend, const boost::optional<logging::formatter>& formatter) {
+    if constexpr (sinks::has_requirement<typename BackendT::frontend_requirements, sinks::formatted_records>::value) {
+        if (formatter) {
+            frontend.set_formatter(formatter.get());
+        } else {
+            frontend.reset_formatter();
+        }
+    }
+}
+
+/// The parsed Filter and Format settings of a sink section.
+struct filter_and_format {
+    logging::filter filter;
+    boost::optional<logging::formatter> formatter;
+};
+
+template <typename BackendT> filter_and_format parse_filter_and_format(const settings_section& settings) {
+    return {parse_filter_setting(settings), parse_format_setting<BackendT>(settings)};
+}
+
+/// Applies the Filter and Format settings to a Boost.Log sink frontend.
+template <typename BackendT, typename FrontendT>
+void apply_filter_and_format(FrontendT& frontend, const filter_and_format& parsed) {
+    frontend.set_filter(parsed.filter);
+    apply_format<BackendT>(frontend, parsed.formatter);
+}
+
+overflow_action setting_to_overflow_action(const std::string& value) {
+    if (value == "Block") {
+        return overflow_action::block;
+    }
+    if (value == "DropNewest") {
+        return overflow_action::drop_newest;
+    }
+    if (value == "DropOldest") {
+        return overflow_action::drop_oldest;
+    }
+    if (value == "DropBelowSeverity") {
+        return overflow_action::drop_below_severity;
+    }
+    throw EverestConfigError("Invalid value \"" + value +
+                             "\" for setting OverflowPolicy, expected Block, DropNewest, DropOldest or DropBelowSeverity");
+}
+
+/// The QueueCapacity, OverflowPolicy, OverflowSeverity and DropReportIntervalMs settings of an asynchronous sink, its
+/// queue is only bounded if QueueCapacity or OverflowPolicy is set.
+overflow_policy overflow_policy_from_settings(const settings_section& settings) {
+    overflow_policy policy;
+    if (auto action = settings["OverflowPolicy"].get()) {
+        policy.action = setting_to_overflow_action(action.get());
+        policy.capacity = default_queue_capacity;
+    }
+    if (auto capacity = settings["QueueCapacity"].get()) {
+        policy.capacity = setting_to_size("QueueCapacity", capacity.get());
+    }
+    if (auto severity = settings["OverflowSeverity"].get()) {
+        policy.severity = setting_to_severity("OverflowSeverity", severity.get());
+    }
+    if (auto interval = settings["DropReportIntervalMs"].get()) {
+        policy.report_interval = std::chrono::milliseconds(setting_to_size("DropReportIntervalMs", interval.get()));
+    }
+    return policy;
+}
+
+/// Parses the Backend and Asynchronous settings, the returned sink_maker wraps the backend made by \p make_backend
+/// into the selected frontend. Its queue notes its depth in \p counters if they are set, the configured_sink hands
+/// out \p counters.
+template <typename BackendT>
+sink_maker make_frontend_of(const settings_section& settings, std::function<boost::shared_ptr<BackendT>()> make_backend,
+                            const std::shared_ptr<sink_counters>& counters) {
+    const auto selected_backend = lowercase(settings["Backend"].get().get_value_or("boost"));
+    const auto parsed = parse_filter_and_format<BackendT>(settings);
+
+    if (selected_backend == "lockfree") {
+        if (settings["OverflowPolicy"].get()) {
+            throw EverestConfigError("Sink setting OverflowPolicy requires Asynchronous=true, the lockfree Backend blocks");
+        }
+        auto queue_capacity = default_queue_capacity;
+        if (auto capacity = settings["QueueCapacity"].get()) {
+            queue_capacity = setting_to_size("QueueCapacity", capacity.get());
+        }
+
+        return [make_backend, counters, parsed, queue_capacity]() -> configured_sink {
+            // the wrapped sink is only ever fed by the writer thread, filtering happens on the producer side
+            auto target = boost::make_shared<sinks::synchronous_sink<BackendT>>(make_backend());
+            apply_format<BackendT>(*target, parsed.formatter);
+            auto frontend = boost::make_shared<lockfree_sink>(target, parsed.filter, queue_capacity);
+            frontend->set_counters(counters);
+            return {frontend,
+                    [target, frontend](const settings_section& new_settings) {
+                        return std::function<void()>(
+                            [target, frontend, reparsed = parse_filter_and_format<BackendT>(new_settings)]() {
+                                frontend->set_filter(reparsed.filter);
+                                apply_format<BackendT>(*target, reparsed.formatter);
+                            });
+                    },
+                    counters};
+        };
+    }
+
+    if (selected_backend != "boost") {
+        throw EverestConfigError("Unknown sink Backend \"" + selected_backend + "\", expected boost or lockfree");
+    }
+
+    const auto asynchronous = settings["Asynchronous"].get();
+    if (asynchronous && setting_to_bool("Asynchronous", asynchronous.get())) {
+        const auto policy = overflow_policy_from_settings(settings);
+        return [make_backend, counters, parsed, policy]() -> configured_sink {
+            auto frontend = boost::make_shared<overflow_sink<BackendT>>(make_backend());
+            frontend->set_overflow_policy(policy);
+            frontend->set_counters(counters);
+            apply_filter_and_format<BackendT>(*frontend, parsed);
+            return {frontend,
+                    [frontend](const settings_section& new_settings) {
+                        return std::function<void()>(
+                            [frontend, new_policy = overflow_policy_from_settings(new_settings),
+                             reparsed = parse_filter_and_format<BackendT>(new_settings)]() {
+                                frontend->set_overflow_policy(new_policy);
+                                apply_filter_and_format<BackendT>(*frontend, reparsed);
+                            });
+                    },
+                    counters};
+        };
+    }
+
+    return [make_backend, counters, parsed]() -> configured_sink {
+        auto frontend = boost::make_shared<sinks::synchronous_sink<BackendT>>(make_backend());
+        apply_filter_and_format<BackendT>(*frontend, parsed);
+        return {frontend,
+                [frontend](const settings_section& new_settings) {
+                    return std::function<void()>(
+                        [frontend, reparsed = parse_filter_and_format<BackendT>(new_settings)]() {
+                            apply_filter_and_format<BackendT>(*frontend, reparsed);
+                        });
+                },
+                counters};
+    };
+}
+
+/// Parses the Backend and Asynchronous settings, the returned sink_maker wraps the backend made by \p make_backend
+/// into the selected frontend. With LIBLOG_STATS, the records are counted by a counting_backend in front of it.
+template <typename BackendT>
+sink_maker make_frontend(const settings_section& settings, std::function<boost::shared_ptr<BackendT>()> make_backend) {
+#ifdef LIBLOG_STATS
+    auto counters = std::make_shared<sink_counters>();
+    return make_frontend_of<counting_backend<BackendT>>(
+        settings,
+        [make_backend, counters]() { return boost::make_shared<counting_backend<BackendT>>(make_backend(), counters); },
+        counters);
+#else
+    return make_frontend_of<BackendT>(settings, std::move(make_backend), nullptr);
+#endif
+}
+
+/// The FlushIntervalMs, BufferSize and FlushSeverity settings of an fd_backend, AutoFlush writes every record.
+fd_flush_policy fd_flush_policy_from_settings(const settings_section& settings) {
+    fd_flush_policy policy;
+    if (auto interval = settings["FlushIntervalMs"].get()) {
+        policy.interval = std::chrono::milliseconds(setting_to_size("FlushIntervalMs", interval.get()));
+    }
+    if (auto buffer_size = settings["BufferSize"].get()) {
+        policy.buffer_size = setting_to_size("BufferSize", buffer_size.get());
+    }
+    if (auto severity = settings["FlushSeverity"].get()) {
+        policy.severity = setting_to_severity("FlushSeverity", severity.get());
+    }
+    auto auto_flush = settings["AutoFlush"].get();
+    if (auto_flush && setting_to_bool("AutoFlush", auto_flush.get())) {
+        policy.interval = std::chrono::milliseconds(0);
+    }
+    return policy;
+}
+
+sinks::auto_newline_mode auto_newline_mode_from_settings(const settings_section& settings) {
+    if (auto auto_newline = settings["AutoNewline"].get()) {
+        return setting_to_auto_newline_mode(auto_newline.get());
+    }
+    return sinks::insert_if_missing;
+}
+
+/// Parses the sinks of the Console destination, supporting the settings of Boost.Log plus the liblog ones.
+sink_maker create_console_sink(const settings_section& settings) {
+    const auto auto_newline = auto_newline_mode_from_settings(settings);
+    if (settings["FlushIntervalMs"].get()) {
+        // std::clog writes to stderr without a buffer of its own, nothing is reordered
+        return make_frontend<fd_backend>(settings, [policy = fd_flush_policy_from_settings(settings), auto_newline]() {
+            return boost::make_shared<fd_backend>(STDERR_FILENO, false, policy, auto_newline);
+        });
+    }
+
+    boost::optional<bool> auto_flush;
+    if (auto auto_flush_setting = settings["AutoFlush"].get()) {
+        auto_flush = setting_to_bool("AutoFlush", auto_flush_setting.get());
+    }
+    const auto has_auto_newline = static_cast<bool>(settings["AutoNewline"].get());
+
+    return make_frontend<sinks::text_ostream_backend>(settings, [auto_flush, has_auto_newline, auto_newline]() {
+        auto backend = boost::make_shared<sinks::text_ostream_backend>();
+        backend->add_stream(boost::shared_ptr<std::ostream>(&std::clog, boost::null_deleter()));
+        if (auto_flush) {
+            backend->auto_flush(auto_flush.get());
+        }
+        if (has_auto_newline) {
+            backend->set_auto_newline_mode(auto_newline);
+        }
+        return backend;
+    });
+}
+
+/// Parses the sinks of the File destination, the records are written to FileName through an fd_backend.
+sink_maker create_file_sink(const settings_section& settings) {
+    const auto file_name = settings["FileName"].get();
+    if (!file_name) {
+        throw EverestConfigError("Sink setting FileName is required for the File destination");
+    }
+
+    bool append = false;
+    if (auto append_setting = settings["Append"].get()) {
+        append = setting_to_bool("Append", append_setting.get());
+    }
+    const auto policy = fd_flush_policy_from_settings(settings);
+    const auto auto_newline = auto_newline_mode_from_settings(settings);
+
+    return make_frontend<fd_backend>(settings, [file_name = file_name.get(), append, policy, auto_newline]() {
+        return boost::make_shared<fd_backend>(fd_backend::open_file(file_name, append), true, policy, auto_newline);
+    });
+}
+
+/// Parses the sinks of the MappedFile destination, the records are copied into memory mapped segments of FileName.
+sink_maker create_mapped_file_sink(const settings_section& settings) {
+    const auto file_name = settings["FileName"].get();
+    if (!file_name) {
+        throw EverestConfigError("Sink setting FileName is required for the MappedFile destination");
+    }
+
+    mapped_file_settings mapped;
+    mapped.file_name = file_name.get();
+    if (auto segment_size = settings["SegmentSize"].get()) {
+        mapped.segment_size = setting_to_size("SegmentSize", segment_size.get());
+    }
+    if (auto max_files = settings["MaxFiles"].get()) {
+        mapped.max_files = setting_to_size("MaxFiles", max_files.get());
+    }
+    if (auto max_total_size = settings["MaxTotalSize"].get()) {
+        mapped.max_total_size = setting_to_size("MaxTotalSize", max_total_size.get());
+    }
+    if (auto compress = settings["Compress"].get(); compress && setting_to_bool("Compress", compress.get())) {
+        mapped.codec = built_in_codec();
+        if (mapped.codec == nullptr) {
+            throw EverestConfigError("Sink setting Compress requires liblog to be built with LIBLOG_COMPRESSION");
+        }
+    }
+    if (auto compression_threads = settings["CompressionThreads"].get()) {
+        mapped.compression_threads = setting_to_size("CompressionThreads", compression_threads.get());
+    }
+
+    return make_frontend<mapped_file_backend>(
+        settings, [mapped, auto_newline = auto_newline_mode_from_settings(settings)]() {
+            return boost::make_shared<mapped_file_backend>(mapped, auto_newline);
+        });
+}
+
+/// Parses the sinks of the BinaryFile destination, the records are written in the binary log format.
+sink_maker create_binary_file_sink(const settings_section& settings) {
+    const auto file_name = settings["FileName"].get();
+    if (!file_name) {
+        throw EverestConfigError("Sink setting FileName is required for the BinaryFile destination");
+    }
+
+    bool append = false;
+    if (auto append_setting = settings["Append"].get()) {
+        append = setting_to_bool("Append", append_setting.get());
+    }
+    bool auto_flush = false;
+    if (auto auto_flush_setting = settings["AutoFlush"].get()) {
+        auto_flush = setting_to_bool("AutoFlush", auto_flush_setting.get());
+    }
+
+    return make_frontend<binary_file_backend>(settings, [file_name = file_name.get(), append, auto_flush]() {
+        return boost::make_shared<binary_file_backend>(file_name, append, auto_flush);
+    });
+}
+
+/// Parses the sinks of the SharedMemory destination, the records are collected by everest_log_aggregator.
+sink_maker create_shm_sink(const settings_section& settings) {
+    const auto segment = settings["Segment"].get().get_value_or(default_shm_segment);
+    auto ring_size = default_shm_ring_size;
+    if (auto ring_size_setting = settings["RingSize"].get()) {
+        ring_size = setting_to_size("RingSize", ring_size_setting.get());
+    }
+
+    return make_frontend<shm_backend>(settings, [segment, ring_size]() {
+        return boost::make_shared<shm_backend>(segment, ring_size);
+    });
+}
+
+/// parses a sink section, throws EverestConfigError if it's invalid
+using sink_creator = sink_maker (*)(const settings_section&);
+
+/// the destinations liblog implements itself
+const std::map<std::string, sink_creator>& sink_creators() {
+    static const std::map<std::string, sink_creator> creators = {
+        {"Console", &create_console_sink},
+        {"File", &create_file_sink},
+        {"MappedFile", &create_mapped_file_sink},
+        {"BinaryFile", &create_binary_file_sink},
+        {"SharedMemory", &create_shm_sink},
+    };
+    return creators;
+}
+
+/// Boost.Log sink factory for a liblog destination, used by code that calls init_from_settings() itself.
+class liblog_sink_factory : public logging::sink_factory<char> {
+public:
+    explicit liblog_sink_factory(sink_creator creator) : creator(creator) {
+    }
+
+    boost::shared_ptr<sinks::sink> create_sink(const settings_section& settings) override {
+        return creator(settings)().sink;
+    }
+
+private:
+    const sink_creator creator;
+};
+
+/// The settings of a sink section that can't be changed without recreating the sink.
+///
+/// The SeverityStringColor* settings aren't among them, set_severity_colors() applies them to all sinks.
+std::string fixed_settings(const settings_section& section) {
+    static const std::string color_prefix = "SeverityStringColor";
+
+    std::string fixed;
+    for (const auto& setting : section.property_tree()) {
+        if (setting.first != "Filter" && setting.first != "Format" &&
+            setting.first.compare(0, color_prefix.size(), color_prefix) != 0) {
+            fixed += setting.first + "=" + setting.second.data() + "\n";
+        }
+    }
+    return fixed;
+}
+
+/// the file a sink of \p section writes and truncates unless Append is set, empty for other destinations
+std::string appendable_file(const settings_section& section) {
+    const auto destination = section["Destination"].get();
+    const auto file_name = section["FileName"].get();
+    if (!destination || !file_name || (destination.get() != "File" && destination.get() != "BinaryFile")) {
+        return {};
+    }
+    return destination.get() + ":" + file_name.get();
+}
+
+/// the liblog destination of \p section, nullptr for destinations Boost.Log implements
+sink_creator find_sink_creator(const settings_section& section) {
+    const auto destination = section["Destination"].get();
+    if (!destination) {
+        return nullptr;
+    }
+    const auto creator = sink_creators().find(destination.get());
+    return creator != sink_creators().end() ? creator->second : nullptr;
+}
+} // namespace
+
+bool setting_to_bool(const std::string& name, const std::string& value) {
+    const auto lowered = lowercase(value);
+    if (lowered == "true" || lowered == "yes" || lowered == "on" || lowered == "1") {
+        return true;
+    }
+    if (lowered == "false" || lowered == "no" || lowered == "off" || lowered == "0") {
+        return false;
+    }
+    throw EverestConfigError("Invalid value \"" + value + "\" for setting " + name + ", expected a boolean");
+}
+
+std::size_t setting_to_size(const std::string& name, const std::string& value) {
+    try {
+        std::size_t parsed_length = 0;
+        const auto parsed = std::stoull(value, &parsed_length);
+        if (parsed_length == value.size() && parsed > 0) {
+            return static_cast<std::size_t>(parsed);
+        }
+    } catch (const std::exception&) {
+        // reported below
+    }
+    throw EverestConfigError("Invalid value \"" + value + "\" for setting " + name + ", expected a positive number");
+}
+
+severity_level setting_to_severity(const std::string& name, const std::string& value) {
+    std::istringstream strm(value);
+    severity_level level = verbose;
+    if (!(strm >> level) || !strm.eof()) {
+        throw EverestConfigError("Invalid value \"" + value + "\" for setting " + name + ", expected a severity");
+    }
+    return level;
+}
+
+void prepare_sink_settings(logging::settings& settings) {
+    auto sink_sections = settings.property_tree().get_child_optional("Sinks");
+    if (!sink_sections) {
+        return;
+    }
+
+    const auto exclude_recorded = flight_recorder::enabled(settings);
+    for (auto& sink_section : sink_sections.get()) {
+        if (auto format = sink_section.second.get_optional<std::string>("Format")) {
+            sink_section.second.put("Format", rewrite_format_placeholders(format.get()));
+        }
+        if (exclude_recorded) {
+            // records the flight recorder lets pass the core filter are only meant for the recorder
+            const auto filter = sink_section.second.get_optional<std::string>("Filter");
+            sink_section.second.put("Filter", filter ? "(" + filter.get() + ") and not %" +
+                                                           flight_recorder::marker_name().string() + "%"
+                                                     : "not %" + flight_recorder::marker_name().string() + "%");
+        }
+    }
+}
+
+std::string rewrite_format_placeholders(std::string format) {
+    static const std::string message_placeholder = "%Message%";
+    static const std::string formatted_message_placeholder = "%FormattedMessage%";
+
+    for (auto position = format.find(message_placeholder); position != std::string::npos;
+         position = format.find(message_placeholder, position + formatted_message_placeholder.size())) {
+        format.replace(position, message_placeholder.size(), formatted_message_placeholder);
+    }
+    return format;
+}
+
+void register_sink_factories() {
+    for (const auto& creator : sink_creators()) {
+        logging::register_sink_factory(creator.first, boost::make_shared<liblog_sink_factory>(creator.second));
+    }
+}
+
+replaceable_sink::replaceable_sink(boost::shared_ptr<sinks::sink> target) :
+    sinks::sink(true), target(std::move(target)) {
+}
+
+boost::shared_ptr<sinks::sink> replaceable_sink::replace(boost::shared_ptr<sinks::sink> new_target) {
+    std::lock_guard<std::shared_mutex> lock(mutex);
+    target.swap(new_target);
+    return new_target;
+}
+
+bool replaceable_sink::will_consume(const logging::attribute_value_set& attributes) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return target->will_consume(attributes);
+}
+
+void replaceable_sink::consume(const logging::record_view& rec) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    target->consume(rec);
+}
+
+bool replaceable_sink::try_consume(const logging::record_view& rec) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return target->try_consume(rec);
+}
+
+void replaceable_sink::flush() {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    target->flush();
+}
+
+configured_sinks& configured_sinks::instance() {
+    static configured_sinks instance;
+    return instance;
+}
+
+void configured_sinks::setup(logging::settings& settings) {
+    std::map<std::string, entry> created;
+    if (settings.has_section("Sinks")) {
+        const auto sink_sections = settings["Sinks"].get_section();
+        for (auto it = sink_sections.begin(); it != sink_sections.end(); ++it) {
+            if (auto creator = find_sink_creator(*it)) {
+                auto sink = creator(*it)();
+                auto core_sink = boost::make_shared<replaceable_sink>(sink.sink);
+                created[it.get_name()] = entry{fixed_settings(*it), appendable_file(*it), std::move(sink), core_sink};
+            }
+        }
+        // the remaining sections are left to init_from_settings()
+        for (const auto& section : created) {
+            settings.property_tree().get_child("Sinks").erase(section.first);
+            if (section.second.sink.counters) {
+                register_sink_counters(section.first, section.second.sink.counters);
+            }
+        }
+    }
+
+    auto core = logging::core::get();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& old : sinks) {
+        core->remove_sink(old.second.core_sink);
+        old.second.sink.sink->flush();
+    }
+    sinks = std::move(created);
+    for (const auto& added : sinks) {
+        core->add_sink(added.second.core_sink);
+    }
+}
+
+std::function<void()> configured_sinks::prepare_reload(const logging::settings& settings) {
+    // the sections are only parsed here, new sinks create their files and segments when the reload is committed
+    struct created_sink {
+        std::string fixed;
+        std::string file;
+        sink_maker make;
+    };
+    std::map<std::string, entry> kept;
+    std::map<std::string, created_sink> created;
+    std::vector<std::function<void()>> reconfigure;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (settings.has_section("Sinks")) {
+        const auto sink_sections = settings["Sinks"].get_section();
+        for (auto it = sink_sections.begin(); it != sink_sections.end(); ++it) {
+            auto creator = find_sink_creator(*it);
+            if (creator == nullptr) {
+                continue;
+            }
+            const auto fixed = fixed_settings(*it);
+            const auto existing = sinks.find(it.get_name());
+            const auto file = appendable_file(*it);
+            if (existing != sinks.end() && existing->second.fixed == fixed) {
+                reconfigure.push_back(existing->second.sink.prepare_reconfigure(*it));
+                kept[it.get_name()] = existing->second;
+            } else if (existing != sinks.end() && !file.empty() && existing->second.file == file) {
+                // the replaced sink is still writing the file, truncating it would lose what was written so far
+                logging::settings appending;
+                appending.property_tree() = it->property_tree();
+                appending["Append"] = "true";
+                created[it.get_name()] = created_sink{fixed, file, creator(appending)};
+            } else {
+                created[it.get_name()] = created_sink{fixed, file, creator(*it)};
+            }
+        }
+    }
+
+    return [this, kept, created, reconfigure]() {
+        // creating a sink might still fail, e.g. if its file can't be opened, before the first sink changes
+        std::map<std::string, configured_sink> made;
+        for (const auto& section : created) {
+            made[section.first] = section.second.make();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto reloaded = kept;
+        for (const auto& section : kept) {
+            if (section.second.sink.counters) {
+                register_sink_counters(section.first, section.second.sink.counters);
+            }
+        }
+        for (const auto& section : made) {
+            if (section.second.counters) {
+                register_sink_counters(section.first, section.second.counters);
+            }
+        }
+        for (const auto& apply : reconfigure) {
+            apply();
+        }
+        // a recreated sink replaces the target of the core sink of its section, so no record reaches both or neither
+        auto core = logging::core::get();
+        for (const auto& section : made) {
+            const auto& settings = created.at(section.first);
+            const auto existing = sinks.find(section.first);
+            if (existing != sinks.end()) {
+                reloaded[section.first] =
+                    entry{settings.fixed, settings.file, section.second, existing->second.core_sink};
+                existing->second.core_sink->replace(section.second.sink)->flush();
+            } else {
+                reloaded[section.first] = entry{settings.fixed, settings.file, section.second,
+                                                boost::make_shared<replaceable_sink>(section.second.sink)};
+                core->add_sink(reloaded[section.first].core_sink);
+            }
+        }
+        for (const auto& old : sinks) {
+            if (reloaded.find(old.first) == reloaded.end()) {
+                core->remove_sink(old.second.core_sink);
+                old.second.sink.sink->flush();
+            }
+        }
+        sinks = std::move(reloaded);
+    };
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef SINKS_HPP
+#define SINKS_HPP
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+#include <boost/log/sinks/sink.hpp>
+#include <boost/log/utility/setup/settings.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <everest/logging.hpp>
+
+#include "stats_counters.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief registers the sink factories for all destinations liblog implements itself
+///
+/// Sinks of these destinations understand some additional settings on top of the ones Boost.Log knows:
+///  - Backend: "boost" (default) uses the frontends of Boost.Log, "lockfree" the lockfree_sink frontend
+///  - QueueCapacity: records every thread can have in flight in a lockfree_sink, defaults to 1024; records queued at
+///    most by a sink with Asynchronous=true, which is unbounded by default
+///
+/// The queue of a sink with Asynchronous=true is an overflow_queue:
+///  - OverflowPolicy: Block, DropNewest, DropOldest or DropBelowSeverity, bounds the queue to 1024 records by default
+///  - OverflowSeverity: records below it are dropped by DropBelowSeverity, INFO by default
+///  - DropReportIntervalMs: a warning reports the dropped records at most this often, 1000 by default
+///
+/// A Console sink with a FlushIntervalMs setting writes to stderr through an fd_backend, like the File destination
+/// does to FileName (truncated unless Append is true):
+///  - FlushIntervalMs: longest time in milliseconds a record stays buffered, 20 for File sinks by default
+///  - BufferSize: bytes buffered at most, 65536 by default
+///  - FlushSeverity: records of this severity or above are written right away, ERRO by default
+///  - AutoFlush: true writes every record right away
+///
+/// The MappedFile destination copies the records into memory mapped segments "<FileName>.<index>" of SegmentSize bytes
+/// (16 MiB by default), see mapped_file_backend. MaxFiles and MaxTotalSize (in bytes) limit the segments that are kept.
+/// Compress=true compresses complete segments in the background with the codec selected by LIBLOG_COMPRESSION, at most
+/// CompressionThreads (1 by default) at the same time.
+///
+/// The BinaryFile destination writes the binary log format of binary_log_encoder to FileName, truncating the file
+/// unless Append is true. Its records are not formatted, the Format setting is only used by everest_log_decode.
+///
+/// The SharedMemory destination hands the records to everest_log_aggregator through a ring of RingSize bytes (1 MiB by
+/// default) in the shared memory segment "/<Segment>.<pid>", Segment defaults to "everest_log".
+void register_sink_factories();
+
+///
+/// \brief A sink created by liblog for one of its destinations, together with the way to apply changed settings
+struct configured_sink {
+    boost::shared_ptr<logging::sinks::sink> sink;
+    /// parses the Filter and Format settings of the given section, the returned function applies them to sink
+    std::function<std::function<void()>(const logging::settings_section&)> prepare_reconfigure;
+    /// the counters of the sink with LIBLOG_STATS, nullptr otherwise
+    std::shared_ptr<sink_counters> counters;
+};
+
+///
+/// \brief Sink the core keeps for a configured section, its target sink can be replaced in one step
+///
+/// Every record the core hands over reaches either the replaced target or the new one, never both. A record passing
+/// the filter of the replaced target right before the replacement is written by the new one. It's cross-thread, since
+/// a target replacing a synchronous one might be asynchronous.
+class replaceable_sink : public logging::sinks::sink {
+public:
+    explicit replaceable_sink(boost::shared_ptr<logging::sinks::sink> target);
+
+    /// \brief makes \p new_target the target, returns the replaced one, which none of the records consumes anymore
+    boost::shared_ptr<logging::sinks::sink> replace(boost::shared_ptr<logging::sinks::sink> new_target);
+
+    bool will_consume(const logging::attribute_value_set& attributes) override;
+    void consume(const logging::record_view& rec) override;
+    bool try_consume(const logging::record_view& rec) override;
+    void flush() override;
+
+private:
+    /// held shared while the target is used, so the replaced one is done with its records when replace() returns
+    std::shared_mutex mutex;
+    boost::shared_ptr<logging::sinks::sink> target;
+};
+
+/// \brief creates a sink parsed from its section, this opens its files or shared memory segments
+using sink_maker = std::function<configured_sink()>;
+
+///
+/// \brief The sinks liblog created from [Sinks.*] sections of its own destinations
+///
+/// Boost.Log doesn't hand out the sinks init_from_settings() creates, so liblog creates the sinks of its destinations
+/// itself to be able to apply changed settings later. Sinks of other destinations keep their initial settings.
+class configured_sinks {
+public:
+    static configured_sinks& instance();
+
+    /// \brief replaces the sinks created before by the ones configured in \p settings
+    ///
+    /// The sections of the created sinks are removed from \p settings, the remaining ones are left to
+    /// init_from_settings().
+    void setup(logging::settings& settings);
+
+    /// \brief parses \p settings, the returned function applies them to the sinks created before
+    ///
+    /// Sinks whose settings only differ in Filter, Format and SeverityStringColor* are updated in place, others are
+    /// recreated. A recreated sink takes over from the one it replaces in one step, every record is written by one of
+    /// them, and a recreated File or BinaryFile sink appends to the file of the sink it replaces if the FileName stayed
+    /// the same. Sinks of sections that were added or removed are added or removed.
+    ///
+    /// Nothing changes until the returned function is called, throws EverestConfigError if a section is invalid. The
+    /// returned function creates the new sinks first, if that throws all sinks are kept unchanged.
+    std::function<void()> prepare_reload(const logging::settings& settings);
+
+private:
+    struct entry {
+        std::string fixed; ///< the settings of the section other than Filter, Format and the colors
+        std::string file;  ///< the file a File or BinaryFile sink writes, a sink replacing it appends to it
+        configured_sink sink;
+        /// the sink added to the core, its target is sink.sink
+        boost::shared_ptr<replaceable_sink> core_sink;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, entry> sinks;
+};
+
+///
+/// \brief prepares the Sinks sections of \p settings for Boost.Log and liblog sink factories
+///
+/// The Format settings are rewritten with rewrite_format_placeholders(). If a flight_recorder is configured, the Filter
+/// settings are extended to skip the records that are only meant for the recorder.
+void prepare_sink_settings(logging::settings& settings);
+
+///
+/// \brief replaces placeholders Boost.Log interprets itself by their liblog counterpart
+///
+/// Boost.Log binds %Message% to plain text messages directly, bypassing registered formatter factories. Deferred
+/// messages render there as well, through the text cached by their attribute value, %FormattedMessage% renders them
+/// without the copy.
+std::string rewrite_format_placeholders(std::string format);
+
+/// \brief interprets a boolean setting the same way Boost.Log does, throws EverestConfigError on invalid values
+bool setting_to_bool(const std::string& name, const std::string& value);
+
+/// \brief interprets a setting that has to be a positive number, throws EverestConfigError on invalid values
+std::size_t setting_to_size(const std::string& name, const std::string& value);
+
+/// \brief interprets a setting naming a severity (VERB, DEBG, INFO, ...), throws EverestConfigError on invalid values
+severity_level setting_to_severity(const std::string& name, const std::string& value);
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // SINKS_HPP
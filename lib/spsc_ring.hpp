@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Everest {
+namespace Logging {
+
+///
+/// \brief Bounded, wait-free single producer / single consumer ring buffer
+///
+/// One thread may call try_push(), another one front(), pop() and empty(). The capacity is rounded up to the next
+/// power of two.
+template <typename T> class spsc_ring {
+public:
+    explicit spsc_ring(std::size_t capacity) : slots(round_up_to_power_of_two(capacity)), mask(slots.size() - 1) {
+    }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    /// \brief producer side, moves \p value into the ring, fails if the ring is full
+    bool try_push(T&& value) {
+        const auto current_tail = tail.load(std::memory_order_relaxed);
+        if (current_tail - cached_head > mask) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (current_tail - cached_head > mask) {
+                return false;
+            }
+        }
+        slots[current_tail & mask] = std::move(value);
+        tail.store(current_tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// \brief consumer side, oldest element or nullptr if the ring is empty
+    T* front() {
+        const auto current_head = head.load(std::memory_order_relaxed);
+        if (current_head == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (current_head == cached_tail) {
+                return nullptr;
+            }
+        }
+        return &slots[current_head & mask];
+    }
+
+    /// \brief consumer side, releases the element returned by front()
+    void pop() {
+        const auto current_head = head.load(std::memory_order_relaxed);
+        slots[current_head & mask] = T();
+        head.store(current_head + 1, std::memory_order_release);
+    }
+
+    /// \brief approximate number of queued elements, exact if called by the consumer while the producer is idle
+    std::size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const {
+        return slots.size();
+    }
+
+private:
+    static std::size_t round_up_to_power_of_two(std::size_t value) {
+        std::size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    static constexpr std::size_t cache_line_size = 64;
+
+    std::vector<T> slots;
+    const std::size_t mask;
+
+    // consumer owned
+    alignas(cache_line_size) std::atomic<std::size_t> head{0};
+    std::size_t cached_tail{0};
+
+    // producer owned
+    alignas(cache_line_size) std::atomic<std::size_t> tail{0};
+    std::size_t cached_head{0};
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // SPSC_RING_HPP
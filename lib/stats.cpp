@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "stats_counters.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "sinks.hpp"
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+constexpr std::size_t sub_bucket_bits = 3;
+constexpr std::size_t sub_buckets = std::size_t{1} << sub_bucket_bits;
+
+std::uint64_t to_nanoseconds(std::chrono::steady_clock::duration latency) {
+    const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+    return nanoseconds > 0 ? static_cast<std::uint64_t>(nanoseconds) : 0;
+}
+
+/// adds 1 to a counter only its own thread writes, without the cost of a locked instruction
+void bump(std::atomic<std::uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/// the counters of the EVLOG_* statements of one thread
+struct thread_counters {
+    std::array<std::atomic<std::uint64_t>, critical + 1> emitted{};
+    std::array<std::atomic<std::uint64_t>, critical + 1> filtered{};
+    std::array<std::atomic<std::uint64_t>, latency_histogram::bucket_count> call_latency{};
+};
+
+struct totals {
+    std::array<std::uint64_t, critical + 1> emitted{};
+    std::array<std::uint64_t, critical + 1> filtered{};
+    latency_histogram call_latency;
+
+    void add(const thread_counters& counters) {
+        for (std::size_t level = 0; level <= critical; ++level) {
+            emitted[level] += counters.emitted[level].load(std::memory_order_relaxed);
+            filtered[level] += counters.filtered[level].load(std::memory_order_relaxed);
+        }
+        for (std::size_t bucket = 0; bucket < latency_histogram::bucket_count; ++bucket) {
+            call_latency.counts[bucket] += counters.call_latency[bucket].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+struct registry {
+    std::mutex mutex;
+    std::vector<const thread_counters*> threads;
+    /// the counters of threads that exited
+    totals retired;
+    std::vector<std::pair<std::string, std::weak_ptr<sink_counters>>> sinks;
+};
+
+/// never destroyed, threads might exit after static destructors ran
+registry& stats_registry() {
+    static auto* instance = new registry;
+    return *instance;
+}
+
+/// registers the counters of its thread while the thread lives
+struct thread_slot {
+    thread_slot() {
+        auto& shared = stats_registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.threads.push_back(&counters);
+    }
+    ~thread_slot() {
+        auto& shared = stats_registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.retired.add(counters);
+        shared.threads.erase(std::remove(shared.threads.begin(), shared.threads.end(), &counters),
+                             shared.threads.end());
+    }
+
+    thread_counters counters;
+};
+
+std::unique_ptr<stats_reporter> running_reporter;
+std::mutex reporter_mutex;
+} // namespace
+
+std::size_t latency_histogram::bucket_of(std::uint64_t nanoseconds) {
+    if (nanoseconds < sub_buckets) {
+        return static_cast<std::size_t>(nanoseconds);
+    }
+    const auto exponent = static_cast<std::size_t>(63 - __builtin_clzll(nanoseconds));
+    const auto sub_bucket = static_cast<std::size_t>(nanoseconds >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+    return std::min((exponent - sub_bucket_bits + 1) * sub_buckets + sub_bucket, bucket_count - 1);
+}
+
+std::uint64_t latency_histogram::bucket_upper_bound(std::size_t bucket) {
+    if (bucket < sub_buckets) {
+        return bucket;
+    }
+    const auto shift = bucket / sub_buckets - 1;
+    const auto lower = static_cast<std::uint64_t>(sub_buckets + bucket % sub_buckets) << shift;
+    return lower + (std::uint64_t{1} << shift) - 1;
+}
+
+void latency_histogram::add(std::uint64_t nanoseconds, std::uint64_t count) {
+    counts[bucket_of(nanoseconds)] += count;
+}
+
+void latency_histogram::merge(const latency_histogram& other) {
+    for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        counts[bucket] += other.counts[bucket];
+    }
+}
+
+std::uint64_t latency_histogram::count() const {
+    std::uint64_t total = 0;
+    for (const auto bucket_count : counts) {
+        total += bucket_count;
+    }
+    return total;
+}
+
+std::chrono::nanoseconds latency_histogram::quantile(double quantile) const {
+    const auto total = count();
+    if (total == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::clamp(quantile, 0.0, 1.0) * total));
+    std::uint64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return std::chrono::nanoseconds(bucket_upper_bound(bucket));
+        }
+    }
+    return std::chrono::nanoseconds(bucket_upper_bound(bucket_count - 1));
+}
+
+void sink_counters::count_record(std::size_t written, std::chrono::steady_clock::duration latency) {
+    records.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(written, std::memory_order_relaxed);
+    write_latency[latency_histogram::bucket_of(to_nanoseconds(latency))].fetch_add(1, std::memory_order_relaxed);
+}
+
+void sink_counters::note_queue_depth(std::size_t depth) {
+    auto high_water = queue_high_water.load(std::memory_order_relaxed);
+    while (depth > high_water &&
+           !queue_high_water.compare_exchange_weak(high_water, depth, std::memory_order_relaxed)) {
+    }
+}
+
+logging_stats::sink_counts sink_counters::snapshot(const std::string& name) const {
+    logging_stats::sink_counts counts;
+    counts.name = name;
+    counts.records = records.load(std::memory_order_relaxed);
+    counts.bytes = bytes.load(std::memory_order_relaxed);
+    counts.queue_high_water = queue_high_water.load(std::memory_order_relaxed);
+    for (std::size_t bucket = 0; bucket < latency_histogram::bucket_count; ++bucket) {
+        counts.write_latency.counts[bucket] = write_latency[bucket].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+void register_sink_counters(const std::string& name, const std::shared_ptr<sink_counters>& counters) {
+    auto& shared = stats_registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.sinks.erase(std::remove_if(shared.sinks.begin(), shared.sinks.end(),
+                                      [&name](const auto& sink) { return sink.first == name || sink.second.expired(); }),
+                       shared.sinks.end());
+    shared.sinks.emplace_back(name, counters);
+}
+
+namespace detail {
+void count_call(severity_level level, bool emitted, std::chrono::steady_clock::duration latency) {
+    thread_local thread_slot slot;
+    if (level < verbose || level > critical) {
+        return;
+    }
+    if (!emitted) {
+        bump(slot.counters.filtered[level]);
+        return;
+    }
+    bump(slot.counters.emitted[level]);
+    bump(slot.counters.call_latency[latency_histogram::bucket_of(to_nanoseconds(latency))]);
+}
+} // namespace detail
+
+logging_stats stats() {
+    logging_stats result;
+#ifdef LIBLOG_STATS
+    result.enabled = true;
+    auto& shared = stats_registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    auto merged = shared.retired;
+    for (const auto* counters : shared.threads) {
+        merged.add(*counters);
+    }
+    for (std::size_t level = 0; level <= critical; ++level) {
+        result.severities[level].emitted = merged.emitted[level];
+        result.severities[level].filtered = merged.filtered[level];
+        result.severities[level].dropped = dropped_records(static_cast<severity_level>(level));
+    }
+    result.call_latency = merged.call_latency;
+    for (const auto& sink : shared.sinks) {
+        if (const auto counters = sink.second.lock()) {
+            result.sinks.push_back(counters->snapshot(sink.first));
+        }
+    }
+#endif
+    return result;
+}
+
+std::string to_string(const logging_stats& stats) {
+    if (!stats.enabled) {
+        return "Logging stats are not available, liblog was built without LIBLOG_STATS";
+    }
+    logging_stats::severity_counts total;
+    for (const auto& counts : stats.severities) {
+        total.emitted += counts.emitted;
+        total.filtered += counts.filtered;
+        total.dropped += counts.dropped;
+    }
+    std::ostringstream summary;
+    summary << "Logging stats: " << total.emitted << " records emitted, " << total.filtered << " filtered, "
+            << total.dropped << " dropped; call latency p50 " << stats.call_latency.quantile(0.5).count() << "ns p99 "
+            << stats.call_latency.quantile(0.99).count() << "ns";
+    for (const auto& sink : stats.sinks) {
+        summary << "; sink " << sink.name << ": " << sink.records << " records, " << sink.bytes
+                << " bytes, write p99 " << sink.write_latency.quantile(0.99).count() << "ns";
+        if (sink.queue_high_water != 0) {
+            summary << ", queue high water " << sink.queue_high_water;
+        }
+    }
+    return summary.str();
+}
+
+stats_reporter::stats_reporter(std::chrono::milliseconds interval) : interval(interval) {
+    reporter = std::thread(&stats_reporter::run, this);
+}
+
+stats_reporter::~stats_reporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stop_requested.notify_one();
+    reporter.join();
+}
+
+void stats_reporter::setup(const logging::settings& settings) {
+    std::unique_ptr<stats_reporter> reporter;
+    if (auto interval = settings["Stats.ReportIntervalMs"].get()) {
+#ifdef LIBLOG_STATS
+        reporter = std::make_unique<stats_reporter>(
+            std::chrono::milliseconds(setting_to_size("ReportIntervalMs", interval.get())));
+#else
+        EVLOG_warning << "Ignoring the [Stats] section, liblog was built without LIBLOG_STATS";
+#endif
+    }
+    // the previous reporter is stopped outside of the lock, it might be reporting right now
+    std::unique_ptr<stats_reporter> previous;
+    {
+        std::lock_guard<std::mutex> lock(reporter_mutex);
+        previous = std::move(running_reporter);
+        running_reporter = std::move(reporter);
+    }
+}
+
+void stats_reporter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop_requested.wait_for(lock, interval, [this] { return stopping; })) {
+        lock.unlock();
+        EVLOG_info << to_string(stats());
+        lock.lock();
+    }
+}
+
+} // namespace Logging
+} // namespace Everest
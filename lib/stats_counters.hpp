@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef STATS_COUNTERS_HPP
+#define STATS_COUNTERS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/utility/setup/settings.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <everest/stats.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+///
+/// \brief Counters of one sink, updated by the thread writing its records
+class sink_counters {
+public:
+    void count_record(std::size_t bytes, std::chrono::steady_clock::duration latency);
+    void note_queue_depth(std::size_t depth);
+    logging_stats::sink_counts snapshot(const std::string& name) const;
+
+private:
+    std::atomic<std::uint64_t> records{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::size_t> queue_high_water{0};
+    std::array<std::atomic<std::uint64_t>, latency_histogram::bucket_count> write_latency{};
+};
+
+/// \brief makes \p counters part of stats() under \p name as long as they exist, replaces earlier ones of that name
+void register_sink_counters(const std::string& name, const std::shared_ptr<sink_counters>& counters);
+
+///
+/// \brief Backend wrapper counting the records and bytes handed to \p BackendT and the time it takes to write them
+///
+/// The frontend requirements are the ones of the wrapped backend, so a frontend formats the records for it as before.
+template <typename BackendT>
+class counting_backend : public logging::sinks::basic_sink_backend<typename BackendT::frontend_requirements> {
+public:
+    using char_type = char;
+    using string_type = std::string;
+
+    counting_backend(boost::shared_ptr<BackendT> backend, std::shared_ptr<sink_counters> counters) :
+        backend(std::move(backend)), counters(std::move(counters)) {
+    }
+
+    void consume(const logging::record_view& rec, const string_type& formatted) {
+        const auto started = std::chrono::steady_clock::now();
+        backend->consume(rec, formatted);
+        counters->count_record(formatted.size(), std::chrono::steady_clock::now() - started);
+    }
+
+    void consume(const logging::record_view& rec) {
+        const auto started = std::chrono::steady_clock::now();
+        backend->consume(rec);
+        counters->count_record(0, std::chrono::steady_clock::now() - started);
+    }
+
+    void flush() {
+        backend->flush();
+    }
+
+private:
+    const boost::shared_ptr<BackendT> backend;
+    const std::shared_ptr<sink_counters> counters;
+};
+
+///
+/// \brief Writes the one line summary of stats() as an INFO record every ReportIntervalMs of the [Stats] section
+class stats_reporter {
+public:
+    explicit stats_reporter(std::chrono::milliseconds interval);
+    ~stats_reporter();
+    stats_reporter(const stats_reporter&) = delete;
+    stats_reporter& operator=(const stats_reporter&) = delete;
+
+    /// \brief replaces the running reporter by the one configured in \p settings, if any
+    ///
+    /// Throws EverestConfigError if ReportIntervalMs isn't a positive number, the running reporter is kept then.
+    static void setup(const logging::settings& settings);
+
+private:
+    void run();
+
+    const std::chrono::milliseconds interval;
+    std::mutex mutex;
+    std::condition_variable stop_requested;
+    bool stopping{false};
+    std::thread reporter;
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // STATS_COUNTERS_HPP
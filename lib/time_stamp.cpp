@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "time_stamp.hpp"
+
+#include <atomic>
+#include <ctime>
+#include <limits>
+
+#include <boost/log/attributes/attribute_value_impl.hpp>
+#include <boost/log/attributes/value_visitation.hpp>
+#include <boost/log/support/date_time.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/mpl/vector.hpp>
+
+#include <everest/exceptions.hpp>
+#include <everest/record_stream.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+namespace posix_time = boost::posix_time;
+
+using ptime_formatter =
+    logging::expressions::aux::date_time_formatter_generator_traits<posix_time::ptime, char>::formatter_function_type;
+
+constexpr std::int64_t nanoseconds_per_second = 1000000000;
+/// length of "YYYY-MM-DD HH:MM:SS."
+constexpr std::size_t prefix_length = 20;
+
+std::atomic<time_stamp_precision> current_precision{time_stamp_precision::microseconds};
+
+const posix_time::ptime& epoch() {
+    static const posix_time::ptime value(boost::gregorian::date(1970, 1, 1));
+    return value;
+}
+
+/// the default format of Boost.Log for ptime values
+const ptime_formatter& default_ptime_formatter() {
+    static const auto formatter =
+        logging::expressions::aux::date_time_formatter_generator_traits<posix_time::ptime, char>::parse(
+            "%Y-%m-%d %H:%M:%S.%f");
+    return formatter;
+}
+
+void put_digits(char* out, std::int64_t value, int digits) {
+    for (int i = digits - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+/// renders "YYYY-MM-DD HH:MM:SS." of \p second into \p out
+void render_prefix(std::int64_t second, char* out) {
+    const auto time = static_cast<std::time_t>(second);
+    std::tm broken_down{};
+    ::gmtime_r(&time, &broken_down);
+    put_digits(out, broken_down.tm_year + 1900, 4);
+    out[4] = '-';
+    put_digits(out + 5, broken_down.tm_mon + 1, 2);
+    out[7] = '-';
+    put_digits(out + 8, broken_down.tm_mday, 2);
+    out[10] = ' ';
+    put_digits(out + 11, broken_down.tm_hour, 2);
+    out[13] = ':';
+    put_digits(out + 14, broken_down.tm_min, 2);
+    out[16] = ':';
+    put_digits(out + 17, broken_down.tm_sec, 2);
+    out[19] = '.';
+}
+
+void write_value(const time_stamp& value, logging::formatting_ostream& strm) {
+    write_time_stamp(value, strm);
+}
+
+void write_value(const posix_time::ptime& value, logging::formatting_ostream& strm) {
+    default_ptime_formatter()(strm, value);
+}
+
+/// Formatter of %TimeStamp% without arguments.
+class default_formatter {
+public:
+    explicit default_formatter(const logging::attribute_name& name) : name(name) {
+    }
+
+    void operator()(const logging::record_view& rec, logging::formatting_ostream& strm) const {
+        using types = boost::mpl::vector<time_stamp, posix_time::ptime>;
+        logging::visit<types>(name, rec, [&strm](const auto& value) { write_value(value, strm); });
+    }
+
+private:
+    logging::attribute_name name;
+};
+
+/// Formatter of %TimeStamp(format="...")%, time_stamp values are converted to ptime.
+class custom_formatter {
+public:
+    custom_formatter(const logging::attribute_name& name, ptime_formatter formatter) :
+        name(name), formatter(std::move(formatter)) {
+    }
+
+    void operator()(const logging::record_view& rec, logging::formatting_ostream& strm) const {
+        using types = boost::mpl::vector<time_stamp, posix_time::ptime>;
+        logging::visit<types>(name, rec, [this, &strm](const auto& value) { write_value(value, strm); });
+    }
+
+private:
+    void write_value(const time_stamp& value, logging::formatting_ostream& strm) const {
+        formatter(strm, to_ptime(value));
+    }
+
+    void write_value(const posix_time::ptime& value, logging::formatting_ostream& strm) const {
+        formatter(strm, value);
+    }
+
+    logging::attribute_name name;
+    ptime_formatter formatter;
+};
+
+class time_stamp_formatter_factory : public logging::formatter_factory<char> {
+public:
+    formatter_type create_formatter(const logging::attribute_name& name, const args_map& args) override {
+        const auto format = args.find("format");
+        if (format == args.end()) {
+            return formatter_type(default_formatter(name));
+        }
+        return formatter_type(custom_formatter(
+            name,
+            logging::expressions::aux::date_time_formatter_generator_traits<posix_time::ptime, char>::parse(
+                format->second)));
+    }
+};
+} // namespace
+
+class time_stamp_clock::impl : public logging::attribute::impl {
+public:
+    logging::attribute_value get_value() override {
+        return detail::make_pooled_value(now());
+    }
+};
+
+time_stamp_clock::time_stamp_clock() : logging::attribute(new impl()) {
+}
+
+time_stamp time_stamp_clock::now() {
+    // the offset of the local time zone only changes on a full second
+    thread_local std::int64_t offset_second = std::numeric_limits<std::int64_t>::min();
+    thread_local std::int64_t offset = 0;
+
+    timespec now{};
+    ::clock_gettime(CLOCK_REALTIME, &now);
+    if (now.tv_sec != offset_second) {
+        std::tm local{};
+        ::localtime_r(&now.tv_sec, &local);
+        offset = local.tm_gmtoff;
+        offset_second = now.tv_sec;
+    }
+    return {(static_cast<std::int64_t>(now.tv_sec) + offset) * nanoseconds_per_second + now.tv_nsec};
+}
+
+void write_time_stamp(time_stamp value, logging::formatting_ostream& strm) {
+    thread_local std::int64_t cached_second = std::numeric_limits<std::int64_t>::min();
+    thread_local char text[prefix_length + 9];
+
+    auto second = value.nanoseconds / nanoseconds_per_second;
+    auto fraction = value.nanoseconds % nanoseconds_per_second;
+    if (fraction < 0) {
+        fraction += nanoseconds_per_second;
+        --second;
+    }
+    if (second != cached_second) {
+        render_prefix(second, text);
+        cached_second = second;
+    }
+
+    std::size_t length = prefix_length;
+    switch (current_precision.load(std::memory_order_relaxed)) {
+    case time_stamp_precision::milliseconds:
+        put_digits(text + length, fraction / 1000000, 3);
+        length += 3;
+        break;
+    case time_stamp_precision::microseconds:
+        put_digits(text + length, fraction / 1000, 6);
+        length += 6;
+        break;
+    case time_stamp_precision::nanoseconds:
+        put_digits(text + length, fraction, 9);
+        length += 9;
+        break;
+    }
+    strm.write(text, static_cast<std::streamsize>(length));
+}
+
+std::ostream& operator<<(std::ostream& strm, time_stamp value) {
+    std::string text;
+    {
+        logging::formatting_ostream text_strm(text);
+        write_time_stamp(value, text_strm);
+    }
+    return strm << text;
+}
+
+posix_time::ptime to_ptime(time_stamp value) {
+    auto microseconds = value.nanoseconds / 1000;
+    if (value.nanoseconds % 1000 < 0) {
+        --microseconds;
+    }
+    return epoch() + posix_time::microseconds(microseconds);
+}
+
+time_stamp from_ptime(const posix_time::ptime& value) {
+    if (value.is_special()) {
+        return {0};
+    }
+    return {(value - epoch()).total_nanoseconds()};
+}
+
+time_stamp_precision time_stamp_precision_from_settings(const logging::settings& settings) {
+    const auto precision = settings["TimeStamp.Precision"].get();
+    if (!precision || precision.get() == "us") {
+        return time_stamp_precision::microseconds;
+    }
+    if (precision.get() == "ms") {
+        return time_stamp_precision::milliseconds;
+    }
+    if (precision.get() == "ns") {
+        return time_stamp_precision::nanoseconds;
+    }
+    throw EverestConfigError("Invalid value \"" + precision.get() + "\" for setting Precision, expected ms, us or ns");
+}
+
+void set_time_stamp_precision(time_stamp_precision precision) {
+    current_precision.store(precision, std::memory_order_relaxed);
+}
+
+void register_time_stamp_formatter_factory() {
+    logging::register_formatter_factory("TimeStamp", boost::make_shared<time_stamp_formatter_factory>());
+}
+
+} // namespace Logging
+} // namespace Everest
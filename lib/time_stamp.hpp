@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef TIME_STAMP_HPP
+#define TIME_STAMP_HPP
+
+#include <cstdint>
+#include <ostream>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/attributes/attribute.hpp>
+#include <boost/log/utility/formatting_ostream.hpp>
+#include <boost/log/utility/setup/settings.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+
+/// \brief Value of the TimeStamp attribute, the local wall clock time in nanoseconds since 1970
+struct time_stamp {
+    std::int64_t nanoseconds;
+};
+
+/// \brief sub-second digits of %TimeStamp%, configured by [TimeStamp] Precision
+enum class time_stamp_precision {
+    milliseconds,
+    microseconds,
+    nanoseconds,
+};
+
+///
+/// \brief The TimeStamp attribute installed by init()
+///
+/// Reads CLOCK_REALTIME, which is served by the vDSO without a system call, and adds the offset of the local time
+/// zone. The offset is looked up once per second and thread, instead of a full local time conversion per record.
+class time_stamp_clock : public logging::attribute {
+public:
+    time_stamp_clock();
+
+    /// \brief the current local time
+    static time_stamp now();
+
+private:
+    class impl;
+};
+
+/// \brief writes \p value as "YYYY-MM-DD HH:MM:SS" and the sub-second digits of the configured precision
+///
+/// The date and time of day are rendered once per second and thread, only the sub-second digits are rendered for
+/// every record.
+void write_time_stamp(time_stamp value, logging::formatting_ostream& strm);
+
+/// \brief same as write_time_stamp(), for Boost.Log formatters
+std::ostream& operator<<(std::ostream& strm, time_stamp value);
+
+/// \brief \p value as a ptime, which has a resolution of microseconds
+boost::posix_time::ptime to_ptime(time_stamp value);
+
+/// \brief \p value as a time_stamp, special values are mapped to 1970
+time_stamp from_ptime(const boost::posix_time::ptime& value);
+
+/// \brief the precision in the [TimeStamp] Precision setting, microseconds if there is none
+/// \throws EverestConfigError if the setting is not one of ms, us or ns
+time_stamp_precision time_stamp_precision_from_settings(const logging::settings& settings);
+
+void set_time_stamp_precision(time_stamp_precision precision);
+
+///
+/// \brief registers the formatter of %TimeStamp%
+///
+/// Without arguments time_stamp values are written by write_time_stamp(). With a format argument, e.g.
+/// %TimeStamp(format="%H:%M:%S")%, and for ptime values the date and time formatting of Boost.Log is used.
+void register_time_stamp_formatter_factory();
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // TIME_STAMP_HPP
@@ -1,90 +1,292 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright 2020 - 2022 Pionix GmbH and Contributors to EVerest
 #include <everest/logging.hpp>
+#include <everest/trace.hpp>
+
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #ifdef WITH_LIBBACKTRACE
 #include <backtrace/backtrace-supported.h>
 #include <backtrace/backtrace.h>
 #include <cxxabi.h>
 
-#include <mutex>
+#include <cstdlib>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 
-static backtrace_state* bt_state;
-static bool tried_to_initialize;
-static std::mutex init_mtx;
+namespace {
+/// one source location of a program counter, a program counter in inlined code has several
+struct resolved_frame {
+    /// demangled if possible, empty if unknown
+    std::string function;
+    /// empty if unknown
+    std::string filename;
+    int lineno;
+};
 
-struct StackTrace {
-    int frame_count{0};
-    std::string info;
+/// the frames of every program counter resolved so far, entries are never removed or changed
+struct symbol_cache {
+    std::shared_mutex mtx;
+    std::unordered_map<uintptr_t, std::vector<resolved_frame>> frames;
 };
 
-inline int frame_handler(void* data, uintptr_t pc, const char* filename, int lineno, const char* function) {
-    // FIXME(aw): we might have unknown frames everywhere in the call
-    //            stack, it probably only make sense to skip the
-    //            contigeous set of the top/root frames, that are all
-    //            unknown
-    // if ((filename == nullptr) && (lineno == 0) && (function == nullptr)) {
-    //     return 1; // stop backtracing
-    // }
-    auto& trace = *static_cast<StackTrace*>(data);
-
-    std::string function_name = "<function unknown>";
-    if (function != nullptr) {
-        // try to demangle
-        int status;
-        size_t length;
-
-        auto demangled_function = __cxxabiv1::__cxa_demangle(function, nullptr, &length, &status);
-        if (status == 0) {
-            // successfully demangled
-            function_name = std::string(demangled_function);
-        } else {
-            function_name = std::string(function);
-        }
-    }
+/// never destroyed, exceptions might be thrown while static destructors run
+symbol_cache& cache() {
+    static auto* instance = new symbol_cache;
+    return *instance;
+}
+
+backtrace_state* state() {
+    // created by the first call, later calls only check that it was
+    // 1 means support threaded
+    static backtrace_state* const bt_state = backtrace_create_state(nullptr, 1, nullptr, nullptr);
+    return bt_state;
+}
 
-    trace.info += ("#" + std::to_string(trace.frame_count) + ": ");
-    trace.info += (function_name + " at ");
-    trace.info += (filename != nullptr) ? filename : "<filename unknown>";
-    trace.info += (":" + std::to_string(lineno));
+void ignore_error(void* /* data */, const char* /* msg */, int /* errnum */) {
+}
+
+int pc_handler(void* data, uintptr_t pc) {
+    auto& trace = *static_cast<Everest::Logging::raw_trace*>(data);
+    trace.pcs[trace.size++] = pc;
+    return (trace.size == trace.pcs.size()) ? 1 : 0; // stop backtracing once full
+}
 
-    trace.info += "\n";
+/// captures the stack of the caller of the function calling it
+__attribute__((noinline)) void capture(Everest::Logging::raw_trace& trace) {
+    trace.size = 0;
+    if (auto* bt = state()) {
+        // 2 skips this function and the one calling it
+        backtrace_simple(bt, 2, pc_handler, ignore_error, &trace);
+    }
+}
 
-    trace.frame_count++;
+/// the buffer __cxa_demangle() demangles into, kept by each thread and grown as needed
+struct demangle_buffer {
+    ~demangle_buffer() {
+        std::free(data);
+    }
+    char* data{nullptr};
+    std::size_t size{0};
+};
 
-    return 0; // continue backtracing
+std::string demangle(const char* function) {
+    if (function == nullptr) {
+        return {};
+    }
+    thread_local demangle_buffer buffer;
+    int status;
+    // on success, the buffer might have been reallocated
+    auto* demangled_function = __cxxabiv1::__cxa_demangle(function, buffer.data, &buffer.size, &status);
+    if (status != 0) {
+        return function;
+    }
+    buffer.data = demangled_function;
+    return demangled_function;
 }
 
+int frame_handler(void* data, uintptr_t /* pc */, const char* filename, int lineno, const char* function) {
+    auto& frames = *static_cast<std::vector<resolved_frame>*>(data);
+    frames.push_back({demangle(function), (filename != nullptr) ? filename : "", lineno});
+    return 0; // continue with the calling frames of inlined code
+}
+
+const std::vector<resolved_frame>& resolve(uintptr_t pc) {
+    // program counters this thread resolved before are found without touching the lock of the shared cache
+    thread_local std::unordered_map<uintptr_t, const std::vector<resolved_frame>*> resolved_by_thread;
+    auto& known = resolved_by_thread[pc];
+    if (known != nullptr) {
+        return *known;
+    }
+
+    auto& symbols = cache();
+    {
+        std::shared_lock<std::shared_mutex> lck(symbols.mtx);
+        const auto cached = symbols.frames.find(pc);
+        if (cached != symbols.frames.end()) {
+            known = &cached->second;
+            return *known;
+        }
+    }
+
+    // resolved outside of the lock, a thread resolving the same program counter at the same time is harmless
+    std::vector<resolved_frame> frames;
+    backtrace_pcinfo(state(), pc, frame_handler, ignore_error, &frames);
+    if (frames.empty()) {
+        frames.push_back({{}, {}, 0});
+    }
+
+    std::lock_guard<std::shared_mutex> lck(symbols.mtx);
+    // references to the elements of an unordered_map stay valid when it grows
+    known = &symbols.frames.emplace(pc, std::move(frames)).first->second;
+    return *known;
+}
+} // namespace
 #endif
 
+namespace {
+/// resolves traces for symbolize_async() one after the other
+class background_symbolizer {
+public:
+    ~background_symbolizer() {
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            stopping = true;
+        }
+        tasks_available.notify_one();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    std::future<std::string> submit(const Everest::Logging::raw_trace& trace, bool skip_unknown_root_frames) {
+        std::packaged_task<std::string()> task(
+            [trace, skip_unknown_root_frames] { return Everest::Logging::symbolize(trace, skip_unknown_root_frames); });
+        auto result = task.get_future();
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            if (!worker.joinable()) {
+                worker = std::thread(&background_symbolizer::run, this);
+            }
+            tasks.push_back(std::move(task));
+        }
+        tasks_available.notify_one();
+        return result;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lck(mtx);
+        while (true) {
+            tasks_available.wait(lck, [this] { return stopping || !tasks.empty(); });
+            // pending traces are still resolved when stopping, nobody waits forever on their future
+            if (tasks.empty()) {
+                return;
+            }
+            auto task = std::move(tasks.front());
+            tasks.pop_front();
+            lck.unlock();
+            task();
+            lck.lock();
+        }
+    }
+
+    std::mutex mtx;
+    std::condition_variable tasks_available;
+    std::deque<std::packaged_task<std::string()>> tasks;
+    bool stopping{false};
+    std::thread worker;
+};
+} // namespace
+
 namespace Everest {
 namespace Logging {
-std::string trace() {
+std::string trace(bool skip_unknown_root_frames) {
 #ifdef WITH_LIBBACKTRACE
-    {
-        std::lock_guard<std::mutex> lck(init_mtx);
-        if (!tried_to_initialize) {
-            // 1 means support threaded
-            bt_state = backtrace_create_state(nullptr, 1, nullptr, nullptr);
-            tried_to_initialize = true;
-        }
+    raw_trace trace;
+    capture(trace);
+    if (state() == nullptr) {
+        return "Backtrace functionality not available\n";
     }
+    return symbolize(trace, skip_unknown_root_frames);
+#else
+    (void)skip_unknown_root_frames;
+    return "Backtrace functionality not built in\n";
+#endif
+}
 
-    if (bt_state == nullptr) {
-        return "Backtrace functionality not available\n";
+raw_trace capture_trace() {
+    raw_trace trace;
+#ifdef WITH_LIBBACKTRACE
+    capture(trace);
+#endif
+    return trace;
+}
+
+void resolve_frames(const raw_trace& trace, std::vector<stack_frame>& frames, bool skip_unknown_root_frames) {
+    frames.clear();
+#ifdef WITH_LIBBACKTRACE
+    if (state() == nullptr) {
+        return;
+    }
+    frames.reserve(trace.size);
+    for (std::size_t i = 0; i < trace.size; ++i) {
+        for (const auto& frame : resolve(trace.pcs[i])) {
+            frames.push_back({trace.pcs[i], frame.function, frame.filename, frame.lineno});
+        }
+    }
+    if (skip_unknown_root_frames) {
+        while (!frames.empty() && frames.back().unknown()) {
+            frames.pop_back();
+        }
     }
+#else
+    (void)trace;
+    (void)skip_unknown_root_frames;
+#endif
+}
 
-    StackTrace trace;
+std::vector<stack_frame> resolve_frames(const raw_trace& trace, bool skip_unknown_root_frames) {
+    std::vector<stack_frame> frames;
+    resolve_frames(trace, frames, skip_unknown_root_frames);
+    return frames;
+}
 
-    // FIXME (aw): 1 means we're skipping this functions frame, can this
-    //             be optimized away by the compiler, so we are going to
-    //             miss the first frame?
-    backtrace_full(bt_state, 1, frame_handler, nullptr, &trace);
+void render(const std::vector<stack_frame>& frames, std::string& buffer) {
+    char number[24];
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        const auto& frame = frames[i];
+        buffer += '#';
+        buffer.append(number, std::to_chars(number, number + sizeof(number), i).ptr);
+        buffer += ": ";
+        buffer += frame.function.empty() ? "<function unknown>" : frame.function;
+        buffer += " at ";
+        buffer += frame.filename.empty() ? "<filename unknown>" : frame.filename;
+        buffer += ':';
+        buffer.append(number, std::to_chars(number, number + sizeof(number), frame.lineno).ptr);
+        buffer += '\n';
+    }
+}
 
-    return trace.info;
+std::string symbolize(const raw_trace& trace, bool skip_unknown_root_frames) {
+#ifdef WITH_LIBBACKTRACE
+    if (state() == nullptr) {
+        return "Backtrace functionality not available\n";
+    }
+
+    thread_local std::vector<stack_frame> frames;
+    resolve_frames(trace, frames, skip_unknown_root_frames);
+    std::string info;
+    std::size_t length = 0;
+    for (const auto& frame : frames) {
+        // "#N: " and " at " and ":N\n" take about 32 characters
+        length += frame.function.size() + frame.filename.size() + 32;
+    }
+    info.reserve(length);
+    render(frames, info);
+    return info;
 #else
+    (void)trace;
+    (void)skip_unknown_root_frames;
     return "Backtrace functionality not built in\n";
 #endif
 }
+
+void preload_trace() {
+#ifdef WITH_LIBBACKTRACE
+    // the debug information is read when the first program counter is resolved
+    symbolize(capture_trace());
+#endif
+}
+
+std::future<std::string> symbolize_async(const raw_trace& trace, bool skip_unknown_root_frames) {
+    static background_symbolizer symbolizer;
+    return symbolizer.submit(trace, skip_unknown_root_frames);
+}
 } // namespace Logging
 } // namespace Everest
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <compiled_format.hpp>
+#include <sinks.hpp>
+
+#include <everest/logging.hpp>
+
+#include <boost/log/attributes/constant.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/make_shared.hpp>
+#include <cstdlib>
+#include <string>
+
+// this test has an executable of its own, replacing malloc() affects every test linked with it
+#if defined(__GLIBC__)
+// counts the allocations of the current thread, Boost.Log allocates records with malloc() instead of operator new
+extern "C" void* __libc_malloc(std::size_t size);
+
+namespace {
+thread_local bool counting_allocations = false;
+thread_local int allocations = 0;
+} // namespace
+
+extern "C" void* malloc(std::size_t size) {
+    if (counting_allocations) {
+        ++allocations;
+    }
+    return __libc_malloc(size);
+}
+#endif
+
+namespace Everest {
+namespace Logging {
+
+namespace sinks = logging::sinks;
+
+namespace {
+/// keeps the last formatted record, without allocating once its buffer is large enough
+class last_record_backend : public sinks::basic_formatted_sink_backend<char> {
+public:
+    last_record_backend() {
+        last.reserve(4096);
+    }
+
+    void consume(const logging::record_view&, const std::string& formatted) {
+        last.assign(formatted);
+    }
+
+    std::string last;
+};
+} // namespace
+
+class AllocationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        init(LIBLOG_TEST_CONFIG);
+        logging::core::get()->remove_all_sinks();
+        backend = boost::make_shared<last_record_backend>();
+        auto sink = boost::make_shared<sinks::synchronous_sink<last_record_backend>>(backend);
+        sink->set_formatter(
+            compile_formatter(rewrite_format_placeholders("%TimeStamp% [%Severity%] {%ThreadID%} %Scope% %Message%")));
+        logging::core::get()->add_sink(sink);
+    }
+
+    void TearDown() override {
+        logging::core::get()->remove_all_sinks();
+    }
+
+    /// allocations of \p log_call once the record pool and the buffers have been filled
+    template <typename Function> int steady_state_allocations(Function log_call) {
+#if defined(__GLIBC__)
+        for (int i = 0; i < 3; ++i) {
+            log_call();
+        }
+        allocations = 0;
+        counting_allocations = true;
+        log_call();
+        counting_allocations = false;
+        return allocations;
+#else
+        log_call();
+        return 0;
+#endif
+    }
+
+    /// allocations of a record without any of the attributes and the message liblog adds
+    int boost_core_allocations() {
+        logging::attribute_set attributes;
+        attributes.insert("Severity", logging::attributes::constant<severity_level>(info));
+        return steady_state_allocations([&attributes] {
+            auto core = logging::core::get();
+            auto rec = core->open_record(attributes);
+            core->push_record(std::move(rec));
+        });
+    }
+
+    boost::shared_ptr<last_record_backend> backend;
+};
+
+TEST_F(AllocationTest, logging_doesnt_allocate_in_steady_state) {
+#if !defined(__GLIBC__)
+    GTEST_SKIP() << "allocations are only counted with glibc";
+#elif defined(LIBLOG_DEFERRED_FORMATTING)
+    GTEST_SKIP() << "deferred messages are captured into their own storage";
+#endif
+    BOOST_LOG_NAMED_SCOPE("scope");
+    const std::string long_message(200, 'x');
+
+    // the remaining allocations are the attribute value set and the record of the Boost.Log core
+    const auto core_allocations = boost_core_allocations();
+    ASSERT_GT(core_allocations, 0) << "allocations aren't counted";
+    EXPECT_EQ(steady_state_allocations([] { EVLOG_info << "short message"; }), core_allocations);
+    EXPECT_EQ(steady_state_allocations([&] { EVLOG_info << long_message << ' ' << 42 << ' ' << 1.5; }),
+              core_allocations);
+    EXPECT_NE(backend->last.find("INFO"), std::string::npos);
+    EXPECT_NE(backend->last.find(long_message + " 42 1.5"), std::string::npos);
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+// the binary format keeps deferred messages, this translation unit always captures them
+#ifndef LIBLOG_DEFERRED_FORMATTING
+#define LIBLOG_DEFERRED_FORMATTING
+#endif
+
+#include <binary_file_sink.hpp>
+#include <binary_log.hpp>
+#include <sinks.hpp>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace Everest {
+namespace Logging {
+
+namespace sinks = logging::sinks;
+
+namespace {
+const std::string format = "%TimeStamp% %Process% %ProcessID% [%Severity%] {%ThreadID%} %function% %file%:%line% "
+                           "%LineID%: %Message%";
+
+struct not_capturable {
+    int value;
+};
+
+std::ostream& operator<<(std::ostream& strm, const not_capturable& object) {
+    return strm << "not_capturable(" << object.value << ")";
+}
+} // namespace
+
+class BinaryFileSinkTest : public ::testing::Test {
+protected:
+    using text_sink = sinks::synchronous_sink<sinks::text_ostream_backend>;
+
+    void SetUp() override {
+        init(LIBLOG_TEST_CONFIG);
+        file_name = unique_temp_file(".bin");
+    }
+
+    void TearDown() override {
+        logging::core::get()->remove_all_sinks();
+        std::remove(file_name.c_str());
+    }
+
+    boost::shared_ptr<text_sink> add_text_sink(std::ostream& output) {
+        auto backend = boost::make_shared<sinks::text_ostream_backend>();
+        backend->add_stream(boost::shared_ptr<std::ostream>(&output, boost::null_deleter()));
+        auto sink = boost::make_shared<text_sink>(backend);
+        sink->set_formatter(logging::parse_formatter(rewrite_format_placeholders(format)));
+        logging::core::get()->add_sink(sink);
+        return sink;
+    }
+
+    void add_binary_sink(bool append) {
+        binary_sink = boost::make_shared<sinks::synchronous_sink<binary_file_backend>>(
+            boost::make_shared<binary_file_backend>(file_name, append, false));
+        logging::core::get()->add_sink(binary_sink);
+    }
+
+    /// decodes the binary file the way everest_log_decode does
+    std::string decode() {
+        binary_sink->flush();
+        logging::core::get()->remove_all_sinks();
+
+        std::ostringstream decoded;
+        add_text_sink(decoded);
+
+        std::ifstream file(file_name, std::ios::binary);
+        binary_log_decoder decoder;
+        logging::attribute_set attributes;
+        while (decoder.read(file, attributes)) {
+            if (auto rec = logging::core::get()->open_record(attributes)) {
+                logging::core::get()->push_record(std::move(rec));
+            }
+        }
+        return decoded.str();
+    }
+
+    std::string file_name;
+    boost::shared_ptr<sinks::synchronous_sink<binary_file_backend>> binary_sink;
+};
+
+TEST_F(BinaryFileSinkTest, decodes_to_the_text_output) {
+    std::ostringstream text;
+    add_text_sink(text);
+    add_binary_sink(false);
+
+    EVLOG_verbose << "deferred " << 42 << ' ' << 1.5;
+    EVLOG_info << "text " << not_capturable{7};
+    for (int i = 0; i < 3; ++i) {
+        EVLOG_warning << "loop " << i;
+    }
+    std::thread([]() { EVLOG_error << "from another thread"; }).join();
+    BOOST_LOG_SEV(::global_logger::get(), critical) << "without call site";
+
+    EXPECT_EQ(decode(), text.str());
+}
+
+TEST_F(BinaryFileSinkTest, appended_sessions_are_decoded_independently) {
+    std::ostringstream text;
+    add_text_sink(text);
+
+    add_binary_sink(false);
+    EVLOG_info << "first run";
+    binary_sink->flush();
+    logging::core::get()->remove_sink(binary_sink);
+
+    add_binary_sink(true);
+    EVLOG_info << "second run";
+
+    EXPECT_EQ(decode(), text.str());
+}
+
+TEST_F(BinaryFileSinkTest, is_smaller_than_the_text_output) {
+    std::ostringstream text;
+    add_text_sink(text);
+    add_binary_sink(false);
+
+    for (int i = 0; i < 100; ++i) {
+        EVLOG_info << "charging session " << i << " delivered " << i * 0.25 << " kWh";
+    }
+    binary_sink->flush();
+
+    std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+    EXPECT_LT(static_cast<std::size_t>(file.tellg()) * 3, text.str().size() * 2);
+}
+
+TEST_F(BinaryFileSinkTest, rejects_corrupt_files) {
+    std::istringstream garbage("not a binary log");
+    binary_log_decoder decoder;
+    logging::attribute_set attributes;
+    EXPECT_THROW(decoder.read(garbage, attributes), EverestInternalError);
+
+    add_binary_sink(false);
+    EVLOG_info << "will be truncated";
+    binary_sink->flush();
+
+    std::ifstream file(file_name, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::istringstream truncated(content.substr(0, content.size() - 3));
+    EXPECT_THROW(decoder.read(truncated, attributes), EverestInternalError);
+}
+
+} // namespace Logging
+} // namespace Everest
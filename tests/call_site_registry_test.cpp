@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/log/core.hpp>
+#include <memory>
+#include <string>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+void log_from_module() {
+    EVLOG_debug << "module debug";
+    EVLOG_info << "module info";
+}
+} // namespace
+
+class CallSiteRegistryTest : public ConfigFileTest {
+protected:
+    /// initializes logging with a console sink printing only the message and the given call site rules
+    void init_with_rules(const std::string& rules) {
+        boost::log::core::get()->remove_all_sinks();
+        capture_console();
+        init_with_config("[Sinks.Console]\n"
+                         "Destination=Console\n"
+                         "Format=\"%Message%\"\n" +
+                         rules);
+        take_output();
+    }
+};
+
+TEST_F(CallSiteRegistryTest, default_severity_disables_call_sites) {
+    init_with_rules("[CallSites]\nDefault=INFO\n");
+
+    EVLOG_debug << "debug";
+    log_from_module();
+    EVLOG_warning << "warning";
+    EXPECT_EQ(take_output(), "module info\nwarning\n");
+}
+
+TEST_F(CallSiteRegistryTest, last_matching_rule_decides) {
+    init_with_rules("[CallSites]\nDefault=WARN\n"
+                    "[CallSites.Tests]\nFile=\"*/call_site_registry_test.cpp\"\nSeverity=INFO\n"
+                    "[CallSites.Module]\nFunction=\"*log_from_module*\"\nSeverity=DEBG\n");
+
+    EVLOG_debug << "debug";
+    EVLOG_info << "info";
+    log_from_module();
+    EXPECT_EQ(take_output(), "info\nmodule debug\nmodule info\n");
+}
+
+TEST_F(CallSiteRegistryTest, reached_call_sites_follow_new_rules) {
+    init_with_rules("");
+    log_from_module();
+    EXPECT_EQ(take_output(), "module debug\nmodule info\n");
+
+    init_with_rules("[CallSites]\nDefault=CRIT\n");
+    log_from_module();
+    EXPECT_EQ(take_output(), "");
+
+    init_with_rules("[CallSites]\nDefault=CRIT\n[CallSites.Module]\nFunction=\"*log_from_module*\"\nSeverity=INFO\n");
+    log_from_module();
+    EXPECT_EQ(take_output(), "module info\n");
+}
+
+TEST_F(CallSiteRegistryTest, call_sites_of_unloaded_images_are_left_alone) {
+    init_with_rules("");
+    auto image = std::make_unique<call_site_image>();
+    const call_site site{__FILE__, __LINE__, "unloaded_function", debug, call_site::show_nothing, image.get()};
+    EXPECT_TRUE(site.enabled());
+
+    // like dlclose() of a module, which destroys its call_site_image before unmapping its call sites
+    image.reset();
+    init_with_rules("[CallSites]\nDefault=CRIT\n");
+    EXPECT_TRUE(site.enabled()) << "the new rules must not reach call sites of unloaded images";
+}
+
+TEST_F(CallSiteRegistryTest, invalid_rules_are_rejected) {
+    EXPECT_THROW(init_with_rules("[CallSites]\nDefault=LOUD\n"), EverestConfigError);
+    EXPECT_THROW(init_with_rules("[CallSites.Module]\nSeverity=INFO\n"), EverestConfigError);
+    EXPECT_THROW(init_with_rules("[CallSites.Module]\nFile=\"*.cpp\"\n"), EverestConfigError);
+}
+
+} // namespace Logging
+} // namespace Everest
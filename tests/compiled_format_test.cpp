@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <compiled_format.hpp>
+#include <sinks.hpp>
+
+#include <everest/logging.hpp>
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/attributes/named_scope.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/utility/manipulators/add_value.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <sstream>
+#include <string>
+
+namespace Everest {
+namespace Logging {
+
+namespace sinks = logging::sinks;
+
+class CompiledFormatTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        init(LIBLOG_TEST_CONFIG);
+        logging::core::get()->remove_all_sinks();
+    }
+
+    void TearDown() override {
+        logging::core::get()->remove_all_sinks();
+    }
+
+    /// adds sinks formatting every record with Boost.Log and with a compiled_format of \p format
+    void use_format(const std::string& format) {
+        const auto rewritten = rewrite_format_placeholders(format);
+        add_sink(boost_output, logging::parse_formatter(rewritten));
+        add_sink(compiled_output, compile_formatter(rewritten));
+    }
+
+    void add_sink(std::ostringstream& output, const logging::formatter& formatter) {
+        auto backend = boost::make_shared<sinks::text_ostream_backend>();
+        backend->add_stream(boost::shared_ptr<std::ostream>(&output, boost::null_deleter()));
+        auto sink = boost::make_shared<sinks::synchronous_sink<sinks::text_ostream_backend>>(backend);
+        sink->set_formatter(formatter);
+        logging::core::get()->add_sink(sink);
+    }
+
+    std::ostringstream boost_output;
+    std::ostringstream compiled_output;
+};
+
+TEST_F(CompiledFormatTest, writes_the_same_text_as_boost) {
+    use_format("%TimeStamp% \\033[1;32m%Process%\\033[0m [%ProcessID%] [%Severity%] {%ThreadID%} #%LineID% "
+               "%function% %file%:%line%: %Message% | %EscapedMessage% | %JsonEscapedMessage%\\t\\x41\\101\\\\");
+
+    EVLOG_verbose << "verbose with \"quotes\"";
+    EVLOG_debug << "debug\nwith a newline and a ?";
+    EVLOG_info << "info " << 42;
+    EVLOG_critical << "critical";
+    BOOST_LOG_SEV(::global_logger::get(), warning) << "without a call site";
+
+    EXPECT_FALSE(compiled_output.str().empty());
+    EXPECT_EQ(compiled_output.str(), boost_output.str());
+}
+
+TEST_F(CompiledFormatTest, delegates_other_placeholders_to_boost) {
+    use_format("%Scope% %TimeStamp(format=\"%H:%M\")% %Unknown% %Severity% %Message%");
+    BOOST_LOG_NAMED_SCOPE("scope");
+
+    EVLOG_info << "info";
+
+    EXPECT_NE(compiled_output.str().find(" INFO"), std::string::npos);
+    EXPECT_EQ(compiled_output.str(), boost_output.str());
+}
+
+TEST_F(CompiledFormatTest, writes_plain_attributes_without_call_site) {
+    use_format("%file%:%line% %function% %Message%");
+
+    BOOST_LOG_SEV(::global_logger::get(), info)
+        << logging::add_value("file", std::string("plain.cpp")) << logging::add_value("line", 7) << "plain";
+
+    EXPECT_EQ(compiled_output.str(), "plain.cpp:7  plain\n");
+    EXPECT_EQ(compiled_output.str(), boost_output.str());
+}
+
+TEST_F(CompiledFormatTest, fully_compiles_the_default_placeholders) {
+    EXPECT_TRUE(compiled_format("%TimeStamp% %Process% [%ProcessID%] [%Severity%] {%ThreadID%} %function% %file%:"
+                                "%line%: %FormattedMessage% %EscapedMessage%")
+                    .fully_compiled());
+    EXPECT_FALSE(compiled_format("%Scope% %FormattedMessage%").fully_compiled());
+}
+
+TEST_F(CompiledFormatTest, rejects_invalid_formats_like_boost) {
+    EXPECT_ANY_THROW(compiled_format("%Unterminated(format=\"x\" %Message%"));
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <everest/logging.hpp>
+
+#include "test_helpers.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <string>
+
+namespace Everest {
+namespace Logging {
+
+class CrashHandlerTest : public ConfigFileTest {
+protected:
+    void SetUp() override {
+        // the crashing process logs from several threads
+        GTEST_FLAG_SET(death_test_style, "threadsafe");
+        log_file = temp_file(".log");
+    }
+
+    void write_config(const std::string& sink_settings) {
+        ConfigFileTest::write_config("[Core]\nFilter=\"%Severity% >= INFO\"\n"
+                                     "[Sinks.Crash]\nDestination=File\nFileName=\"" +
+                                     log_file + "\"\nFormat=\"%Message%\"\nFlushIntervalMs=60000\n" + sink_settings);
+    }
+
+    /// runs in the death test child, logs records that are still queued or buffered when it crashes
+    void log_and_crash() {
+        init(config_file);
+        install_crash_handler(std::chrono::milliseconds(200));
+        for (int i = 0; i < 100; ++i) {
+            EVLOG_info << "before the crash " << i;
+        }
+        std::raise(SIGSEGV);
+    }
+
+    std::string written() const {
+        return read_file(log_file);
+    }
+
+    std::string log_file;
+};
+
+TEST_F(CrashHandlerTest, writes_out_the_records_of_asynchronous_sinks) {
+    write_config("Asynchronous=true\n");
+    EXPECT_EXIT(log_and_crash(), ::testing::KilledBySignal(SIGSEGV), "Fatal signal 11 \\(SIGSEGV\\)");
+
+    const auto log = written();
+    EXPECT_NE(log.find("before the crash 0\n"), std::string::npos);
+    EXPECT_NE(log.find("before the crash 99\n"), std::string::npos);
+    EXPECT_NE(log.find("Fatal signal 11 (SIGSEGV)"), std::string::npos);
+    EXPECT_LT(log.find("before the crash 99\n"), log.find("Fatal signal"));
+}
+
+TEST_F(CrashHandlerTest, writes_out_the_records_of_lockfree_sinks) {
+    write_config("Backend=lockfree\n");
+    EXPECT_EXIT(log_and_crash(), ::testing::KilledBySignal(SIGSEGV), "Fatal signal 11 \\(SIGSEGV\\)");
+
+    const auto log = written();
+    EXPECT_NE(log.find("before the crash 0\n"), std::string::npos);
+    EXPECT_NE(log.find("before the crash 99\n"), std::string::npos);
+    EXPECT_NE(log.find("Fatal signal 11 (SIGSEGV)"), std::string::npos);
+}
+
+TEST_F(CrashHandlerTest, reports_abort) {
+    write_config("");
+    EXPECT_EXIT(
+        {
+            init(config_file);
+            install_crash_handler();
+            EVLOG_info << "aborting";
+            std::abort();
+        },
+        ::testing::KilledBySignal(SIGABRT), "Fatal signal 6 \\(SIGABRT\\), backtrace of thread");
+    EXPECT_EQ(written().rfind("aborting\nFatal signal 6 (SIGABRT)", 0), 0);
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+// this translation unit always uses deferred formatting, regardless of the CMake configuration
+#ifndef LIBLOG_DEFERRED_FORMATTING
+#define LIBLOG_DEFERRED_FORMATTING
+#endif
+
+#include <everest/logging.hpp>
+#include <sinks.hpp>
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/attributes/value_extraction.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <iomanip>
+#include <sstream>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+namespace sinks = logging::sinks;
+
+namespace {
+enum plain_enum {
+    plain_value = 7
+};
+
+enum class printed_enum {
+    value
+};
+
+std::ostream& operator<<(std::ostream& strm, printed_enum) {
+    return strm << "printed_enum::value";
+}
+
+struct not_capturable {
+    int value;
+};
+
+std::ostream& operator<<(std::ostream& strm, const not_capturable& object) {
+    return strm << "not_capturable(" << object.value << ")";
+}
+} // namespace
+
+class DeferredMessageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        init(LIBLOG_TEST_CONFIG);
+
+        auto backend = boost::make_shared<sinks::text_ostream_backend>();
+        backend->add_stream(boost::shared_ptr<std::ostream>(&output, boost::null_deleter()));
+        sink = boost::make_shared<sinks::synchronous_sink<sinks::text_ostream_backend>>(backend);
+        sink->set_formatter(logging::parse_formatter(rewrite_format_placeholders("%Message%|%EscapedMessage%")));
+        logging::core::get()->add_sink(sink);
+    }
+
+    void TearDown() override {
+        logging::core::get()->remove_sink(sink);
+    }
+
+    /// the output of the last record
+    std::string take_output() {
+        auto text = output.str();
+        output.str("");
+        return text;
+    }
+
+    std::ostringstream output;
+    boost::shared_ptr<sinks::synchronous_sink<sinks::text_ostream_backend>> sink;
+};
+
+// logs the arguments once through EVLOG_info (deferred) and once through a plain Boost.Log record stream
+#define EXPECT_SAME_OUTPUT(args)                                                                                       \
+    do {                                                                                                               \
+        EVLOG_info << args;                                                                                            \
+        const auto deferred = take_output();                                                                           \
+        BOOST_LOG_SEV(::global_logger::get(), info) << args;                                                           \
+        EXPECT_EQ(deferred, take_output());                                                                            \
+    } while (0)
+
+TEST_F(DeferredMessageTest, output_matches_immediate_formatting) {
+    const std::string text = "string with \"quotes\"\n";
+    const char array[16] = "char array";
+    const short negative_short = -1;
+    const void* pointer = &text;
+
+    EXPECT_SAME_OUTPUT("literal " << 42 << ' ' << -17L << ' ' << 42u << ' ' << 3.14159265358979 << ' ' << 2.5f);
+    EXPECT_SAME_OUTPUT(true << false << std::boolalpha << true);
+    EXPECT_SAME_OUTPUT(std::hex << negative_short << ' ' << -1 << ' ' << std::showbase << 255 << std::dec << 255);
+    EXPECT_SAME_OUTPUT(std::fixed << std::setprecision(3) << 1.0 / 3 << ' ' << std::scientific << 12345.678);
+    EXPECT_SAME_OUTPUT(std::setw(8) << std::setfill('*') << 42 << '|' << std::left << std::setw(6) << "ab" << '|');
+    EXPECT_SAME_OUTPUT(text << array << std::string_view("view") << pointer);
+    EXPECT_SAME_OUTPUT(plain_value << ' ' << printed_enum::value << ' ' << static_cast<unsigned char>('x'));
+    EXPECT_SAME_OUTPUT("before " << not_capturable{3} << " after " << std::hex << 255 << 1.5);
+    EXPECT_SAME_OUTPUT(1e300L << ' ' << std::uppercase << std::hexfloat << 0.5 << std::endl);
+}
+
+TEST_F(DeferredMessageTest, captures_supported_arguments_in_binary_form) {
+    logging::record record = ::global_logger::get().open_record(logging::keywords::severity = info);
+    ASSERT_TRUE(record);
+    {
+        detail::deferred_record_stream stream(record);
+        stream << "value " << 1.5 << ' ' << 42;
+        stream.finish();
+    }
+    const auto message = logging::extract<deferred_message>("Message", record.attribute_values());
+    ASSERT_TRUE(message);
+    EXPECT_EQ(message.get().str(), "value 1.5 42");
+}
+
+TEST_F(DeferredMessageTest, unknown_types_switch_to_a_text_message) {
+    logging::record record = ::global_logger::get().open_record(logging::keywords::severity = info);
+    ASSERT_TRUE(record);
+    {
+        detail::deferred_record_stream stream(record);
+        stream << "value " << 1.5 << ' ' << not_capturable{1};
+        stream.finish();
+    }
+    const auto message = logging::extract<std::string>("Message", record.attribute_values());
+    ASSERT_TRUE(message);
+    EXPECT_EQ(message.get(), "value 1.5 not_capturable(1)");
+}
+
+TEST_F(DeferredMessageTest, boost_message_placeholder_renders_deferred_messages) {
+    // sinks set up in code keep the %Message% placeholder Boost.Log interprets itself
+    sink->set_formatter(logging::parse_formatter("%Message%|%EscapedMessage%"));
+
+    EXPECT_SAME_OUTPUT("value " << 1.5 << ' ' << 42 << " \"quoted\"");
+    EVLOG_info << "value " << 42;
+    EXPECT_EQ(take_output(), "value 42|value 42\n");
+}
+
+} // namespace Logging
+} // namespace Everest
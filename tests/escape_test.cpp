@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <escape.hpp>
+
+#include <string>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+/// the escapes of Boost.Log's c_decor, one character at a time
+std::string reference_c_escape(const std::string& text) {
+    std::string escaped;
+    for (const auto character : text) {
+        switch (character) {
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\a':
+            escaped += "\\a";
+            break;
+        case '\b':
+            escaped += "\\b";
+            break;
+        case '\f':
+            escaped += "\\f";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\r':
+            escaped += "\\r";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        case '\v':
+            escaped += "\\v";
+            break;
+        case '\'':
+            escaped += "\\'";
+            break;
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '?':
+            escaped += "\\?";
+            break;
+        default:
+            escaped += character;
+            break;
+        }
+    }
+    return escaped;
+}
+
+template <typename Escape> std::string escape(Escape write, const std::string& text) {
+    std::string escaped;
+    logging::formatting_ostream strm(escaped);
+    write(text, strm);
+    strm.flush();
+    return escaped;
+}
+} // namespace
+
+TEST(EscapeTest, escapes_like_c_decor_at_every_position) {
+    // every character at every position of the vector loop and of the scalar tail
+    for (int character = 0; character < 256; ++character) {
+        for (std::size_t position = 0; position < 40; ++position) {
+            std::string text(40, 'a');
+            text[position] = static_cast<char>(character);
+            ASSERT_EQ(escape(&write_escaped, text), reference_c_escape(text))
+                << "character " << character << " at " << position;
+        }
+    }
+}
+
+TEST(EscapeTest, copies_clean_text) {
+    const std::string text(1000, 'x');
+    EXPECT_EQ(find_c_escape(text.data(), text.data() + text.size()), text.data() + text.size());
+    EXPECT_EQ(find_json_escape(text.data(), text.data() + text.size()), text.data() + text.size());
+    EXPECT_EQ(escape(&write_escaped, text), text);
+    EXPECT_EQ(escape(&write_json_escaped, ""), "");
+}
+
+TEST(EscapeTest, escapes_json_strings) {
+    EXPECT_EQ(escape(&write_json_escaped, "{\"idTag\": \"C:\\\\x\"}\n"), "{\\\"idTag\\\": \\\"C:\\\\\\\\x\\\"}\\n");
+    EXPECT_EQ(escape(&write_json_escaped, std::string("\x01\x1f\b\f\r\t\x7f?'", 9)),
+              "\\u0001\\u001f\\b\\f\\r\\t\x7f?'");
+    // UTF-8 is kept as it is
+    EXPECT_EQ(escape(&write_json_escaped, "Ladesäule \xe2\x9a\xa1"), "Ladesäule \xe2\x9a\xa1");
+
+    for (int character = 0; character < 256; ++character) {
+        for (std::size_t position = 0; position < 40; ++position) {
+            std::string text(40, 'a');
+            text[position] = static_cast<char>(character);
+            const auto found = find_json_escape(text.data(), text.data() + text.size());
+            const bool escaped = character < 0x20 || character == '"' || character == '\\';
+            ASSERT_EQ(found, escaped ? text.data() + position : text.data() + text.size())
+                << "character " << character << " at " << position;
+        }
+    }
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <compiled_format.hpp>
+#include <fd_sink.hpp>
+#include <sinks.hpp>
+
+#include <everest/logging.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/make_shared.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace Everest {
+namespace Logging {
+
+namespace sinks = logging::sinks;
+
+class FdSinkTest : public ConfigFileTest {
+protected:
+    void SetUp() override {
+        init(LIBLOG_TEST_CONFIG);
+        logging::core::get()->remove_all_sinks();
+        file_name = temp_file(".log");
+    }
+
+    void TearDown() override {
+        logging::core::get()->remove_all_sinks();
+        sink.reset();
+        ConfigFileTest::TearDown();
+    }
+
+    void add_sink(const fd_flush_policy& policy) {
+        auto backend = boost::make_shared<fd_backend>(fd_backend::open_file(file_name, false), true, policy);
+        sink = boost::make_shared<sinks::synchronous_sink<fd_backend>>(backend);
+        sink->set_formatter(compile_formatter(rewrite_format_placeholders("%Message%")));
+        logging::core::get()->add_sink(sink);
+    }
+
+    std::string written() const {
+        return read_file(file_name);
+    }
+
+    std::string file_name;
+    boost::shared_ptr<sinks::synchronous_sink<fd_backend>> sink;
+};
+
+TEST_F(FdSinkTest, buffers_records_for_the_flush_interval) {
+    fd_flush_policy policy;
+    policy.interval = std::chrono::milliseconds(100);
+    add_sink(policy);
+
+    const auto logged = std::chrono::steady_clock::now();
+    EVLOG_info << "first";
+    EVLOG_info << "second";
+    EXPECT_EQ(written(), "");
+
+    while (written().empty() && std::chrono::steady_clock::now() - logged < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_GE(std::chrono::steady_clock::now() - logged, policy.interval);
+    EXPECT_EQ(written(), "first\nsecond\n");
+}
+
+TEST_F(FdSinkTest, errors_are_written_right_away) {
+    fd_flush_policy policy;
+    policy.interval = std::chrono::seconds(60);
+    add_sink(policy);
+
+    EVLOG_warning << "warning";
+    EXPECT_EQ(written(), "");
+    EVLOG_error << "error";
+    EXPECT_EQ(written(), "warning\nerror\n");
+}
+
+TEST_F(FdSinkTest, full_buffer_is_written) {
+    fd_flush_policy policy;
+    policy.interval = std::chrono::seconds(60);
+    policy.buffer_size = 16;
+    add_sink(policy);
+
+    EVLOG_info << "1234567";
+    EXPECT_EQ(written(), "");
+    EVLOG_info << "abcdefg";
+    EXPECT_EQ(written(), "1234567\nabcdefg\n");
+
+    // records that don't fit are written without being buffered
+    EVLOG_info << "short";
+    EVLOG_info << "longer than the buffer";
+    EXPECT_EQ(written(), "1234567\nabcdefg\nshort\nlonger than the buffer\n");
+}
+
+TEST_F(FdSinkTest, flush_and_destruction_write_the_buffer) {
+    fd_flush_policy policy;
+    policy.interval = std::chrono::seconds(60);
+    add_sink(policy);
+
+    EVLOG_info << "flushed";
+    logging::core::get()->flush();
+    EXPECT_EQ(written(), "flushed\n");
+
+    EVLOG_info << "destroyed";
+    logging::core::get()->remove_all_sinks();
+    sink.reset();
+    EXPECT_EQ(written(), "flushed\ndestroyed\n");
+}
+
+TEST_F(FdSinkTest, file_destination_is_configurable) {
+    init_with_config("[Core]\nFilter=\"%Severity% >= INFO\"\n[Sinks.File]\nDestination=File\nFileName=\"" + file_name +
+                     "\"\nFormat=\"[%Severity%] %Message%\"\nFlushIntervalMs=60000\nFlushSeverity=WARN\n");
+    EVLOG_info << "info";
+    EVLOG_warning << "warning";
+    EXPECT_NE(written().find("INFO\033[0m] info\n"), std::string::npos);
+    EXPECT_NE(written().find("WARN\033[0m] warning\n"), std::string::npos);
+}
+
+} // namespace Logging
+} // namespace Everest
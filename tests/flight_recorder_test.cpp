@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/utility/setup/filter_parser.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+namespace sinks = logging::sinks;
+
+class FlightRecorderTest : public ConfigFileTest {
+protected:
+    /// initializes logging with a console sink printing only the message and the given [FlightRecorder] settings
+    void init_with_recorder(const std::string& recorder_settings) {
+        boost::log::core::get()->remove_all_sinks();
+        capture_console();
+        init_with_config("[Core]\n"
+                         "Filter=\"%Severity% >= INFO\"\n"
+                         "[Sinks.Console]\n"
+                         "Destination=Console\n"
+                         "Format=\"%Message%\"\n"
+                         "[FlightRecorder]\n" +
+                         recorder_settings);
+        // forget the records of init()
+        dump_flight_recorder();
+        take_output();
+    }
+};
+
+TEST_F(FlightRecorderTest, writes_out_the_last_records_after_an_error) {
+    init_with_recorder("Capacity=3\nTrigger=ERRO\n");
+
+    for (int i = 1; i <= 5; ++i) {
+        EVLOG_verbose << "verbose " << i;
+    }
+    EVLOG_info << "info";
+    EXPECT_EQ(take_output(), "info\n");
+
+    EVLOG_error << "error";
+    EXPECT_EQ(take_output(), "error\nverbose 3\nverbose 4\nverbose 5\n");
+
+    EVLOG_debug << "debug";
+    EVLOG_critical << "critical";
+    EXPECT_EQ(take_output(), "critical\ndebug\n");
+}
+
+TEST_F(FlightRecorderTest, records_only_the_configured_severities) {
+    init_with_recorder("Capacity=10\nSeverity=DEBG\nTrigger=WARN\n");
+
+    EVLOG_verbose << "verbose";
+    EVLOG_debug << "debug";
+    EVLOG_warning << "warning";
+    EXPECT_EQ(take_output(), "warning\ndebug\n");
+}
+
+TEST_F(FlightRecorderTest, sinks_added_in_code_skip_recorded_records_with_the_marker_filter) {
+    init_with_recorder("Capacity=10\nTrigger=ERRO\n");
+
+    std::ostringstream added_output;
+    auto backend = boost::make_shared<sinks::text_ostream_backend>();
+    backend->add_stream(boost::shared_ptr<std::ostream>(&added_output, boost::null_deleter()));
+    auto sink = boost::make_shared<sinks::synchronous_sink<sinks::text_ostream_backend>>(backend);
+    sink->set_filter(logging::parse_filter("not %FlightRecorded%"));
+    sink->set_formatter(logging::parse_formatter("%Message%"));
+    logging::core::get()->add_sink(sink);
+
+    EVLOG_debug << "debug";
+    EVLOG_info << "info";
+    EVLOG_error << "error";
+    logging::core::get()->remove_sink(sink);
+
+    EXPECT_EQ(added_output.str(), "info\nerror\ndebug\n");
+}
+
+TEST_F(FlightRecorderTest, ring_size_limits_the_kept_records) {
+    init_with_recorder("Capacity=100\nRingSize=1024\nTrigger=ERRO\n");
+
+    for (int i = 1; i <= 100; ++i) {
+        EVLOG_verbose << "verbose " << i;
+    }
+    EVLOG_error << "error";
+
+    std::istringstream lines(take_output());
+    std::string line;
+    ASSERT_TRUE(std::getline(lines, line));
+    EXPECT_EQ(line, "error");
+    std::vector<std::string> recorded;
+    while (std::getline(lines, line)) {
+        recorded.push_back(line);
+    }
+    // a record takes more than a few bytes, but the newest ones are kept in order
+    ASSERT_FALSE(recorded.empty());
+    EXPECT_LT(recorded.size(), 100u);
+    for (std::size_t i = 0; i < recorded.size(); ++i) {
+        EXPECT_EQ(recorded[i], "verbose " + std::to_string(101 - recorded.size() + i));
+    }
+}
+
+TEST_F(FlightRecorderTest, records_of_other_threads_are_written_out) {
+    init_with_recorder("Capacity=10\nTrigger=ERRO\n");
+
+    std::thread([]() { EVLOG_debug << "other thread"; }).join();
+    EVLOG_error << "error";
+    EXPECT_EQ(take_output(), "error\nother thread\n");
+}
+
+TEST_F(FlightRecorderTest, evlog_and_throw_writes_out_the_records) {
+    init_with_recorder("Capacity=10\nTrigger=CRIT\n");
+
+    EVLOG_debug << "context";
+    EVLOG_error << "not a trigger";
+    EXPECT_EQ(take_output(), "not a trigger\n");
+
+    EXPECT_THROW(EVLOG_AND_THROW(EverestInternalError("thrown")), EverestInternalError);
+    EXPECT_EQ(take_output(), "context\nthrown\n");
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -2,9 +2,21 @@
 // Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
 #include <gtest/gtest.h>
 
+#include <everest/logging.hpp>
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <sstream>
+
 namespace Everest {
 namespace Logging {
 
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+namespace sinks = logging::sinks;
+
 class LibLogUnitTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -18,5 +30,60 @@ TEST(LibLogUnitTest, test_truth) {
     ASSERT_TRUE(1 == 1);
 }
 
+class CallSiteFormatterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        init(LIBLOG_TEST_CONFIG);
+    }
+
+    void TearDown() override {
+        if (sink) {
+            logging::core::get()->remove_sink(sink);
+        }
+    }
+
+    void add_sink(const std::string& format) {
+        auto backend = boost::make_shared<sinks::text_ostream_backend>();
+        backend->add_stream(boost::shared_ptr<std::ostream>(&output, boost::null_deleter()));
+        sink = boost::make_shared<sinks::synchronous_sink<sinks::text_ostream_backend>>(backend);
+        sink->set_formatter(logging::parse_formatter(format));
+        logging::core::get()->add_sink(sink);
+    }
+
+    std::ostringstream output;
+    boost::shared_ptr<sinks::synchronous_sink<sinks::text_ostream_backend>> sink;
+};
+
+TEST_F(CallSiteFormatterTest, call_site_placeholders) {
+    add_sink("%file%:%line% [%function%] %Message%");
+
+    const auto verbose_line = __LINE__ + 1;
+    EVLOG_verbose << "verbose";
+    EVLOG_info << "info";
+    EVLOG_warning << "warning";
+
+    const std::string function = BOOST_CURRENT_FUNCTION;
+    EXPECT_EQ(output.str(), std::string(__FILE__) + ":" + std::to_string(verbose_line) + " [" + function +
+                                "] verbose\n" + ": [] info\n" + ": [" + function + "] warning\n");
+}
+
+TEST_F(CallSiteFormatterTest, call_site_placeholders_fall_back_to_plain_attributes) {
+    add_sink("%file%:%line% %Message%");
+
+    BOOST_LOG_SEV(::global_logger::get(), info)
+        << logging::add_value("file", std::string("plain.cpp")) << logging::add_value("line", 42) << "plain";
+
+    EXPECT_EQ(output.str(), "plain.cpp:42 plain\n");
+}
+
+TEST(CallSiteTest, ids_are_unique_and_stable) {
+    static call_site first{"a.cpp", 1, "void a()", info, call_site::show_nothing};
+    static call_site second{"b.cpp", 2, "void b()", info, call_site::show_nothing};
+
+    EXPECT_NE(first.id(), 0);
+    EXPECT_NE(first.id(), second.id());
+    EXPECT_EQ(first.id(), first.id());
+}
+
 } // namespace Logging
 } // namespace Everest
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <lockfree_sink.hpp>
+
+#include <everest/logging.hpp>
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace Everest {
+namespace Logging {
+
+namespace sinks = logging::sinks;
+
+class LockfreeSinkTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        if (sink) {
+            logging::core::get()->remove_sink(sink);
+        }
+    }
+
+    void add_sink(std::size_t queue_capacity) {
+        auto backend = boost::make_shared<sinks::text_ostream_backend>();
+        backend->add_stream(boost::shared_ptr<std::ostream>(&output, boost::null_deleter()));
+        auto target = boost::make_shared<sinks::synchronous_sink<sinks::text_ostream_backend>>(backend);
+        sink = boost::make_shared<lockfree_sink>(target, logging::filter(), queue_capacity);
+        logging::core::get()->add_sink(sink);
+    }
+
+    /// logs \p records messages "<thread> <sequence>" from each of \p threads threads
+    static void log_from_threads(int threads, int records) {
+        std::vector<std::thread> producers;
+        for (int t = 0; t < threads; ++t) {
+            producers.emplace_back([t, records]() {
+                for (int i = 0; i < records; ++i) {
+                    BOOST_LOG_SEV(::global_logger::get(), info) << t << " " << i;
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+    }
+
+    /// checks that every thread's records are complete and in order
+    void expect_complete_and_ordered(int threads, int records) {
+        std::map<int, int> next_sequence;
+        std::istringstream lines(output.str());
+        int thread = 0;
+        int sequence = 0;
+        int total = 0;
+        while (lines >> thread >> sequence) {
+            EXPECT_EQ(sequence, next_sequence[thread]) << "out of order record of thread " << thread;
+            next_sequence[thread] = sequence + 1;
+            ++total;
+        }
+        EXPECT_EQ(total, threads * records);
+        for (int t = 0; t < threads; ++t) {
+            EXPECT_EQ(next_sequence[t], records);
+        }
+    }
+
+    std::ostringstream output;
+    boost::shared_ptr<lockfree_sink> sink;
+};
+
+TEST_F(LockfreeSinkTest, keeps_order_within_a_thread) {
+    add_sink(1024);
+    log_from_threads(8, 5000);
+    sink->flush();
+
+    expect_complete_and_ordered(8, 5000);
+}
+
+TEST_F(LockfreeSinkTest, full_rings_delay_but_do_not_lose_records) {
+    add_sink(4);
+    log_from_threads(4, 2000);
+    sink->flush();
+
+    expect_complete_and_ordered(4, 2000);
+}
+
+TEST_F(LockfreeSinkTest, stop_writes_all_queued_records) {
+    add_sink(1 << 16);
+    log_from_threads(4, 10000);
+    sink->stop();
+
+    expect_complete_and_ordered(4, 10000);
+
+    // records after the shutdown are written synchronously
+    BOOST_LOG_SEV(::global_logger::get(), info) << 4 << " " << 0;
+    EXPECT_NE(output.str().find("4 0\n"), std::string::npos);
+}
+
+TEST_F(LockfreeSinkTest, merges_threads_by_time) {
+    add_sink(1024);
+    BOOST_LOG_SEV(::global_logger::get(), info) << "first";
+    std::thread([]() { BOOST_LOG_SEV(::global_logger::get(), info) << "second"; }).join();
+    BOOST_LOG_SEV(::global_logger::get(), info) << "third";
+    sink->flush();
+
+    EXPECT_EQ(output.str(), "first\nsecond\nthird\n");
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <compiled_format.hpp>
+#include <mapped_file_sink.hpp>
+#include <sinks.hpp>
+
+#include <everest/logging.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/make_shared.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Everest {
+namespace Logging {
+
+namespace sinks = logging::sinks;
+
+namespace {
+/// "compresses" a file to its size in decimal
+bool count_bytes(int in_fd, int out_fd, const std::atomic<bool>&) {
+    char chunk[256];
+    std::size_t size = 0;
+    ssize_t length = 0;
+    while ((length = ::read(in_fd, chunk, sizeof(chunk))) > 0) {
+        size += static_cast<std::size_t>(length);
+    }
+    const auto count = std::to_string(size);
+    return length == 0 && ::write(out_fd, count.data(), count.size()) == static_cast<ssize_t>(count.size());
+}
+
+const compression_codec counting_codec{".count", &count_bytes};
+
+std::atomic<bool> stalled_codec_started{false};
+
+/// writes a byte and then waits until it's stopped, like a codec busy with a large file
+bool stall_until_stopped(int, int out_fd, const std::atomic<bool>& stop) {
+    if (::write(out_fd, "x", 1) != 1) {
+        return false;
+    }
+    stalled_codec_started = true;
+    while (!stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+const compression_codec stalled_codec{".stalled", &stall_until_stopped};
+} // namespace
+
+class MappedFileSinkTest : public ConfigFileTest {
+protected:
+    void SetUp() override {
+        init(LIBLOG_TEST_CONFIG);
+        logging::core::get()->remove_all_sinks();
+        settings.file_name = temp_file(".log");
+        settings.segment_size = 32;
+        remove_segments();
+    }
+
+    void TearDown() override {
+        remove_sink();
+        remove_segments();
+        ConfigFileTest::TearDown();
+    }
+
+    void add_sink() {
+        sink = boost::make_shared<sinks::synchronous_sink<mapped_file_backend>>(
+            boost::make_shared<mapped_file_backend>(settings));
+        sink->set_formatter(compile_formatter(rewrite_format_placeholders("%Message%")));
+        logging::core::get()->add_sink(sink);
+    }
+
+    void remove_sink() {
+        logging::core::get()->remove_all_sinks();
+        sink.reset();
+    }
+
+    void remove_segments() {
+        for (std::uint64_t index = 0; index < 20; ++index) {
+            const auto name = mapped_file_backend::segment_name(settings.file_name, index);
+            std::remove(name.c_str());
+            std::remove((name + counting_codec.extension).c_str());
+            std::remove((name + counting_codec.extension + ".tmp").c_str());
+        }
+    }
+
+    bool segment_exists(std::uint64_t index, const std::string& extension = "") const {
+        struct stat status {};
+        return ::stat((mapped_file_backend::segment_name(settings.file_name, index) + extension).c_str(), &status) ==
+               0;
+    }
+
+    /// waits until the compressed segment \p index replaced the plain one
+    bool wait_for_compressed(std::uint64_t index) const {
+        const auto started = std::chrono::steady_clock::now();
+        while (segment_exists(index) || !segment_exists(index, counting_codec.extension)) {
+            if (std::chrono::steady_clock::now() - started > std::chrono::seconds(5)) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    std::string segment(std::uint64_t index, const std::string& extension = "") const {
+        return read_file(mapped_file_backend::segment_name(settings.file_name, index) + extension);
+    }
+
+    mapped_file_settings settings;
+    boost::shared_ptr<sinks::synchronous_sink<mapped_file_backend>> sink;
+};
+
+TEST_F(MappedFileSinkTest, rotates_full_segments) {
+    add_sink();
+    EXPECT_EQ(segment(0).size(), settings.segment_size);
+
+    EVLOG_info << "first record";
+    EVLOG_info << "second record";
+    EVLOG_info << "third record";
+    // the first segment is complete and truncated to its records
+    EXPECT_EQ(segment(0), "first record\nsecond record\n");
+    EXPECT_EQ(segment(1).substr(0, 13), "third record\n");
+
+    remove_sink();
+    EXPECT_EQ(segment(1), "third record\n");
+}
+
+TEST_F(MappedFileSinkTest, continues_after_existing_segments) {
+    add_sink();
+    EVLOG_info << "before restart";
+    remove_sink();
+
+    add_sink();
+    EVLOG_info << "after restart";
+    remove_sink();
+    EXPECT_EQ(segment(0), "before restart\n");
+    EXPECT_EQ(segment(1), "after restart\n");
+}
+
+TEST_F(MappedFileSinkTest, trims_segment_of_crashed_process) {
+    {
+        std::ofstream crashed(mapped_file_backend::segment_name(settings.file_name, 3));
+        crashed << "written" << std::string(100, '\0');
+    }
+    add_sink();
+    EXPECT_EQ(segment(3), "written");
+    EXPECT_TRUE(segment_exists(4));
+}
+
+TEST_F(MappedFileSinkTest, keeps_max_files) {
+    settings.max_files = 2;
+    add_sink();
+    for (int i = 0; i < 5; ++i) {
+        EVLOG_info << "record number " << i << " fills a segment";
+    }
+    // every record fills a segment, the current one counts as a file
+    EXPECT_FALSE(segment_exists(2));
+    EXPECT_TRUE(segment_exists(3));
+    EXPECT_TRUE(segment_exists(4));
+}
+
+TEST_F(MappedFileSinkTest, keeps_max_total_size) {
+    settings.max_total_size = 64;
+    add_sink();
+    for (int i = 0; i < 5; ++i) {
+        EVLOG_info << "record " << i << " twice";
+    }
+    // the segment being written counts with its full size
+    EXPECT_FALSE(segment_exists(0));
+    EXPECT_EQ(segment(1), "record 2 twice\nrecord 3 twice\n");
+    EXPECT_TRUE(segment_exists(2));
+}
+
+TEST_F(MappedFileSinkTest, cuts_records_larger_than_a_segment) {
+    add_sink();
+    EVLOG_info << std::string(40, 'x');
+    EVLOG_info << "next";
+    EXPECT_EQ(segment(0), std::string(32, 'x'));
+    EXPECT_EQ(segment(1).substr(0, 5), "next\n");
+}
+
+TEST_F(MappedFileSinkTest, compresses_complete_segments) {
+    settings.codec = &counting_codec;
+    add_sink();
+    EVLOG_info << "first record";
+    EVLOG_info << "second record";
+    EVLOG_info << "third record";
+
+    ASSERT_TRUE(wait_for_compressed(0));
+    EXPECT_EQ(segment(0, counting_codec.extension), "27");
+    // the segment being written stays as it is
+    EXPECT_TRUE(segment_exists(1));
+    EXPECT_FALSE(segment_exists(1, counting_codec.extension));
+}
+
+TEST_F(MappedFileSinkTest, retention_counts_compressed_sizes) {
+    settings.codec = &counting_codec;
+    settings.max_total_size = 70;
+    add_sink();
+    EVLOG_info << "record number 0 fills a segment";
+    EVLOG_info << "record number 1 fills a segment";
+    ASSERT_TRUE(wait_for_compressed(0));
+
+    // 2 bytes of segment 0, 32 of the plain segment 1 and 32 of the new one
+    EVLOG_info << "record number 2 fills a segment";
+    EXPECT_TRUE(segment_exists(0, counting_codec.extension));
+    EXPECT_TRUE(segment_exists(1) || segment_exists(1, counting_codec.extension));
+}
+
+TEST_F(MappedFileSinkTest, compresses_segments_of_previous_process) {
+    {
+        std::ofstream plain(mapped_file_backend::segment_name(settings.file_name, 2));
+        plain << "left uncompressed";
+        std::ofstream incomplete(mapped_file_backend::segment_name(settings.file_name, 3) +
+                                 counting_codec.extension + ".tmp");
+        incomplete << "interrupted";
+    }
+    settings.codec = &counting_codec;
+    add_sink();
+
+    ASSERT_TRUE(wait_for_compressed(2));
+    EXPECT_EQ(segment(2, counting_codec.extension), "17");
+    EXPECT_FALSE(segment_exists(3, std::string(counting_codec.extension) + ".tmp"));
+    EXPECT_TRUE(segment_exists(3));
+}
+
+TEST_F(MappedFileSinkTest, destroyed_compressor_gives_up_the_running_file) {
+    const auto file = temp_file(".log");
+    const auto temporary = file + stalled_codec.extension + ".tmp";
+    write_file(file, "segment");
+    stalled_codec_started = false;
+    {
+        segment_compressor compressor(stalled_codec, 1);
+        compressor.compress(file);
+        const auto started = std::chrono::steady_clock::now();
+        while (!stalled_codec_started && std::chrono::steady_clock::now() - started < std::chrono::seconds(5)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_TRUE(stalled_codec_started);
+    }
+
+    struct stat status {};
+    EXPECT_NE(::stat(temporary.c_str(), &status), 0);
+    EXPECT_EQ(read_file(file), "segment");
+}
+
+TEST_F(MappedFileSinkTest, mapped_file_destination_is_configurable) {
+    init_with_config("[Core]\nFilter=\"%Severity% >= INFO\"\n[Sinks.MappedFile]\nDestination=MappedFile\nFileName=\"" +
+                     settings.file_name + "\"\nFormat=\"%Message%\"\nSegmentSize=4096\nMaxFiles=3\n");
+    EVLOG_info << "mapped";
+    init(LIBLOG_TEST_CONFIG);
+
+    EXPECT_EQ(segment(0), "mapped\n");
+}
+
+} // namespace Logging
+} // namespace Everest
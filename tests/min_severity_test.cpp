@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+// this translation unit is built with a raised compile-time floor, regardless of the CMake configuration
+#undef LIBLOG_MIN_SEVERITY
+#define LIBLOG_MIN_SEVERITY 2
+
+#include <everest/logging.hpp>
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <sstream>
+
+namespace Everest {
+namespace Logging {
+
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+namespace sinks = logging::sinks;
+
+class MinSeverityTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto backend = boost::make_shared<sinks::text_ostream_backend>();
+        backend->add_stream(boost::shared_ptr<std::ostream>(&output, boost::null_deleter()));
+        sink = boost::make_shared<sinks::synchronous_sink<sinks::text_ostream_backend>>(backend);
+        logging::core::get()->add_sink(sink);
+    }
+
+    void TearDown() override {
+        logging::core::get()->remove_sink(sink);
+    }
+
+    std::ostringstream output;
+    boost::shared_ptr<sinks::synchronous_sink<sinks::text_ostream_backend>> sink;
+};
+
+TEST_F(MinSeverityTest, call_sites_below_floor_are_not_evaluated) {
+    int evaluated = 0;
+    auto side_effect = [&evaluated]() { return ++evaluated; };
+
+    EVLOG_verbose << "verbose " << side_effect();
+    EVLOG_debug << "debug " << side_effect();
+    EXPECT_EQ(evaluated, 0);
+
+    EVLOG_info << "info " << side_effect();
+    EVLOG_critical << "critical " << side_effect();
+    EXPECT_EQ(evaluated, 2);
+    EXPECT_EQ(output.str(), "info 1\ncritical 2\n");
+}
+
+TEST_F(MinSeverityTest, compiled_out_call_site_keeps_statement_structure) {
+    bool else_taken = false;
+    if (output.str().empty())
+        EVLOG_debug << "compiled out";
+    else
+        else_taken = true;
+
+    EXPECT_FALSE(else_taken);
+    EXPECT_TRUE(output.str().empty());
+}
+
+} // namespace Logging
+} // namespace Everest
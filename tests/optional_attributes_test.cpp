@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <optional_attributes.hpp>
+
+#include <boost/log/attributes/named_scope.hpp>
+#include <boost/log/attributes/value_extraction.hpp>
+#include <boost/log/utility/setup/settings_parser.hpp>
+#include <sstream>
+#include <string>
+
+#include <everest/exceptions.hpp>
+
+namespace Everest {
+namespace Logging {
+
+namespace attrs = logging::attributes;
+
+namespace {
+optional_attributes from_config(const std::string& config) {
+    std::istringstream stream(config);
+    return optional_attributes::from_settings(logging::parse_settings(stream));
+}
+
+std::string scope_names(const logging::attribute_value& value) {
+    std::string names;
+    for (const auto& entry : value.extract_or_throw<attrs::named_scope_list>()) {
+        names += entry.scope_name.c_str();
+        names += ";";
+    }
+    return names;
+}
+} // namespace
+
+TEST(OptionalAttributesTest, nothing_is_installed_without_references) {
+    const auto selected = from_config("[Sinks.Console]\nDestination=Console\nFormat=\"%TimeStamp% %Message%\"\n");
+    EXPECT_FALSE(selected.thread_id);
+    EXPECT_FALSE(selected.process_id);
+    EXPECT_FALSE(selected.scope);
+}
+
+TEST(OptionalAttributesTest, formats_and_filters_select_attributes) {
+    const auto selected = from_config("[Core]\nFilter=\"%ProcessID% != 0\"\n"
+                                      "[Sinks.Console]\nDestination=Console\nFormat=\"%Scope(format=\\\"%n\\\")% %Message%\"\n"
+                                      "[Sinks.File]\nDestination=TextFile\nFilter=\"%ThreadID% != 0\"\n");
+    EXPECT_TRUE(selected.thread_id);
+    EXPECT_TRUE(selected.process_id);
+    EXPECT_TRUE(selected.scope);
+}
+
+TEST(OptionalAttributesTest, similar_names_dont_select_attributes) {
+    const auto selected = from_config("[Sinks.Console]\nDestination=Console\nFormat=\"%ThreadIDs% %ScopeName% %Message%\"\n");
+    EXPECT_FALSE(selected.thread_id);
+    EXPECT_FALSE(selected.scope);
+}
+
+TEST(OptionalAttributesTest, binary_sinks_keep_thread_and_process_id) {
+    const auto selected = from_config("[Sinks.Binary]\nDestination=BinaryFile\nFileName=log.bin\n");
+    EXPECT_TRUE(selected.thread_id);
+    EXPECT_TRUE(selected.process_id);
+    EXPECT_FALSE(selected.scope);
+}
+
+TEST(OptionalAttributesTest, always_selects_attributes) {
+    const auto selected = from_config("[Attributes]\nAlways=\"Scope, ThreadID\"\n");
+    EXPECT_TRUE(selected.thread_id);
+    EXPECT_FALSE(selected.process_id);
+    EXPECT_TRUE(selected.scope);
+
+    EXPECT_THROW(from_config("[Attributes]\nAlways=\"Scope,LineNumber\"\n"), EverestConfigError);
+}
+
+TEST(OptionalAttributesTest, lazy_scope_has_the_scopes_of_the_thread) {
+    lazy_named_scope scope;
+    BOOST_LOG_NAMED_SCOPE("outer");
+    logging::attribute_value detached;
+    {
+        BOOST_LOG_NAMED_SCOPE("inner");
+        const auto value = scope.get_value();
+        EXPECT_EQ(scope_names(value), "outer;inner;");
+
+        detached = value;
+        detached.detach_from_thread();
+    }
+    // the detached value is a copy, it outlives the scope
+    EXPECT_EQ(scope_names(detached), "outer;inner;");
+    EXPECT_EQ(scope_names(scope.get_value()), "outer;");
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <compiled_format.hpp>
+#include <overflow_queue.hpp>
+#include <sinks.hpp>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include "test_helpers.hpp"
+
+#include <atomic>
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/make_shared.hpp>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace Everest {
+namespace Logging {
+
+namespace sinks = logging::sinks;
+
+class OverflowQueueTest : public ::testing::Test {
+protected:
+    using sink_type = overflow_sink<sinks::text_ostream_backend>;
+
+    void SetUp() override {
+        init(LIBLOG_TEST_CONFIG);
+        logging::core::get()->remove_all_sinks();
+    }
+
+    void TearDown() override {
+        logging::core::get()->remove_all_sinks();
+        sink.reset();
+    }
+
+    /// adds a sink without a feeding thread, records stay queued until take_output()
+    void add_sink(const overflow_policy& policy) {
+        auto backend = boost::make_shared<sinks::text_ostream_backend>();
+        backend->add_stream(boost::shared_ptr<std::ostream>(&output, boost::null_deleter()));
+        backend->auto_flush(true);
+        sink = boost::make_shared<sink_type>(backend, false);
+        sink->set_overflow_policy(policy);
+        sink->set_formatter(compile_formatter(rewrite_format_placeholders("%Message%")));
+        logging::core::get()->add_sink(sink);
+    }
+
+    std::string take_output() {
+        sink->feed_records();
+        auto text = output.str();
+        output.str("");
+        return text;
+    }
+
+    std::ostringstream output;
+    boost::shared_ptr<sink_type> sink;
+};
+
+TEST_F(OverflowQueueTest, drop_newest_drops_records_that_dont_fit) {
+    add_sink({2, overflow_action::drop_newest});
+    const auto dropped_before = dropped_records(info);
+
+    EVLOG_info << "first";
+    EVLOG_info << "second";
+    EVLOG_info << "third";
+    EXPECT_EQ(take_output(), "1 records dropped, the sink queue was full\nfirst\nsecond\n");
+    EXPECT_EQ(sink->dropped(info), 1);
+    EXPECT_EQ(dropped_records(info), dropped_before + 1);
+}
+
+TEST_F(OverflowQueueTest, drop_oldest_makes_room) {
+    add_sink({2, overflow_action::drop_oldest, info, std::chrono::hours(1)});
+
+    EVLOG_info << "first";
+    EVLOG_info << "second";
+    EVLOG_info << "third";
+    EXPECT_EQ(take_output(), "1 records dropped, the sink queue was full\nsecond\nthird\n");
+
+    // the next report is due in an hour
+    EVLOG_info << "fourth";
+    EVLOG_info << "fifth";
+    EVLOG_info << "sixth";
+    EXPECT_EQ(take_output(), "fifth\nsixth\n");
+    EXPECT_EQ(sink->dropped(info), 2);
+}
+
+TEST_F(OverflowQueueTest, drop_below_severity_keeps_important_records) {
+    add_sink({2, overflow_action::drop_below_severity, warning});
+
+    EVLOG_debug << "debug";
+    EVLOG_info << "info";
+    EVLOG_warning << "replaces debug";
+    EVLOG_debug << "dropped";
+    EVLOG_error << "replaces info";
+    EXPECT_EQ(take_output(), "3 records dropped, the sink queue was full\nreplaces debug\nreplaces info\n");
+    EXPECT_EQ(sink->dropped(debug), 2);
+    EXPECT_EQ(sink->dropped(info), 1);
+    EXPECT_EQ(sink->dropped(warning), 0);
+}
+
+TEST_F(OverflowQueueTest, block_waits_for_room) {
+    add_sink({1, overflow_action::block});
+
+    EVLOG_info << "first";
+    std::atomic<bool> logged{false};
+    std::thread producer([&logged] {
+        EVLOG_info << "second";
+        logged = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(logged);
+
+    std::string written;
+    while (!logged) {
+        written += take_output();
+        std::this_thread::yield();
+    }
+    producer.join();
+    written += take_output();
+    EXPECT_EQ(written, "first\nsecond\n");
+}
+
+TEST_F(OverflowQueueTest, flush_keeps_blocked_records) {
+    std::ostringstream written;
+    auto backend = boost::make_shared<sinks::text_ostream_backend>();
+    backend->add_stream(boost::shared_ptr<std::ostream>(&written, boost::null_deleter()));
+    // with a feeding thread, which flush() interrupts
+    auto fed_sink = boost::make_shared<sink_type>(backend);
+    fed_sink->set_overflow_policy({1, overflow_action::block});
+    fed_sink->set_formatter(compile_formatter(rewrite_format_placeholders("%Message%")));
+    logging::core::get()->add_sink(fed_sink);
+
+    std::atomic<bool> logged{false};
+    std::thread producer;
+    std::thread flusher;
+    {
+        // the feeding thread takes the first record and waits for the backend, the second one fills the queue
+        auto locked = fed_sink->locked_backend();
+        EVLOG_info << "first";
+        EVLOG_info << "second";
+        producer = std::thread([&logged] {
+            EVLOG_info << "third";
+            logged = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        flusher = std::thread([&fed_sink] { fed_sink->flush(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_FALSE(logged);
+    }
+    producer.join();
+    flusher.join();
+    fed_sink->flush();
+    logging::core::get()->remove_sink(fed_sink);
+    fed_sink->stop();
+
+    EXPECT_EQ(written.str(), "first\nsecond\nthird\n");
+    EXPECT_EQ(fed_sink->dropped(info), 0);
+}
+
+TEST_F(OverflowQueueTest, stop_releases_blocked_producers) {
+    add_sink({1, overflow_action::block});
+
+    EVLOG_info << "first";
+    std::thread producer([] { EVLOG_info << "dropped"; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sink->stop();
+    producer.join();
+    EXPECT_EQ(sink->dropped(info), 1);
+}
+
+TEST_F(OverflowQueueTest, overflow_policy_is_configurable) {
+    const auto config_file = unique_temp_file(".ini");
+    const auto write_config = [&config_file](const std::string& sink_settings) {
+        write_file(config_file, "[Core]\nFilter=\"%Severity% >= INFO\"\n"
+                                "[Sinks.Console]\nDestination=Console\nFormat=\"%Message%\"\n" +
+                                    sink_settings);
+    };
+
+    write_config("Asynchronous=true\nOverflowPolicy=DropBelowSeverity\nOverflowSeverity=WARN\nQueueCapacity=16\n");
+    EXPECT_NO_THROW(init(config_file));
+    write_config("Asynchronous=true\nOverflowPolicy=Discard\n");
+    EXPECT_THROW(init(config_file), EverestConfigError);
+    write_config("Backend=lockfree\nOverflowPolicy=DropNewest\n");
+    EXPECT_THROW(init(config_file), EverestConfigError);
+
+    init(LIBLOG_TEST_CONFIG);
+    std::remove(config_file.c_str());
+}
+
+} // namespace Logging
+} // namespace Everest
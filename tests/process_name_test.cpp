@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <process_name.hpp>
+
+#include <boost/log/attributes/value_extraction.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+std::string read(const process_name_attribute& attribute) {
+    return attribute.get_value().extract_or_throw<std::string>();
+}
+} // namespace
+
+TEST(ProcessNameTest, reads_the_current_name) {
+    process_name_attribute process_name("first          ");
+    EXPECT_EQ(read(process_name), "first          ");
+    EXPECT_EQ(process_name.get(), "first          ");
+
+    process_name.set("second         ");
+    EXPECT_EQ(read(process_name), "second         ");
+    EXPECT_EQ(process_name.get(), "second         ");
+}
+
+TEST(ProcessNameTest, attributes_have_their_own_names) {
+    process_name_attribute first("first");
+    process_name_attribute second("second");
+
+    // each thread caches the value it has read last
+    EXPECT_EQ(read(first), "first");
+    EXPECT_EQ(read(second), "second");
+    EXPECT_EQ(read(first), "first");
+}
+
+TEST(ProcessNameTest, readers_see_every_update) {
+    process_name_attribute process_name("name 0");
+    std::atomic<bool> stop{false};
+    std::atomic<int> invalid{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            while (!stop.load()) {
+                const auto name = read(process_name);
+                if (name.rfind("name ", 0) != 0) {
+                    ++invalid;
+                }
+            }
+        });
+    }
+    for (int i = 1; i <= 1000; ++i) {
+        process_name.set("name " + std::to_string(i));
+    }
+    // the last name is seen by every thread reading after the update
+    std::thread late_reader([&] {
+        if (read(process_name) != "name 1000") {
+            ++invalid;
+        }
+    });
+    late_reader.join();
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(invalid.load(), 0);
+}
+
+} // namespace Logging
+} // namespace Everest
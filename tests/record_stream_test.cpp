@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <compiled_format.hpp>
+#include <sinks.hpp>
+
+#include <everest/logging.hpp>
+
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/make_shared.hpp>
+#include <iomanip>
+#include <string>
+#include <thread>
+
+namespace Everest {
+namespace Logging {
+
+namespace sinks = logging::sinks;
+
+namespace {
+/// keeps the last formatted record
+class last_record_backend : public sinks::basic_formatted_sink_backend<char> {
+public:
+    void consume(const logging::record_view&, const std::string& formatted) {
+        last.assign(formatted);
+    }
+
+    std::string last;
+};
+} // namespace
+
+class RecordStreamTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        init(LIBLOG_TEST_CONFIG);
+        logging::core::get()->remove_all_sinks();
+        backend = boost::make_shared<last_record_backend>();
+        auto sink = boost::make_shared<sinks::synchronous_sink<last_record_backend>>(backend);
+        sink->set_formatter(
+            compile_formatter(rewrite_format_placeholders("%TimeStamp% [%Severity%] {%ThreadID%} %Scope% %Message%")));
+        logging::core::get()->add_sink(sink);
+    }
+
+    void TearDown() override {
+        logging::core::get()->remove_all_sinks();
+    }
+
+    boost::shared_ptr<last_record_backend> backend;
+};
+
+TEST_F(RecordStreamTest, every_message_starts_with_default_formatting) {
+    EVLOG_info << std::hex << std::setfill('0') << std::setw(4) << 42;
+    EXPECT_NE(backend->last.find(" 002a"), std::string::npos);
+
+    EVLOG_info << 42 << ' ' << 1.0 / 3;
+    EXPECT_NE(backend->last.find(" 42 0.333333"), std::string::npos);
+}
+
+TEST_F(RecordStreamTest, nested_records_have_their_own_messages) {
+    struct nested {
+        static std::string log() {
+            EVLOG_info << "inner";
+            return "argument";
+        }
+    };
+
+    EVLOG_info << "outer " << nested::log() << " done";
+    EXPECT_NE(backend->last.find("outer argument done"), std::string::npos);
+}
+
+TEST_F(RecordStreamTest, records_outlive_threads) {
+    for (int i = 0; i < 4; ++i) {
+        std::thread([i] { EVLOG_info << "thread " << i; }).join();
+        EXPECT_NE(backend->last.find("thread " + std::to_string(i)), std::string::npos);
+    }
+}
+
+} // namespace Logging
+} // namespace Everest
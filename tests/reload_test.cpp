@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Everest {
+namespace Logging {
+
+class ReloadTest : public ConfigFileTest {
+protected:
+    void SetUp() override {
+        boost::log::core::get()->remove_all_sinks();
+        capture_console();
+    }
+
+    /// writes a configuration with a console sink of the given settings, replacing the file like an editor does
+    void write_config(const std::string& core_filter, const std::string& console_settings,
+                      const std::string& other_sections = "") {
+        ConfigFileTest::write_config("[Core]\nFilter=\"" + core_filter + "\"\n[Sinks.Console]\nDestination=Console\n" +
+                                     console_settings + other_sections);
+    }
+};
+
+TEST_F(ReloadTest, applies_changed_filter_format_and_colors) {
+    write_config("%Severity% >= INFO", "Format=\"%Message%\"\n");
+    init(config_file);
+    EVLOG_debug << "debug";
+    EVLOG_info << "info";
+    EXPECT_EQ(take_output(), "info\n");
+
+    write_config("%Severity% >= DEBG", "Format=\"[%Severity%] %Message%\"\nSeverityStringColorDebug=\"<color>\"\n");
+    reload();
+    take_output();
+    EVLOG_verbose << "verbose";
+    EVLOG_debug << "debug";
+    EXPECT_EQ(take_output(), "[<color>DEBG\033[0m] debug\n");
+}
+
+TEST_F(ReloadTest, invalid_file_keeps_current_settings) {
+    write_config("%Severity% >= INFO", "Format=\"%Message%\"\n");
+    init(config_file);
+    take_output();
+
+    write_config("%Severity% >= INFO", "Format=\"changed %Message%\"\nBackend=unknown\n");
+    EXPECT_THROW(reload(), EverestConfigError);
+    write_config("%Severity% >= DEBG", "Format=\"changed %Message%\"\n", "[CallSites]\nDefault=LOUD\n");
+    EXPECT_THROW(reload(), EverestConfigError);
+
+    EVLOG_debug << "debug";
+    EVLOG_info << "info";
+    EXPECT_EQ(take_output(), "info\n");
+}
+
+TEST_F(ReloadTest, rejected_reload_leaves_files_alone) {
+    const auto log_file = temp_file(".log");
+    write_file(log_file, "kept\n");
+    write_config("%Severity% >= INFO", "Format=\"%Message%\"\n");
+    init(config_file);
+
+    // the new File sink would truncate the file, the invalid sink after it rejects the reload
+    write_config("%Severity% >= INFO", "Format=\"%Message%\"\n",
+                 "[Sinks.File]\nDestination=File\nFileName=\"" + log_file + "\"\n" +
+                     "[Sinks.Invalid]\nDestination=Console\nBackend=unknown\n");
+    EXPECT_THROW(reload(), EverestConfigError);
+
+    EXPECT_EQ(read_file(log_file), "kept\n");
+}
+
+TEST_F(ReloadTest, recreated_file_sink_keeps_the_file) {
+    const auto log_file = temp_file(".log");
+    const auto file_section = "[Sinks.File]\nDestination=File\nFileName=\"" + log_file + "\"\nFormat=\"%Message%\"\n";
+    write_config("%Severity% >= INFO", "Format=\"%Message%\"\n", file_section + "AutoFlush=true\n");
+    init(config_file);
+    EVLOG_info << "before";
+
+    // a changed buffer size recreates the sink
+    write_config("%Severity% >= INFO", "Format=\"%Message%\"\n", file_section + "AutoFlush=true\nBufferSize=1024\n");
+    reload();
+    EVLOG_info << "after";
+    boost::log::core::get()->flush();
+
+    EXPECT_EQ(read_file(log_file), "before\nafter\n");
+}
+
+TEST_F(ReloadTest, changed_colors_keep_the_sink) {
+    const auto log_file = temp_file(".log");
+    const auto file_section = "[Sinks.File]\nDestination=File\nFileName=\"" + log_file +
+                              "\"\nFormat=\"%Message%\"\nFlushIntervalMs=60000\n";
+    write_config("%Severity% >= INFO", "Format=\"%Message%\"\n", file_section);
+    init(config_file);
+    EVLOG_info << "buffered";
+
+    // a recreated sink would write the record when the replaced one is flushed
+    write_config("%Severity% >= INFO", "Format=\"%Message%\"\n",
+                 file_section + "SeverityStringColorInfo=\"<color>\"\n");
+    reload();
+    EXPECT_EQ(read_file(log_file), "");
+
+    boost::log::core::get()->flush();
+    EXPECT_EQ(read_file(log_file), "buffered\n");
+}
+
+TEST_F(ReloadTest, records_are_not_lost_while_reloading) {
+    constexpr int threads = 4;
+    constexpr int records = 20000;
+    constexpr int reloads = 20;
+
+    write_config("%Severity% >= INFO", "Format=\"a %Message%\"\nBackend=lockfree\n");
+    init(config_file);
+    take_output();
+
+    std::atomic<bool> started{false};
+    std::vector<std::thread> producers;
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([t, &started]() {
+            started = true;
+            for (int i = 0; i < records; ++i) {
+                EVLOG_info << t << " " << i;
+            }
+        });
+    }
+    while (!started) {
+        std::this_thread::yield();
+    }
+
+    std::chrono::steady_clock::duration slowest_reload{};
+    for (int r = 1; r <= reloads; ++r) {
+        write_config("%Severity% >= INFO",
+                     std::string("Format=\"") + (r % 2 == 0 ? "a" : "b") + " %Message%\"\nBackend=lockfree\n");
+        const auto reload_start = std::chrono::steady_clock::now();
+        reload();
+        slowest_reload = std::max(slowest_reload, std::chrono::steady_clock::now() - reload_start);
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    boost::log::core::get()->flush();
+
+    const auto slowest_reload_us = std::chrono::duration_cast<std::chrono::microseconds>(slowest_reload).count();
+    const auto elapsed_s = std::chrono::duration<double>(elapsed).count();
+    RecordProperty("slowest_reload_us", std::to_string(slowest_reload_us));
+    RecordProperty("records_per_second", std::to_string(static_cast<long long>(threads * records / elapsed_s)));
+    EXPECT_LT(slowest_reload, std::chrono::seconds(1));
+
+    std::map<int, std::vector<int>> seen;
+    std::istringstream lines(take_output());
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream fields(line);
+        std::string format;
+        int thread = 0;
+        int sequence = 0;
+        if (fields >> format >> thread >> sequence) {
+            ASSERT_TRUE(format == "a" || format == "b") << line;
+            seen[thread].push_back(sequence);
+        }
+    }
+    ASSERT_EQ(seen.size(), static_cast<std::size_t>(threads));
+    for (const auto& thread : seen) {
+        ASSERT_EQ(thread.second.size(), static_cast<std::size_t>(records)) << "thread " << thread.first;
+        for (int i = 0; i < records; ++i) {
+            ASSERT_EQ(thread.second[i], i) << "thread " << thread.first;
+        }
+    }
+}
+
+TEST_F(ReloadTest, recreated_sinks_write_every_record_once) {
+    constexpr int threads = 4;
+    constexpr int records = 5000;
+    constexpr int reloads = 20;
+
+    const auto log_file = temp_file(".log");
+    const auto sections = [&log_file](int r) {
+        // switching Asynchronous and BufferSize recreates both sinks
+        const std::string asynchronous = r % 2 == 0 ? "false" : "true";
+        return std::make_pair("Format=\"%Message%\"\nAsynchronous=" + asynchronous + "\n",
+                              "[Sinks.File]\nDestination=File\nFileName=\"" + log_file +
+                                  "\"\nFormat=\"%Message%\"\nBufferSize=" + std::to_string(1024 * (r % 2 + 1)) + "\n");
+    };
+    write_config("%Severity% >= INFO", sections(0).first, sections(0).second);
+    init(config_file);
+    take_output();
+
+    std::atomic<bool> started{false};
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([t, &started]() {
+            started = true;
+            for (int i = 0; i < records; ++i) {
+                EVLOG_info << t << " " << i;
+            }
+        });
+    }
+    while (!started) {
+        std::this_thread::yield();
+    }
+    for (int r = 1; r <= reloads; ++r) {
+        write_config("%Severity% >= INFO", sections(r).first, sections(r).second);
+        reload();
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    boost::log::core::get()->flush();
+
+    // a replaced sink might still write its queued records after the new one started, only the order can differ
+    for (const auto& output : {take_output(), read_file(log_file)}) {
+        std::map<int, std::vector<int>> seen;
+        std::istringstream lines(output);
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::istringstream fields(line);
+            int thread = 0;
+            int sequence = 0;
+            if (fields >> thread >> sequence) {
+                seen[thread].push_back(sequence);
+            }
+        }
+        ASSERT_EQ(seen.size(), static_cast<std::size_t>(threads));
+        for (auto& thread : seen) {
+            std::sort(thread.second.begin(), thread.second.end());
+            ASSERT_EQ(thread.second.size(), static_cast<std::size_t>(records)) << "thread " << thread.first;
+            for (int i = 0; i < records; ++i) {
+                ASSERT_EQ(thread.second[i], i) << "thread " << thread.first;
+            }
+        }
+    }
+}
+
+TEST_F(ReloadTest, watched_file_is_reloaded_on_change) {
+    write_config("%Severity% >= INFO", "Format=\"%Message%\"\n", "[Reload]\nWatch=true\n");
+    init(config_file);
+    take_output();
+
+    write_config("%Severity% >= INFO", "Format=\"changed %Message%\"\n", "[Reload]\nWatch=true\n");
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    bool reloaded = false;
+    while (!reloaded && std::chrono::steady_clock::now() < deadline) {
+        EVLOG_info << "probe";
+        reloaded = take_output().find("changed probe") != std::string::npos;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(reloaded);
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <shm_aggregator.hpp>
+#include <shm_sink.hpp>
+
+#include <everest/logging.hpp>
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/attributes/current_process_id.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace Everest {
+namespace Logging {
+
+namespace sinks = logging::sinks;
+
+class ShmSinkTest : public ::testing::Test {
+protected:
+    using shm_sink = sinks::synchronous_sink<shm_backend>;
+    using text_sink = sinks::synchronous_sink<sinks::text_ostream_backend>;
+
+    void SetUp() override {
+        init(LIBLOG_TEST_CONFIG);
+        logging::core::get()->remove_all_sinks();
+        segment = "liblog_test_" + std::to_string(::getpid());
+    }
+
+    void TearDown() override {
+        logging::core::get()->remove_all_sinks();
+        ::shm_unlink(shm_backend::ring_name(segment, static_cast<std::uint32_t>(::getpid())).c_str());
+    }
+
+    boost::shared_ptr<shm_sink> add_shm_sink(std::size_t ring_size) {
+        auto sink = boost::make_shared<shm_sink>(boost::make_shared<shm_backend>(segment, ring_size));
+        logging::core::get()->add_sink(sink);
+        return sink;
+    }
+
+    void add_output_sink() {
+        auto backend = boost::make_shared<sinks::text_ostream_backend>();
+        backend->add_stream(boost::shared_ptr<std::ostream>(&output, boost::null_deleter()));
+        auto sink = boost::make_shared<text_sink>(backend);
+        sink->set_formatter(logging::parse_formatter("%ProcessID% %Message%"));
+        logging::core::get()->add_sink(sink);
+    }
+
+    std::string segment;
+    std::ostringstream output;
+};
+
+TEST_F(ShmSinkTest, aggregates_records_of_this_process) {
+    auto sink = add_shm_sink(64 * 1024);
+    for (int i = 0; i < 10; ++i) {
+        EVLOG_info << "record " << i;
+    }
+    logging::core::get()->remove_sink(sink);
+    sink.reset();
+
+    add_output_sink();
+    shm_aggregator aggregator(segment, std::chrono::milliseconds(0));
+    EXPECT_EQ(aggregator.poll(), 10);
+    EXPECT_EQ(aggregator.sources(), 0) << "the ring of a closed sink is removed once drained";
+
+    std::ostringstream expected;
+    for (int i = 0; i < 10; ++i) {
+        expected << "0x" << std::hex << std::setw(8) << std::setfill('0') << ::getpid() << std::dec << " record " << i
+                 << "\n";
+    }
+    EXPECT_EQ(output.str(), expected.str());
+}
+
+TEST_F(ShmSinkTest, recreated_sinks_keep_reaching_the_aggregator) {
+    auto sink = add_shm_sink(64 * 1024);
+    shm_aggregator aggregator(segment, std::chrono::milliseconds(0));
+    EXPECT_EQ(aggregator.poll(), 0);
+    EXPECT_EQ(aggregator.sources(), 1);
+    EVLOG_info << "before";
+
+    // like a reload, the replacement is created under the same name before the old sink is removed
+    auto replacement = add_shm_sink(64 * 1024);
+    logging::core::get()->remove_sink(sink);
+    sink.reset();
+    EVLOG_info << "after";
+    logging::core::get()->remove_sink(replacement);
+
+    add_output_sink();
+    EXPECT_EQ(aggregator.poll(), 1);
+    EXPECT_EQ(aggregator.sources(), 0);
+    EXPECT_EQ(aggregator.poll(), 1) << "removing the old ring must not unlink the segment of the replacement";
+    EXPECT_EQ(aggregator.sources(), 1);
+    EXPECT_NE(output.str().find("before"), std::string::npos);
+    EXPECT_NE(output.str().find("after"), std::string::npos);
+}
+
+TEST_F(ShmSinkTest, merges_processes_in_order) {
+    constexpr int processes = 3;
+    constexpr int records = 200;
+
+    std::vector<pid_t> children;
+    for (int p = 0; p < processes; ++p) {
+        const auto child = ::fork();
+        ASSERT_NE(child, -1);
+        if (child == 0) {
+            // the ProcessID attribute is a constant, a forked process would still report the one of its parent
+            auto attributes = logging::core::get()->get_global_attributes();
+            attributes.erase("ProcessID");
+            attributes.insert("ProcessID", logging::attributes::current_process_id());
+            logging::core::get()->set_global_attributes(attributes);
+            logging::core::get()->remove_all_sinks();
+            add_shm_sink(64 * 1024);
+            for (int i = 0; i < records; ++i) {
+                EVLOG_info << i;
+                if (i % 50 == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            logging::core::get()->remove_all_sinks();
+            ::_exit(0);
+        }
+        children.push_back(child);
+    }
+
+    add_output_sink();
+    shm_aggregator aggregator(segment, std::chrono::milliseconds(5));
+    for (auto child : children) {
+        int status = 0;
+        while (::waitpid(child, &status, WNOHANG) == 0) {
+            aggregator.poll();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    aggregator.poll();
+    aggregator.flush();
+    EXPECT_EQ(aggregator.sources(), 0);
+
+    std::map<std::string, int> next_record;
+    std::istringstream lines(output.str());
+    std::string pid;
+    int record = 0;
+    int total = 0;
+    while (lines >> pid >> record) {
+        EXPECT_EQ(record, next_record[pid]) << "out of order record of process " << pid;
+        next_record[pid] = record + 1;
+        ++total;
+    }
+    EXPECT_EQ(next_record.size(), processes);
+    EXPECT_EQ(total, processes * records);
+}
+
+TEST_F(ShmSinkTest, full_rings_drop_records_without_corrupting_the_stream) {
+    add_shm_sink(512);
+    for (int i = 0; i < 100; ++i) {
+        EVLOG_info << "filling the ring " << i;
+    }
+
+    add_output_sink();
+    shm_aggregator aggregator(segment, std::chrono::milliseconds(0));
+    const auto before_drop = aggregator.poll();
+    EXPECT_GT(before_drop, 0);
+    EXPECT_LT(before_drop, 100);
+    EXPECT_NE(output.str().find("dropped"), std::string::npos);
+
+    output.str("");
+    EVLOG_info << "after the drop";
+    aggregator.poll();
+    EXPECT_NE(output.str().find("after the drop"), std::string::npos);
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+#include <everest/stats.hpp>
+
+#include "test_helpers.hpp"
+
+#include <boost/log/core.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace Everest {
+namespace Logging {
+
+class StatsTest : public ConfigFileTest {
+protected:
+    void SetUp() override {
+#ifndef LIBLOG_STATS
+        GTEST_SKIP() << "liblog was built without LIBLOG_STATS";
+#endif
+        log_file = temp_file(".log");
+    }
+
+    void init_with_sink(const std::string& sink_settings) {
+        init_with_config("[Core]\nFilter=\"%Severity% >= INFO\"\n[Sinks.Counted]\nDestination=File\nFileName=\"" +
+                         log_file + "\"\nFormat=\"%Message%\"\n" + sink_settings);
+    }
+
+    static const logging_stats::sink_counts* find_sink(const logging_stats& stats, const std::string& name) {
+        for (const auto& sink : stats.sinks) {
+            if (sink.name == name) {
+                return &sink;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string log_file;
+};
+
+TEST(LatencyHistogramTest, buckets_have_a_relative_error_of_an_eighth) {
+    for (std::uint64_t value = 0; value < 100000; value = value * 9 / 8 + 1) {
+        const auto bucket = latency_histogram::bucket_of(value);
+        EXPECT_LE(value, latency_histogram::bucket_upper_bound(bucket)) << value;
+        if (bucket > 0) {
+            EXPECT_GT(value, latency_histogram::bucket_upper_bound(bucket - 1)) << value;
+        }
+        EXPECT_LE(latency_histogram::bucket_upper_bound(bucket) - value, value / 8) << value;
+    }
+    EXPECT_EQ(latency_histogram::bucket_of(UINT64_MAX), latency_histogram::bucket_count - 1);
+}
+
+TEST(LatencyHistogramTest, quantiles_are_bucket_upper_bounds) {
+    latency_histogram histogram;
+    EXPECT_EQ(histogram.quantile(0.5).count(), 0);
+
+    histogram.add(5, 98);
+    histogram.add(1000);
+    histogram.add(2000);
+    EXPECT_EQ(histogram.count(), 100);
+    EXPECT_EQ(histogram.quantile(0.5).count(), 5);
+    EXPECT_EQ(histogram.quantile(0.99).count(), 1023);
+    EXPECT_EQ(histogram.quantile(1.0).count(), 2047);
+}
+
+TEST_F(StatsTest, counts_emitted_and_filtered_records) {
+    init_with_sink("AutoFlush=true\n");
+    const auto before = stats();
+    EXPECT_TRUE(before.enabled);
+
+    EVLOG_info << "counted";
+    EVLOG_warning << "counted";
+    EVLOG_debug << "filtered";
+
+    const auto after = stats();
+    EXPECT_EQ(after.severities[info].emitted, before.severities[info].emitted + 1);
+    EXPECT_EQ(after.severities[warning].emitted, before.severities[warning].emitted + 1);
+    EXPECT_EQ(after.severities[debug].filtered, before.severities[debug].filtered + 1);
+    EXPECT_EQ(after.call_latency.count(), before.call_latency.count() + 2);
+
+    const auto* sink = find_sink(after, "Counted");
+    ASSERT_NE(sink, nullptr);
+    // the sink was created by init(), its own record is filtered
+    EXPECT_EQ(sink->records, 2);
+    EXPECT_EQ(sink->bytes, 14);
+    EXPECT_EQ(sink->write_latency.count(), 2);
+    EXPECT_NE(to_string(after).find("sink Counted: 2 records, 14 bytes"), std::string::npos);
+}
+
+TEST_F(StatsTest, keeps_the_counts_of_exited_threads) {
+    init_with_sink("AutoFlush=true\n");
+    const auto before = stats();
+    std::thread([] {
+        for (int i = 0; i < 3; ++i) {
+            EVLOG_error << "from a thread";
+        }
+    }).join();
+    EXPECT_EQ(stats().severities[error].emitted, before.severities[error].emitted + 3);
+}
+
+TEST_F(StatsTest, notes_the_queue_high_water_mark) {
+    init_with_sink("Asynchronous=true\nQueueCapacity=64\n");
+    for (int i = 0; i < 10; ++i) {
+        EVLOG_info << "queued";
+    }
+    boost::log::core::get()->flush();
+
+    const auto* sink = find_sink(stats(), "Counted");
+    ASSERT_NE(sink, nullptr);
+    EXPECT_GE(sink->queue_high_water, 1);
+    EXPECT_LE(sink->queue_high_water, 10);
+    EXPECT_EQ(sink->records, 10);
+}
+
+TEST_F(StatsTest, report_interval_is_configurable) {
+    init_with_sink("[Stats]\nReportIntervalMs=10\n");
+    const auto started = std::chrono::steady_clock::now();
+    while (read_file(log_file).find("Logging stats: ") == std::string::npos &&
+           std::chrono::steady_clock::now() - started < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        boost::log::core::get()->flush();
+    }
+    EXPECT_NE(read_file(log_file).find("Logging stats: "), std::string::npos);
+
+    // an interval of 0 would report in a tight loop
+    EXPECT_THROW(init_with_sink("[Stats]\nReportIntervalMs=0\n"), EverestConfigError);
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include "test_helpers.hpp"
+
+#include <everest/logging.hpp>
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+#include <unistd.h>
+
+namespace Everest {
+namespace Logging {
+
+std::string unique_temp_file(const std::string& extension) {
+    // death test children run the test again, they inherit the run id of their parent through the environment
+    static const std::string run_id = []() {
+        constexpr auto variable = "LIBLOG_TEST_RUN_ID";
+        ::setenv(variable, std::to_string(::getpid()).c_str(), 0);
+        return std::string(std::getenv(variable));
+    }();
+    static std::mutex mutex;
+    static std::string last_test;
+    static unsigned int counter = 0;
+
+    std::string test;
+    if (const auto* info = ::testing::UnitTest::GetInstance()->current_test_info()) {
+        test = std::string(info->test_suite_name()) + "_" + info->name();
+    }
+    // parameterized tests have a '/' in their names
+    std::replace(test.begin(), test.end(), '/', '_');
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (test != last_test) {
+        last_test = test;
+        counter = 0;
+    }
+    return ::testing::TempDir() + "liblog_" + run_id + "_" + test + "_" + std::to_string(counter++) + extension;
+}
+
+void write_file(const std::string& file, const std::string& contents) {
+    const auto written_file = file + ".new";
+    {
+        std::ofstream out(written_file);
+        out << contents;
+    }
+    std::rename(written_file.c_str(), file.c_str());
+}
+
+std::string read_file(const std::string& file) {
+    std::ifstream in(file);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+ConfigFileTest::ConfigFileTest() : config_file(unique_temp_file(".ini")) {
+}
+
+void ConfigFileTest::TearDown() {
+    if (original_clog != nullptr) {
+        std::clog.rdbuf(original_clog);
+        original_clog = nullptr;
+    }
+    // the test configuration has none of the optional features, this also stops a watcher
+    init(LIBLOG_TEST_CONFIG);
+    boost::log::core::get()->remove_all_sinks();
+    std::remove(config_file.c_str());
+    for (const auto& file : temp_files) {
+        std::remove(file.c_str());
+    }
+}
+
+void ConfigFileTest::init_with_config(const std::string& contents) {
+    write_config(contents);
+    init(config_file);
+}
+
+void ConfigFileTest::write_config(const std::string& contents) {
+    write_file(config_file, contents);
+}
+
+std::string ConfigFileTest::temp_file(const std::string& extension) {
+    temp_files.push_back(unique_temp_file(extension));
+    return temp_files.back();
+}
+
+void ConfigFileTest::capture_console() {
+    if (original_clog == nullptr) {
+        original_clog = std::clog.rdbuf(output.rdbuf());
+    }
+}
+
+std::string ConfigFileTest::take_output() {
+    auto text = output.str();
+    output.str("");
+    return text;
+}
+
+} // namespace Logging
+} // namespace Everest
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef TEST_HELPERS_HPP
+#define TEST_HELPERS_HPP
+
+#include <gtest/gtest.h>
+
+#include <iosfwd>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Everest {
+namespace Logging {
+
+/// \brief path of a file in ::testing::TempDir() no other test uses, even in another process running tests in parallel
+///
+/// The name is made of the process id, the running test and a counter of the files of the test, followed by
+/// \p extension. Death test children get the names their parent got.
+std::string unique_temp_file(const std::string& extension);
+
+/// \brief replaces \p file by one with \p contents, the way an editor does
+void write_file(const std::string& file, const std::string& contents);
+
+/// \brief the contents of \p file, empty if it doesn't exist
+std::string read_file(const std::string& file);
+
+///
+/// \brief Fixture of tests initializing liblog from a logging config file of their own
+///
+/// TearDown() initializes liblog with the test configuration again, removes all sinks and the files of temp_file().
+class ConfigFileTest : public ::testing::Test {
+protected:
+    ConfigFileTest();
+
+    void TearDown() override;
+
+    /// \brief writes \p contents to config_file and initializes liblog from it
+    void init_with_config(const std::string& contents);
+
+    /// \brief writes \p contents to config_file, see write_file()
+    void write_config(const std::string& contents);
+
+    /// \brief a unique_temp_file() that is removed by TearDown()
+    std::string temp_file(const std::string& extension);
+
+    /// \brief redirects std::clog, where Console sinks write, to the output returned by take_output()
+    void capture_console();
+
+    /// \brief the output captured since the last call
+    std::string take_output();
+
+    const std::string config_file;
+
+private:
+    std::vector<std::string> temp_files;
+    std::ostringstream output;
+    std::streambuf* original_clog{nullptr};
+};
+
+} // namespace Logging
+} // namespace Everest
+
+#endif // TEST_HELPERS_HPP
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <binary_log.hpp>
+#include <time_stamp.hpp>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/log/attributes/constant.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
+#include <boost/log/utility/setup/settings_parser.hpp>
+#include <boost/make_shared.hpp>
+#include <sstream>
+#include <string>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+/// 2023-04-05 06:07:08.123456789
+const time_stamp example{1680674828123456789};
+
+std::string format(time_stamp value) {
+    std::string text;
+    logging::formatting_ostream strm(text);
+    write_time_stamp(value, strm);
+    strm.flush();
+    return text;
+}
+
+/// Keeps the last record.
+class capture_backend : public logging::sinks::basic_sink_backend<logging::sinks::synchronized_feeding> {
+public:
+    void consume(const logging::record_view& rec) {
+        last = rec;
+    }
+
+    logging::record_view last;
+};
+
+logging::record_view make_record(time_stamp value) {
+    auto backend = boost::make_shared<capture_backend>();
+    auto sink = boost::make_shared<logging::sinks::synchronous_sink<capture_backend>>(backend);
+    auto core = logging::core::get();
+    core->add_sink(sink);
+    // the core filter of the test configuration only passes records with a severity
+    logging::attribute_set attributes;
+    attributes.insert("Severity", logging::attributes::constant<severity_level>(info));
+    attributes.insert("TimeStamp", logging::attributes::constant<time_stamp>(value));
+    if (auto rec = core->open_record(attributes)) {
+        core->push_record(std::move(rec));
+    }
+    core->remove_sink(sink);
+    return backend->last;
+}
+
+std::string format_record(const std::string& format, time_stamp value) {
+    register_time_stamp_formatter_factory();
+    std::string text;
+    logging::formatting_ostream strm(text);
+    logging::parse_formatter(format)(make_record(value), strm);
+    strm.flush();
+    return text;
+}
+
+logging::settings parse(const std::string& config) {
+    std::istringstream stream(config);
+    return logging::parse_settings(stream);
+}
+} // namespace
+
+class TimeStampTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        set_time_stamp_precision(time_stamp_precision::microseconds);
+    }
+};
+
+TEST_F(TimeStampTest, writes_the_selected_precision) {
+    EXPECT_EQ(format(example), "2023-04-05 06:07:08.123456");
+    set_time_stamp_precision(time_stamp_precision::milliseconds);
+    EXPECT_EQ(format(example), "2023-04-05 06:07:08.123");
+    set_time_stamp_precision(time_stamp_precision::nanoseconds);
+    EXPECT_EQ(format(example), "2023-04-05 06:07:08.123456789");
+    // the cached date and time of day are replaced on the next second
+    EXPECT_EQ(format(time_stamp{example.nanoseconds + 1000000000}), "2023-04-05 06:07:09.123456789");
+    EXPECT_EQ(format(time_stamp{-1}), "1969-12-31 23:59:59.999999999");
+}
+
+TEST_F(TimeStampTest, writes_the_same_text_as_boost) {
+    EXPECT_EQ(format(example), boost::posix_time::to_iso_extended_string(to_ptime(example)).replace(10, 1, " "));
+    EXPECT_EQ(from_ptime(to_ptime(example)).nanoseconds, example.nanoseconds / 1000 * 1000);
+}
+
+TEST_F(TimeStampTest, clock_is_the_local_time) {
+    const auto before = boost::posix_time::microsec_clock::local_time();
+    const auto now = to_ptime(time_stamp_clock::now());
+    const auto after = boost::posix_time::microsec_clock::local_time();
+
+    EXPECT_LE(before, now);
+    EXPECT_LE(now, after);
+}
+
+TEST_F(TimeStampTest, formats_with_boost_date_time_flags) {
+    EXPECT_EQ(format_record("%TimeStamp%", example), "2023-04-05 06:07:08.123456");
+    EXPECT_EQ(format_record("%TimeStamp(format=\"%H:%M:%S\")%", example), "06:07:08");
+}
+
+TEST_F(TimeStampTest, binary_log_keeps_nanoseconds) {
+    std::vector<unsigned char> encoded;
+    binary_log_encoder encoder;
+    encoder.begin_session(encoded);
+    encoder.encode(make_record(example), encoded);
+
+    std::istringstream in(std::string(encoded.begin(), encoded.end()));
+    binary_log_decoder decoder;
+    logging::attribute_set decoded;
+    ASSERT_TRUE(decoder.read(in, decoded));
+    const auto value = decoded.find("TimeStamp")->second.get_value().extract<time_stamp>();
+    ASSERT_TRUE(value);
+    EXPECT_EQ(value.get().nanoseconds, example.nanoseconds);
+}
+
+TEST_F(TimeStampTest, precision_setting) {
+    EXPECT_EQ(time_stamp_precision_from_settings(parse("")), time_stamp_precision::microseconds);
+    EXPECT_EQ(time_stamp_precision_from_settings(parse("[TimeStamp]\nPrecision=ms\n")),
+              time_stamp_precision::milliseconds);
+    EXPECT_EQ(time_stamp_precision_from_settings(parse("[TimeStamp]\nPrecision=ns\n")),
+              time_stamp_precision::nanoseconds);
+    EXPECT_THROW(time_stamp_precision_from_settings(parse("[TimeStamp]\nPrecision=s\n")), EverestConfigError);
+}
+
+} // namespace Logging
+} // namespace Everest
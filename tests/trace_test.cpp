@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <gtest/gtest.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+#include <everest/trace.hpp>
+
+#include "test_helpers.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Everest {
+namespace Logging {
+
+namespace {
+__attribute__((noinline)) raw_trace capture_in_named_function() {
+    auto trace = capture_trace();
+    asm volatile(""); // keeps the call from becoming a tail call
+    return trace;
+}
+
+bool backtrace_available() {
+    return capture_trace().size != 0;
+}
+} // namespace
+
+TEST(TraceTest, symbolize_resolves_a_captured_trace) {
+    if (!backtrace_available()) {
+        EXPECT_EQ(capture_trace().size, 0);
+        EXPECT_NE(symbolize(capture_trace()).find("Backtrace functionality not"), std::string::npos);
+        GTEST_SKIP() << "liblog was built without backtrace support";
+    }
+    const auto trace = capture_in_named_function();
+    ASSERT_GT(trace.size, 1);
+
+    const auto info = symbolize(trace);
+    EXPECT_EQ(info.rfind("#0: ", 0), 0);
+    EXPECT_NE(info.find("capture_in_named_function"), std::string::npos);
+    EXPECT_NE(info.find("\n#1: "), std::string::npos);
+    // the second time, the frames come from the cache
+    EXPECT_EQ(symbolize(trace), info);
+}
+
+TEST(TraceTest, trace_starts_with_the_calling_function) {
+    if (!backtrace_available()) {
+        GTEST_SKIP() << "liblog was built without backtrace support";
+    }
+    const auto info = trace();
+    EXPECT_NE(info.substr(0, info.find('\n')).find("TraceTest_trace_starts_with_the_calling_function"),
+              std::string::npos);
+}
+
+TEST(TraceTest, resolve_frames_returns_the_frames_symbolize_renders) {
+    if (!backtrace_available()) {
+        GTEST_SKIP() << "liblog was built without backtrace support";
+    }
+    const auto trace = capture_in_named_function();
+    const auto frames = resolve_frames(trace);
+    ASSERT_GE(frames.size(), trace.size);
+    EXPECT_EQ(frames.front().pc, trace.pcs[0]);
+    EXPECT_NE(frames.front().function.find("capture_in_named_function"), std::string::npos);
+
+    std::string rendered;
+    render(frames, rendered);
+    EXPECT_EQ(rendered, symbolize(trace));
+}
+
+TEST(TraceTest, skips_unknown_root_frames) {
+    if (!backtrace_available()) {
+        GTEST_SKIP() << "liblog was built without backtrace support";
+    }
+    const auto trace = capture_in_named_function();
+    std::vector<stack_frame> all;
+    std::vector<stack_frame> known;
+    resolve_frames(trace, all);
+    resolve_frames(trace, known, true);
+    ASSERT_FALSE(known.empty());
+    ASSERT_LE(known.size(), all.size());
+    EXPECT_FALSE(known.back().unknown());
+    for (auto frame = all.begin() + known.size(); frame != all.end(); ++frame) {
+        EXPECT_TRUE(frame->unknown());
+    }
+    const auto info = symbolize(trace, true);
+    EXPECT_EQ(std::count(info.begin(), info.end(), '\n'), known.size());
+}
+
+TEST(TraceTest, render_writes_a_line_per_frame) {
+    const std::vector<stack_frame> frames{{0x10, "main", "main.cpp", 12}, {0x20, {}, {}, 0}};
+    std::string buffer = "trace:\n";
+    render(frames, buffer);
+    EXPECT_EQ(buffer, "trace:\n#0: main at main.cpp:12\n#1: <function unknown> at <filename unknown>:0\n");
+}
+
+TEST(TraceTest, concurrent_traces_resolve_the_same_frames) {
+    constexpr int thread_count = 8;
+    constexpr int traces_per_thread = 200;
+    const auto expected = symbolize(capture_in_named_function());
+    const auto first_line = expected.substr(0, expected.find('\n'));
+
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(thread_count, 0);
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < traces_per_thread; ++i) {
+                // the stacks differ below the thread functions, their first frames don't
+                const auto info = symbolize(capture_in_named_function());
+                if (info.compare(0, first_line.size(), first_line) != 0) {
+                    ++mismatches[t];
+                }
+                const auto traced = trace();
+                if (traced.empty()) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < thread_count; ++t) {
+        EXPECT_EQ(mismatches[t], 0) << "thread " << t;
+    }
+}
+
+TEST(TraceTest, preload_trace_creates_the_state) {
+    preload_trace();
+    const auto available = capture_trace().size != 0;
+    EXPECT_EQ(symbolize(capture_trace()).find("Backtrace functionality") == std::string::npos, available);
+}
+
+TEST(TraceTest, preload_is_configurable) {
+    const auto config_file = unique_temp_file(".ini");
+    write_file(config_file, "[Trace]\nPreload=true\n");
+    EXPECT_NO_THROW(init(config_file));
+    write_file(config_file, "[Trace]\nPreload=sometimes\n");
+    EXPECT_THROW(init(config_file), EverestConfigError);
+    std::remove(config_file.c_str());
+    init(LIBLOG_TEST_CONFIG);
+}
+
+TEST(TraceTest, symbolize_async_resolves_like_symbolize) {
+    const auto trace = capture_in_named_function();
+    auto first = symbolize_async(trace);
+    auto second = symbolize_async(trace);
+    EXPECT_EQ(first.get(), symbolize(trace));
+    EXPECT_EQ(second.get(), symbolize(trace));
+}
+
+} // namespace Logging
+} // namespace Everest
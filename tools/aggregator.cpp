@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <boost/program_options.hpp>
+
+#include <everest/logging.hpp>
+
+#include "shm_aggregator.hpp"
+
+namespace po = boost::program_options;
+
+namespace {
+std::atomic<bool> running{true};
+
+void stop(int /*signal*/) {
+    running = false;
+}
+
+constexpr auto min_poll_interval = std::chrono::milliseconds(1);
+constexpr auto max_poll_interval = std::chrono::milliseconds(20);
+} // namespace
+
+int main(int argc, char* argv[]) {
+    po::options_description desc("Writes the records of all processes logging into a SharedMemory sink");
+    desc.add_options()("help,h", "produce help message");
+    desc.add_options()("logconf", po::value<std::string>()->required(),
+                       "The logging.ini configuring the sinks the records are written to");
+    desc.add_options()("segment", po::value<std::string>()->default_value("everest_log"),
+                       "The Segment setting of the SharedMemory sinks");
+    desc.add_options()("reorder-window", po::value<unsigned int>()->default_value(10),
+                       "Milliseconds records are held back to be ordered with the ones of other processes");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    if (vm.count("help") != 0) {
+        std::cout << desc << "\n";
+        return 1;
+    }
+    po::notify(vm);
+
+    Everest::Logging::init(vm["logconf"].as<std::string>(), "log_aggregator");
+
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+
+    Everest::Logging::shm_aggregator aggregator(vm["segment"].as<std::string>(),
+                                                std::chrono::milliseconds(vm["reorder-window"].as<unsigned int>()));
+    auto poll_interval = min_poll_interval;
+    while (running) {
+        if (aggregator.poll() != 0) {
+            poll_interval = min_poll_interval;
+        } else {
+            poll_interval = std::min(poll_interval * 2, max_poll_interval);
+        }
+        std::this_thread::sleep_for(poll_interval);
+    }
+    aggregator.flush();
+
+    return 0;
+}
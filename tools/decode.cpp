@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
+#include <boost/log/utility/setup/settings_parser.hpp>
+#include <boost/program_options.hpp>
+
+#include <everest/exceptions.hpp>
+
+#include "binary_log.hpp"
+#include "compiled_format.hpp"
+#include "formatters.hpp"
+#include "sinks.hpp"
+
+namespace po = boost::program_options;
+namespace logging = boost::log::BOOST_LOG_VERSION_NAMESPACE;
+namespace sinks = logging::sinks;
+
+using namespace Everest::Logging;
+
+namespace {
+const std::string default_format = "%TimeStamp% [%Severity%] %Message%";
+
+void decode(std::istream& in) {
+    binary_log_decoder decoder;
+    logging::attribute_set attributes;
+    auto core = logging::core::get();
+    while (decoder.read(in, attributes)) {
+        if (auto rec = core->open_record(attributes)) {
+            core->push_record(std::move(rec));
+        }
+    }
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    po::options_description desc("Decodes binary logs written by a BinaryFile sink of EVerest::log");
+    desc.add_options()("help,h", "produce help message");
+    desc.add_options()("logconf", po::value<std::string>(), "The logging.ini to take the format and colors from");
+    desc.add_options()("sink", po::value<std::string>()->default_value("Console"),
+                       "The sink section of the logging.ini whose Format is used");
+    desc.add_options()("format", po::value<std::string>(), "Format of the records, overrides the one of the sink");
+    desc.add_options()("file", po::value<std::vector<std::string>>(), "Binary log files, standard input if omitted");
+
+    po::positional_options_description positional;
+    positional.add("file", -1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help") != 0) {
+        std::cout << desc << "\n";
+        return 1;
+    }
+
+    register_formatter_factories();
+
+    auto format = default_format;
+    if (vm.count("logconf") != 0) {
+        std::ifstream logging_config(vm["logconf"].as<std::string>());
+        if (!logging_config.is_open()) {
+            std::cerr << "Could not open logging config file " << vm["logconf"].as<std::string>() << "\n";
+            return 1;
+        }
+        auto settings = logging::parse_settings(logging_config);
+        auto sink = settings["Sinks." + vm["sink"].as<std::string>()].get_section();
+        set_severity_colors(sink);
+        if (auto sink_format = sink["Format"].get()) {
+            format = sink_format.get();
+        }
+    }
+    if (vm.count("format") != 0) {
+        format = vm["format"].as<std::string>();
+    }
+
+    auto backend = boost::make_shared<sinks::text_ostream_backend>();
+    backend->add_stream(boost::shared_ptr<std::ostream>(&std::cout, boost::null_deleter()));
+    auto sink = boost::make_shared<sinks::synchronous_sink<sinks::text_ostream_backend>>(backend);
+    sink->set_formatter(compile_formatter(rewrite_format_placeholders(format)));
+    logging::core::get()->add_sink(sink);
+
+    try {
+        std::vector<std::string> file_names;
+        if (vm.count("file") != 0) {
+            file_names = vm["file"].as<std::vector<std::string>>();
+        } else {
+            decode(std::cin);
+        }
+        for (const auto& file_name : file_names) {
+            std::ifstream file(file_name, std::ios::binary);
+            if (!file.is_open()) {
+                std::cerr << "Could not open binary log file " << file_name << "\n";
+                return 1;
+            }
+            decode(file);
+        }
+    } catch (const Everest::EverestInternalError& e) {
+        sink->flush();
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    sink->flush();
+    return 0;
+}